@@ -0,0 +1,41 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+// Timing shared by the benchmarks.
+namespace matoy::bench {
+
+// Best wall time in seconds over at least 2 and at most `max_reps` repetitions, stopping once they take `budget`
+// seconds in total.
+template <class F>
+double measure(F&& f, int max_reps = 20, double budget = 0.2) {
+    using clock = std::chrono::steady_clock;
+    double best{1e30}, total{0.0};
+    for (int rep{0}; rep < max_reps && (rep < 2 || total < budget); rep++) {
+        auto start = clock::now();
+        f();
+        double t = std::chrono::duration<double>(clock::now() - start).count();
+        best = std::min(best, t);
+        total += t;
+    }
+    return best;
+}
+
+// Best time per call in nanoseconds over 5 rounds of `reps` calls, for operations too quick to time one by one.
+template <class F>
+double measure_ns(size_t reps, F&& f) {
+    using clock = std::chrono::steady_clock;
+    double best{1e30};
+    for (int round{0}; round < 5; round++) {
+        auto start = clock::now();
+        for (size_t r{0}; r < reps; r++) {
+            f();
+        }
+        best = std::min(best, std::chrono::duration<double>(clock::now() - start).count());
+    }
+    return best / static_cast<double>(reps) * 1e9;
+}
+
+} // namespace matoy::bench
@@ -0,0 +1,37 @@
+#include "bench.hpp"
+#include "matoy/foundations/band.hpp"
+#include "matoy/foundations/lu.hpp"
+#include <algorithm>
+#include <print>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::bench;
+
+int main() {
+    std::println("{:>6} | {:>12} {:>12} | {:>12} {:>12} | {:>12} {:>12}", "n", "dense scale", "diag scale",
+                 "LU solve", "thomas", "LU solve", "band(4,4)");
+    for (size_t n : {250, 500, 1000}) {
+        auto tri{BandMatrix::from_dense(Matrix::zeros(n, n, 1.0), 1, 1)}, wide{BandMatrix(n, 4, 4)};
+        for (size_t i{0}; i < n; i++) {
+            tri[i, i] = 4.0;
+            for (size_t j{i > 4 ? i - 4 : 0}; j < std::min(n, i + 5); j++) {
+                wide[i, j] = i == j ? 1.0 : 1.0 / static_cast<double>(i + j + 1);
+            }
+        }
+        std::vector<double> scale(n, 2.0);
+        const auto diag{BandMatrix::diagonal(scale)};
+        const Matrix dense_diag{diag.to_dense()}, dense_tri{tri.to_dense()}, dense_wide{wide.to_dense()};
+        const Matrix b{Matrix::zeros(n, n, 1.0)}, x{Matrix::zeros(n, 1, 1.0)};
+
+        double t_dense_scale{measure([&] { (void)(dense_diag * b); })};
+        double t_diag_scale{measure([&] { (void)(diag * b); })};
+        double t_lu_tri{measure([&] { (void)LU{dense_tri}.solve(x); })};
+        double t_thomas{measure([&] { (void)tri.solve(x); })};
+        double t_lu_wide{measure([&] { (void)LU{dense_wide}.solve(x); })};
+        double t_band{measure([&] { (void)wide.solve(x); })};
+        std::println("{:>6} | {:>10.3f}ms {:>10.3f}ms | {:>10.3f}ms {:>10.3f}ms | {:>10.3f}ms {:>10.3f}ms", n,
+                     t_dense_scale * 1e3, t_diag_scale * 1e3, t_lu_tri * 1e3, t_thomas * 1e3, t_lu_wide * 1e3,
+                     t_band * 1e3);
+    }
+}
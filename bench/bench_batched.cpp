@@ -0,0 +1,71 @@
+#include "bench.hpp"
+#include "matoy/foundations/batched.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include <print>
+#include <random>
+#include <vector>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::bench;
+
+// Nanoseconds per matrix for a vector of separate matrices, which is what a script loop works on, against a batch.
+void run(size_t n, size_t count) {
+    std::mt19937_64 rng{n};
+    std::uniform_real_distribution<double> dist{-1.0, 1.0};
+    BatchedMatrix a(count, n, n), b(count, n, n);
+    for (size_t k{0}; k < count; k++) {
+        for (size_t i{0}; i < n; i++) {
+            for (size_t j{0}; j < n; j++) {
+                a[k, i, j] = dist(rng) + (i == j ? 4.0 : 0.0);
+                b[k, i, j] = dist(rng);
+            }
+        }
+    }
+    std::vector<Matrix> as, bs;
+    for (size_t k{0}; k < count; k++) {
+        as.push_back(a.matrix(k));
+        bs.push_back(b.matrix(k));
+    }
+
+    const double per{static_cast<double>(count)};
+    double sink{0.0};
+    const double mul_loop{measure_ns(3, [&] {
+        for (size_t k{0}; k < count; k++) {
+            sink += (as[k] * bs[k])[0, 0];
+        }
+    })};
+    const double mul_batch{measure_ns(3, [&] { sink += (a * b)[0, 0, 0]; })};
+    const double det_loop{measure_ns(3, [&] {
+        for (size_t k{0}; k < count; k++) {
+            sink += det(as[k]);
+        }
+    })};
+    const double det_batch{measure_ns(3, [&] { sink += a.det()[0, 0]; })};
+    const double inv_loop{measure_ns(3, [&] {
+        for (size_t k{0}; k < count; k++) {
+            sink += (*inverse(as[k]))[0, 0];
+        }
+    })};
+    const double inv_batch{measure_ns(3, [&] { sink += (*a.inverse())[0, 0, 0]; })};
+    const double add_loop{measure_ns(3, [&] {
+        for (size_t k{0}; k < count; k++) {
+            sink += Matrix(as[k] + bs[k])[0, 0];
+        }
+    })};
+    const double add_batch{measure_ns(3, [&] { sink += (a + b)[0, 0, 0]; })};
+
+    std::println("{}x{} x {:>6}  multiply {:>6.1f} {:>5.1f}  det {:>6.1f} {:>5.1f}  inverse {:>6.1f} {:>5.1f}  "
+                 "add {:>6.1f} {:>5.1f}   ({})",
+                 n, n, count, mul_loop / per, mul_batch / per, det_loop / per, det_batch / per, inv_loop / per,
+                 inv_batch / per, add_loop / per, add_batch / per, sink != 0.0);
+}
+
+int main() {
+    std::println("ns per matrix, separate matrices then batched");
+    for (size_t n : {2, 3, 4, 6}) {
+        for (size_t count : {1000, 50000}) {
+            run(n, count);
+        }
+    }
+}
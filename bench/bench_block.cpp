@@ -0,0 +1,27 @@
+#include "bench.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include <print>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::bench;
+
+// [A, B; C, D] with n x n blocks: one allocation against three through pairwise concatenation, and the same for a
+// 4 x 4 grid of blocks, where the pairwise steps copy the elements several times.
+int main() {
+    std::println("{:>6} | {:>12} {:>12} | {:>12} {:>12}", "n", "concat 2x2", "block 2x2", "concat 4x4", "block 4x4");
+    for (size_t n : {64, 256, 1000, 2000}) {
+        const auto a{Matrix::zeros(n, n, 1.0)}, b{Matrix::zeros(n, n, 2.0)};
+        const std::vector<std::vector<Matrix>> grid2{{a, b}, {b, a}}, grid4(4, std::vector<Matrix>{a, b, a, b});
+
+        const double t_concat2{measure([&] { (void)concat_v(concat_h(a, b), concat_h(b, a)); })};
+        const double t_block2{measure([&] { (void)block_matrix(grid2); })};
+        const double t_concat4{measure([&] {
+            const auto row{concat_h(concat_h(a, b), concat_h(a, b))};
+            (void)concat_v(concat_v(row, row), concat_v(row, row));
+        })};
+        const double t_block4{measure([&] { (void)block_matrix(grid4); })};
+        std::println("{:>6} | {:>10.3f}ms {:>10.3f}ms | {:>10.3f}ms {:>10.3f}ms", n, t_concat2 * 1e3, t_block2 * 1e3,
+                     t_concat4 * 1e3, t_block4 * 1e3);
+    }
+}
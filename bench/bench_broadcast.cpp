@@ -0,0 +1,41 @@
+#include "bench.hpp"
+#include "matoy/foundations/band.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include <algorithm>
+#include <functional>
+#include <print>
+#include <vector>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::bench;
+
+// Scaling the columns of a matrix: broadcasting a row vector, a diagonal band product, and the row vector expanded
+// to a full matrix first, which is what a script without broadcasting has to build.
+int main() {
+    std::println("{:>6} | {:>12} {:>12} {:>12} | {:>12}", "n", "broadcast", "diag band", "expanded", "in place");
+    for (size_t n : {250, 500, 1000, 2000}) {
+        std::vector<double> scale(n);
+        for (size_t j{0}; j < n; j++) {
+            scale[j] = 1.0 + static_cast<double>(j) / static_cast<double>(n);
+        }
+        const auto diag{BandMatrix::diagonal(scale)};
+        auto row{Matrix::empty(1, n)};
+        std::copy(scale.begin(), scale.end(), row.data());
+        const Matrix a{Matrix::zeros(n, n, 1.0)};
+
+        double t_broadcast{measure([&] { (void)broadcast_mul(a, row); })};
+        double t_diag{measure([&] { (void)(a * diag); })};
+        double t_expanded{measure([&] {
+            auto full{Matrix::empty(n, n)};
+            for (size_t i{0}; i < n; i++) {
+                std::copy(scale.begin(), scale.end(), full.data() + i * n);
+            }
+            (void)Matrix(ZipExpr{std::multiplies<>{}, as_expr(a), as_expr(full)});
+        })};
+        auto b{a};
+        double t_in_place{measure([&] { b = *broadcast_mul(std::move(b), row); })};
+        std::println("{:>6} | {:>10.3f}ms {:>10.3f}ms {:>10.3f}ms | {:>10.3f}ms", n, t_broadcast * 1e3,
+                     t_diag * 1e3, t_expanded * 1e3, t_in_place * 1e3);
+    }
+}
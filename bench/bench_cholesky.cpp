@@ -0,0 +1,33 @@
+#include "bench.hpp"
+#include "matoy/foundations/cholesky.hpp"
+#include "matoy/foundations/lu.hpp"
+#include <print>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::bench;
+
+int main() {
+    std::println("{:>6} | {:>12} {:>12} | {:>12} {:>12} | {:>12} {:>12}", "n", "LU det", "chol det", "LU solve",
+                 "chol solve", "LU inverse", "chol inverse");
+    for (size_t n : {250, 500, 1000}) {
+        // a symmetric, diagonally dominant matrix with a positive diagonal is positive definite
+        auto a{Matrix::empty(n, n)};
+        for (size_t i{0}; i < n; i++) {
+            for (size_t j{0}; j < n; j++) {
+                a[i, j] = i == j ? static_cast<double>(n) : 1.0 / static_cast<double>(i + j + 1);
+            }
+        }
+        const Matrix b{Matrix::zeros(n, 1, 1.0)};
+
+        double t_lu_det{measure([&] { (void)LU{a}.det(); })};
+        double t_chol_det{measure([&] { (void)Cholesky{a}.det(); })};
+        double t_lu_solve{measure([&] { (void)LU{a}.solve(b); })};
+        double t_chol_solve{measure([&] { (void)Cholesky{a}.solve(b); })};
+        double t_lu_inv{measure([&] { (void)LU{a}.inverse(); })};
+        double t_chol_inv{measure([&] { (void)Cholesky{a}.inverse(); })};
+        std::println("{:>6} | {:>10.3f}ms {:>10.3f}ms | {:>10.3f}ms {:>10.3f}ms | {:>10.3f}ms {:>10.3f}ms", n,
+                     t_lu_det * 1e3, t_chol_det * 1e3, t_lu_solve * 1e3, t_chol_solve * 1e3, t_lu_inv * 1e3,
+                     t_chol_inv * 1e3);
+    }
+}
@@ -0,0 +1,42 @@
+#include "bench.hpp"
+#include "matoy/foundations/eigen.hpp"
+#include "matoy/foundations/svd.hpp"
+#include <cstdlib>
+#include <print>
+#include <random>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::bench;
+
+// Sizes up to the first argument, 2000 by default. The SVD of the largest matrices takes minutes on one core.
+int main(int argc, char** argv) {
+    const size_t max_n{argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 2000};
+    std::mt19937_64 rng{16};
+    std::uniform_real_distribution<double> dist{-1.0, 1.0};
+    std::println("{:>6} | {:>12} {:>12} | {:>12} {:>12}", "n", "eigenvalues", "eigenvectors", "sing. values",
+                 "U, S and V");
+    for (size_t n : {100, 250, 500, 1000, 2000}) {
+        if (n > max_n) {
+            break;
+        }
+        auto a{Matrix::empty(n, n)}, s{Matrix::empty(n, n)};
+        for (size_t i{0}; i < n; i++) {
+            for (size_t j{0}; j < n; j++) {
+                a[i, j] = dist(rng);
+            }
+        }
+        for (size_t i{0}; i < n; i++) {
+            for (size_t j{0}; j < n; j++) {
+                s[i, j] = a[i, j] + a[j, i];
+            }
+        }
+
+        double t_values{measure([&] { (void)SymmetricEigen{s, false}; })};
+        double t_vectors{measure([&] { (void)SymmetricEigen{s}; })};
+        double t_sigma{measure([&] { (void)SVD{a, false}; })};
+        double t_svd{measure([&] { (void)SVD{a}; })};
+        std::println("{:>6} | {:>10.3f}ms {:>10.3f}ms | {:>10.3f}ms {:>10.3f}ms", n, t_values * 1e3, t_vectors * 1e3,
+                     t_sigma * 1e3, t_svd * 1e3);
+    }
+}
@@ -0,0 +1,34 @@
+#include "bench.hpp"
+#include "matoy/foundations/matrix.hpp"
+#include <print>
+
+using namespace matoy;
+using namespace matoy::bench;
+
+// What `a + b * 2.0 - c / 3.0 + d * 0.5` did before expression templates: one temporary per operator.
+Matrix chain_eager(const Matrix& a, const Matrix& b, const Matrix& c, const Matrix& d) {
+    Matrix t1{b};
+    t1 *= 2.0;
+    Matrix t2{a};
+    t2 += t1;
+    Matrix t3{c};
+    t3 /= 3.0;
+    Matrix t4{t2};
+    t4 -= t3;
+    Matrix t5{d};
+    t5 *= 0.5;
+    Matrix res{t4};
+    res += t5;
+    return res;
+}
+
+int main() {
+    std::println("{:>6} {:>10} {:>10} {:>8}", "n", "eager ms", "fused ms", "speedup");
+    for (size_t n : {100, 500, 1000, 2000, 4000}) {
+        auto a = Matrix::zeros(n, n, 1.0), b = Matrix::zeros(n, n, 2.0), c = Matrix::zeros(n, n, 3.0),
+             d = Matrix::zeros(n, n, 4.0);
+        double t_eager = measure([&] { Matrix r = chain_eager(a, b, c, d); });
+        double t_fused = measure([&] { Matrix r = a + b * 2.0 - c / 3.0 + d * 0.5; });
+        std::println("{:>6} {:>10.3f} {:>10.3f} {:>7.2f}x", n, t_eager * 1e3, t_fused * 1e3, t_eager / t_fused);
+    }
+}
@@ -0,0 +1,67 @@
+#include "bench.hpp"
+#include "matoy/foundations/matrix.hpp"
+#include <algorithm>
+#include <cmath>
+#include <print>
+#include <random>
+#include <vector>
+
+using namespace matoy;
+using namespace matoy::bench;
+
+// The i-k-j loop that `operator*` used before the packed kernel.
+Matrix multiply_naive(const Matrix& lhs, const Matrix& rhs) {
+    auto res{Matrix::zeros(lhs.rows(), rhs.cols())};
+    for (size_t i{0}; i < lhs.rows(); i++) {
+        for (size_t k{0}; k < lhs.cols(); k++) {
+            for (size_t j{0}; j < rhs.cols(); j++) {
+                res[i, j] += lhs[i, k] * rhs[k, j];
+            }
+        }
+    }
+    return res;
+}
+
+Matrix random_matrix(size_t rows, size_t cols, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> dist{-1.0, 1.0};
+    std::vector<double> data(rows * cols);
+    std::ranges::generate(data, [&] { return dist(rng); });
+    return Matrix(rows, cols, data);
+}
+
+double max_abs_diff(const Matrix& a, const Matrix& b) {
+    double res{0.0};
+    for (size_t i{0}; i < a.rows(); i++) {
+        for (size_t j{0}; j < a.cols(); j++) {
+            res = std::max(res, std::abs(a[i, j] - b[i, j]));
+        }
+    }
+    return res;
+}
+
+int main() {
+    struct Shape {
+        size_t m, k, n;
+    };
+    const Shape shapes[]{
+        {64, 64, 64},     {128, 128, 128},  {256, 256, 256},  {512, 512, 512},  {1024, 1024, 1024},
+        {2000, 64, 2000}, {64, 2000, 2000}, {2000, 2000, 64}, {4000, 16, 4000}, {1000, 300, 700},
+    };
+
+    std::mt19937_64 rng{42};
+    std::println("{:>18} {:>12} {:>12} {:>9} {:>10}", "m x k x n", "naive GF/s", "packed GF/s", "speedup", "max diff");
+    for (auto [m, k, n] : shapes) {
+        auto a = random_matrix(m, k, rng);
+        auto b = random_matrix(k, n, rng);
+        const double flops = 2.0 * m * n * k;
+
+        Matrix naive = multiply_naive(a, b);
+        Matrix packed = a * b;
+        double t_naive = measure([&] { naive = multiply_naive(a, b); }, 50);
+        double t_packed = measure([&] { packed = a * b; }, 50);
+
+        std::println("{:>18} {:>12.2f} {:>12.2f} {:>8.1f}x {:>10.2e}", std::format("{}x{}x{}", m, k, n),
+                     flops / t_naive * 1e-9, flops / t_packed * 1e-9, t_naive / t_packed,
+                     max_abs_diff(naive, packed));
+    }
+}
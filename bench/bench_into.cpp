@@ -0,0 +1,52 @@
+#include "bench.hpp"
+#include "matoy/foundations/matrix.hpp"
+#include <print>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::bench;
+
+// 1000 operations on n x n matrices: a fresh result each time against writing into an existing one, and a scaled
+// temporary that gets its own buffer against one that reuses the buffer of the temporary.
+int main() {
+    constexpr int count{1000};
+    std::println("{:>6} | {:>10} {:>10} | {:>10} {:>10} | {:>10} {:>10}", "n", "a * b", "mul into", "a + b",
+                 "add into", "(a+b)*2", "reused");
+    for (size_t n : {4, 16, 64, 256}) {
+        const auto a{Matrix::zeros(n, n, 1.0)}, b{Matrix::zeros(n, n, 2.0)};
+        auto c{Matrix::empty(n, n)};
+        const double t_mul{measure([&] {
+            for (int i{0}; i < count; i++) {
+                c = a * b;
+            }
+        })};
+        const double t_mul_into{measure([&] {
+            for (int i{0}; i < count; i++) {
+                multiply_into(c, a, b);
+            }
+        })};
+        const double t_add{measure([&] {
+            for (int i{0}; i < count; i++) {
+                c = Matrix(a + b);
+            }
+        })};
+        const double t_add_into{measure([&] {
+            for (int i{0}; i < count; i++) {
+                add_into(c, a, b);
+            }
+        })};
+        const double t_scale{measure([&] {
+            for (int i{0}; i < count; i++) {
+                const Matrix sum{a + b};
+                c = Matrix(sum * 2.0);
+            }
+        })};
+        const double t_reused{measure([&] {
+            for (int i{0}; i < count; i++) {
+                c = Matrix(Matrix(a + b) * 2.0);
+            }
+        })};
+        std::println("{:>6} | {:>8.3f}ms {:>8.3f}ms | {:>8.3f}ms {:>8.3f}ms | {:>8.3f}ms {:>8.3f}ms", n, t_mul * 1e3,
+                     t_mul_into * 1e3, t_add * 1e3, t_add_into * 1e3, t_scale * 1e3, t_reused * 1e3);
+    }
+}
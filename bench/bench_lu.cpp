@@ -0,0 +1,70 @@
+#include "bench.hpp"
+#include "matoy/foundations/lu.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <print>
+#include <random>
+#include <vector>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::bench;
+
+// The row-by-row elimination that `det` used before the blocked LU.
+double det_row_by_row(Matrix mat) {
+    constexpr auto EPS = std::numeric_limits<double>::epsilon();
+    const size_t n = mat.rows();
+    double res{1.0};
+    for (size_t i{}; i < n; i++) {
+        size_t k{i};
+        for (size_t j{i}; j < n; j++) {
+            if (std::abs(mat[j, i]) > std::abs(mat[k, i])) {
+                k = j;
+            }
+        }
+        if (std::abs(mat[k, i]) < EPS) {
+            return 0.0;
+        }
+        if (k != i) {
+            mat.swap_row(i, k);
+            res = -res;
+        }
+        res *= mat[i, i];
+        mat.multiply_row(i, 1.0 / mat[i, i]);
+        for (size_t j{i + 1}; j < n; j++) {
+            if (std::abs(mat[j, i]) > EPS) {
+                mat.add_row_multiple(j, i, -mat[j, i]);
+            }
+        }
+    }
+    return res;
+}
+
+Matrix random_matrix(size_t n, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> dist{-1.0, 1.0};
+    std::vector<double> data(n * n);
+    std::ranges::generate(data, [&] { return dist(rng); });
+    return Matrix(n, n, data);
+}
+
+int main() {
+    std::mt19937_64 rng{42};
+
+    std::println("{:>6} {:>14} {:>12} {:>9}", "n", "row-by-row ms", "blocked ms", "speedup");
+    for (size_t n : {128, 256, 512, 1000, 1500, 2000}) {
+        auto a = random_matrix(n, rng);
+        double t_rows = measure([&] { det_row_by_row(a); }, 20, 0.5);
+        double t_blocked = measure([&] { LU{a}.det(); }, 20, 0.5);
+        std::println("{:>6} {:>14.1f} {:>12.1f} {:>8.1f}x", n, t_rows * 1e3, t_blocked * 1e3, t_rows / t_blocked);
+    }
+
+    const size_t n{1000};
+    auto a = random_matrix(n, rng);
+    std::println("\nblock size sweep, n = {}", n);
+    std::println("{:>6} {:>12}", "block", "ms");
+    for (size_t block : {8, 16, 32, 48, 64, 128, 256, 1000}) {
+        double t = measure([&] { LU(a, block).det(); }, 20, 0.5);
+        std::println("{:>6} {:>12.1f}", block, t * 1e3);
+    }
+}
@@ -0,0 +1,32 @@
+#include "bench.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include <cstdint>
+#include <print>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::bench;
+
+int main() {
+    std::println("{:>6} {:>6} | {:>12} {:>12} | {:>8}", "n", "k", "loop", "squaring", "speedup");
+    for (size_t n : {8, 64, 256}) {
+        auto a{Matrix::empty(n, n)};
+        for (size_t i{0}; i < n; i++) {
+            for (size_t j{0}; j < n; j++) {
+                a[i, j] = 1.0 / static_cast<double>(n + i + j);
+            }
+        }
+        for (int64_t k : {7, 32, 100}) {
+            // what a script loop `p := A; i := 1; while i < k { p *= A; i += 1 }` does
+            double t_loop{measure([&] {
+                Matrix p{a};
+                for (int64_t i{1}; i < k; i++) {
+                    p = p * a;
+                }
+            })};
+            double t_pow{measure([&] { (void)power(a, k); })};
+            std::println("{:>6} {:>6} | {:>10.3f}ms {:>10.3f}ms | {:>7.1f}x", n, k, t_loop * 1e3, t_pow * 1e3,
+                         t_loop / t_pow);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#include "bench.hpp"
+#include "matoy/foundations/gemm.hpp"
+#include "matoy/foundations/lu.hpp"
+#include "matoy/foundations/refined_lu.hpp"
+#include <algorithm>
+#include <cmath>
+#include <print>
+#include <random>
+#include <utility>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::bench;
+
+// max |A * x - b| / (|A| * |x|), the backward error of a solution
+double backward_error(const Matrix& a, const Matrix& x, const Matrix& b) {
+    const Matrix r{a * x - b};
+    double r_max{0.0}, a_max{0.0}, x_max{0.0};
+    for (size_t i{0}; i < a.rows(); i++) {
+        r_max = std::max(r_max, std::abs(r[i, 0]));
+        x_max = std::max(x_max, std::abs(x[i, 0]));
+        for (size_t j{0}; j < a.cols(); j++) {
+            a_max = std::max(a_max, std::abs(a[i, j]));
+        }
+    }
+    return r_max / (a_max * x_max * static_cast<double>(a.rows()));
+}
+
+int main() {
+    std::mt19937_64 rng{18};
+    std::uniform_real_distribution<double> dist{-1.0, 1.0};
+
+    std::println("{:>6} | {:>11} {:>11} {:>6} | {:>11} {:>11} {:>6} | {:>11} {:>11} {:>9} {:>9}", "n", "gemm f64",
+                 "gemm f32", "ratio", "LU f64", "LU f32", "ratio", "solve f64", "refined", "err f64", "err ref");
+    for (size_t n : {256, 512, 1024, 1536}) {
+        auto a{Matrix::empty(n, n)};
+        for (size_t i{0}; i < n; i++) {
+            for (size_t j{0}; j < n; j++) {
+                a[i, j] = dist(rng);
+            }
+        }
+        auto b{Matrix::empty(n, 1)};
+        for (size_t i{0}; i < n; i++) {
+            b[i, 0] = dist(rng);
+        }
+        const FloatMatrix a32{a};
+        auto c{Matrix::empty(n, n)};
+        auto c32{FloatMatrix::empty(n, n)};
+
+        double t_gemm{measure([&] { gemm(1.0, a.view(), a.view(), 0.0, c.view()); })};
+        double t_gemm32{measure([&] { gemm(1.0f, a32.view(), a32.view(), 0.0f, c32.view()); })};
+        double t_lu{measure([&] { (void)LU{a}; })};
+        double t_lu32{measure([&] { (void)FloatLU{a32}; })};
+        double t_solve{measure([&] { (void)LU{a}.solve(b); })};
+        double t_refined{measure([&] { (void)RefinedLU{a}.solve(b); })};
+        const double err{backward_error(a, *LU{a}.solve(b), b)};
+        const double err_refined{backward_error(a, *RefinedLU{a}.solve(b), b)};
+        std::println("{:>6} | {:>9.2f}ms {:>9.2f}ms {:>5.2f}x | {:>9.2f}ms {:>9.2f}ms {:>5.2f}x | {:>9.2f}ms {:>9.2f}ms "
+                     "{:>9.1e} {:>9.1e}",
+                     n, t_gemm * 1e3, t_gemm32 * 1e3, t_gemm / t_gemm32, t_lu * 1e3, t_lu32 * 1e3, t_lu / t_lu32,
+                     t_solve * 1e3, t_refined * 1e3, err, err_refined);
+    }
+}
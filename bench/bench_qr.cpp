@@ -0,0 +1,36 @@
+#include "bench.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include "matoy/foundations/qr.hpp"
+#include <print>
+#include <utility>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::bench;
+
+Matrix test_matrix(size_t rows, size_t cols) {
+    auto res{Matrix::empty(rows, cols)};
+    for (size_t i{0}; i < rows; i++) {
+        for (size_t j{0}; j < cols; j++) {
+            res[i, j] = 1.0 / static_cast<double>(i + 2 * j + 1) + (i == j ? 1.0 : 0.0);
+        }
+    }
+    return res;
+}
+
+int main() {
+    std::println("{:>8} {:>5} | {:>14} {:>12} {:>12} {:>12}", "m", "n", "(A'A).I A'b", "unblocked", "blocked",
+                 "lstsq");
+    for (auto [m, n] : {std::pair<size_t, size_t>{1000, 250}, {2000, 500}, {4000, 1000}, {200000, 8}}) {
+        const Matrix a{test_matrix(m, n)}, b{Matrix::zeros(m, 1, 1.0)};
+        double t_normal{measure([&] {
+            const Matrix at{a.transposed()};
+            (void)(*inverse(at * a) * at * b);
+        })};
+        double t_unblocked{measure([&] { (void)QR{a, 1}.solve(b); })};
+        double t_blocked{measure([&] { (void)QR{a}.solve(b); })};
+        double t_lstsq{measure([&] { (void)lstsq(a, b); })};
+        std::println("{:>8} {:>5} | {:>12.3f}ms {:>10.3f}ms {:>10.3f}ms {:>10.3f}ms", m, n, t_normal * 1e3,
+                     t_unblocked * 1e3, t_blocked * 1e3, t_lstsq * 1e3);
+    }
+}
@@ -0,0 +1,70 @@
+#include "bench.hpp"
+#include "matoy/foundations/reduce.hpp"
+#include <cmath>
+#include <print>
+#include <random>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::bench;
+
+// Element by element through operator[], which is what a script loop does minus the interpreter.
+double loop_sum(const Matrix& a) {
+    double s{0.0};
+    for (size_t i{0}; i < a.rows(); i++) {
+        for (size_t j{0}; j < a.cols(); j++) {
+            s += a[i, j];
+        }
+    }
+    return s;
+}
+
+Matrix loop_col_sums(const Matrix& a) {
+    auto res{Matrix::zeros(1, a.cols())};
+    for (size_t i{0}; i < a.rows(); i++) {
+        for (size_t j{0}; j < a.cols(); j++) {
+            res[0, j] += a[i, j];
+        }
+    }
+    return res;
+}
+
+double loop_norm(const Matrix& a) {
+    double s{0.0};
+    for (size_t i{0}; i < a.rows(); i++) {
+        for (size_t j{0}; j < a.cols(); j++) {
+            s += a[i, j] * a[i, j];
+        }
+    }
+    return std::sqrt(s);
+}
+
+int main() {
+    std::println("{:>6} | {:>10} {:>10} | {:>10} {:>10} | {:>10} {:>10} | {:>9} {:>9}", "n", "loop sum", "sum",
+                 "loop cols", "sum(A, 1)", "loop norm", "norm", "loop err", "sum err");
+    std::mt19937_64 rng{21};
+    std::uniform_real_distribution<double> dist{0.0, 1.0};
+    for (size_t n : {250, 1000, 2000, 4000}) {
+        auto a{Matrix::empty(n, n)};
+        long double exact{0.0L};
+        for (size_t i{0}; i < n; i++) {
+            for (size_t j{0}; j < n; j++) {
+                a[i, j] = dist(rng);
+                exact += a[i, j];
+            }
+        }
+        double sink{0.0};
+        const double t_loop{measure([&] { sink += loop_sum(a); })};
+        const double t_sum{measure([&] { sink += sum(a); })};
+        const double t_loop_cols{measure([&] { sink += loop_col_sums(a)[0, 0]; })};
+        const double t_cols{measure([&] { sink += sum(a, Axis::Rows)[0, 0]; })};
+        const double t_loop_norm{measure([&] { sink += loop_norm(a); })};
+        const double t_norm{measure([&] { sink += frobenius_norm(a); })};
+        // relative errors against a long double sum
+        const auto error = [&](double s) { return static_cast<double>(std::abs((s - exact) / exact)); };
+        std::println("{:>6} | {:>8.3f}ms {:>8.3f}ms | {:>8.3f}ms {:>8.3f}ms | {:>8.3f}ms {:>8.3f}ms | {:>9.1e} {:>9.1e}"
+                     "{}",
+                     n, t_loop * 1e3, t_sum * 1e3, t_loop_cols * 1e3, t_cols * 1e3, t_loop_norm * 1e3, t_norm * 1e3,
+                     error(loop_sum(a)), error(sum(a)), sink == 0.0 ? " " : "");
+    }
+}
@@ -0,0 +1,44 @@
+#include "bench.hpp"
+#include "matoy/foundations/matrix.hpp"
+#include <print>
+
+using namespace matoy;
+using namespace matoy::bench;
+
+// The loops the row operations used before the vectorized kernels.
+void add_row_multiple_indexed(Matrix& m, size_t r1, size_t r2, double x) {
+    for (size_t j = 0; j < m.cols(); j++) {
+        m[r1, j] += m[r2, j] * x;
+    }
+}
+
+void add_indexed(Matrix& m, const Matrix& other) {
+    for (size_t i = 0; i < m.rows(); i++) {
+        for (size_t j = 0; j < m.cols(); j++) {
+            m[i, j] += other[i, j];
+        }
+    }
+}
+
+int main() {
+    std::println("{:>6} {:>14} {:>14} {:>12} {:>12}", "n", "row indexed ms", "row kernel ms", "add idx ms",
+                 "add kern ms");
+    for (size_t n : {256, 1000, 2000, 4000}) {
+        auto a = Matrix::zeros(n, n, 1.0), b = Matrix::zeros(n, n, 0.5);
+        // one elimination sweep: every row gets a multiple of the first
+        double t_row_idx = measure([&] {
+            for (size_t i{1}; i < n; i++) {
+                add_row_multiple_indexed(a, i, 0, 1e-9);
+            }
+        });
+        double t_row_simd = measure([&] {
+            for (size_t i{1}; i < n; i++) {
+                a.add_row_multiple(i, 0, 1e-9);
+            }
+        });
+        double t_add_idx = measure([&] { add_indexed(a, b); });
+        double t_add_simd = measure([&] { a += b; });
+        std::println("{:>6} {:>14.3f} {:>14.3f} {:>12.3f} {:>12.3f}", n, t_row_idx * 1e3, t_row_simd * 1e3,
+                     t_add_idx * 1e3, t_add_simd * 1e3);
+    }
+}
@@ -0,0 +1,40 @@
+#include "bench.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include "matoy/foundations/reduce.hpp"
+#include <print>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::bench;
+
+// The element-by-element copy that slicing amounted to before blocks shared their parent's buffer.
+Matrix copy_block(const Matrix& a, size_t row, size_t col, size_t rows, size_t cols) {
+    auto res{Matrix::empty(rows, cols)};
+    for (size_t i{0}; i < rows; i++) {
+        for (size_t j{0}; j < cols; j++) {
+            res[i, j] = a[row + i, col + j];
+        }
+    }
+    return res;
+}
+
+// The top-left half of an n x n matrix: copied, taken as a block, and then fed to a reduction and a product, where
+// the block works in place of the copy. A slice with step 2 is copied either way, for reference.
+int main() {
+    std::println("{:>6} | {:>12} {:>12} {:>12} | {:>12} {:>12} | {:>12} {:>12}", "n", "copy", "block", "step 2",
+                 "sum copy", "sum block", "gemm copy", "gemm block");
+    for (size_t n : {256, 1000, 2000}) {
+        const auto a{Matrix::zeros(n, n, 1.0)};
+        const size_t h{n / 2};
+        const double t_copy{measure([&] { (void)copy_block(a, 0, 0, h, h); })};
+        const double t_block{measure([&] { (void)a.block(0, 0, h, h); })};
+        const double t_step{measure([&] { (void)a.slice({0, h, 2}, {0, h, 2}); })};
+        const double t_sum_copy{measure([&] { (void)sum(copy_block(a, 0, 0, h, h)); })};
+        const double t_sum_block{measure([&] { (void)sum(a.block(0, 0, h, h)); })};
+        const double t_gemm_copy{measure([&] { (void)(copy_block(a, 0, 0, h, h) * copy_block(a, h, h, h, h)); })};
+        const double t_gemm_block{measure([&] { (void)(a.block(0, 0, h, h) * a.block(h, h, h, h)); })};
+        std::println("{:>6} | {:>10.3f}ms {:>10.3f}ms {:>10.3f}ms | {:>10.3f}ms {:>10.3f}ms | {:>10.3f}ms {:>10.3f}ms",
+                     n, t_copy * 1e3, t_block * 1e3, t_step * 1e3, t_sum_copy * 1e3, t_sum_block * 1e3,
+                     t_gemm_copy * 1e3, t_gemm_block * 1e3);
+    }
+}
@@ -0,0 +1,37 @@
+#include "bench.hpp"
+#include "matoy/foundations/fixed_matrix.hpp"
+#include "matoy/foundations/lu.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include <print>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::bench;
+
+template <size_t N>
+void run() {
+    FixedMatrix<N> fixed;
+    for (size_t i{0}; i < N; i++) {
+        for (size_t j{0}; j < N; j++) {
+            fixed[i, j] = i == j ? 4.0 : 1.0 / static_cast<double>(i + j + 1);
+        }
+    }
+    const Matrix dynamic{fixed};
+    double sink{0.0};
+    constexpr size_t reps{200000};
+    double t_lu = measure_ns(reps, [&] { sink += (*LU{dynamic}.inverse())[0, 0]; });
+    double t_dynamic = measure_ns(reps, [&] { sink += (*inverse(dynamic))[0, 0]; });
+    double t_fixed = measure_ns(reps, [&] {
+        auto inv = fixed.inverse();
+        sink += (*inv)[0, 0];
+        fixed[0, 0] += 1e-300; // keep the compiler from hoisting the inverse out of the loop
+    });
+    std::println("{}x{} {:>10.1f} {:>13.1f} {:>12.1f}   ({})", N, N, t_lu, t_dynamic, t_fixed, sink > 0);
+}
+
+int main() {
+    std::println("inverse  {:>10} {:>13} {:>12}", "LU ns", "Matrix ns", "Fixed ns");
+    run<2>();
+    run<3>();
+    run<4>();
+}
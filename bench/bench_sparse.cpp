@@ -0,0 +1,38 @@
+#include "bench.hpp"
+#include "matoy/foundations/sparse.hpp"
+#include <print>
+#include <random>
+
+using namespace matoy;
+using namespace matoy::bench;
+
+// An n x n matrix with about `per_row` random nonzeros in each row.
+Matrix random_sparse(size_t n, size_t per_row, std::mt19937_64& rng) {
+    std::uniform_int_distribution<size_t> col{0, n - 1};
+    std::uniform_real_distribution<double> val{-1.0, 1.0};
+    auto res{Matrix::zeros(n, n)};
+    for (size_t i{0}; i < n; i++) {
+        for (size_t k{0}; k < per_row; k++) {
+            res[i, col(rng)] = val(rng);
+        }
+    }
+    return res;
+}
+
+int main() {
+    std::mt19937_64 rng{1};
+    std::println("{:>6} {:>6} | {:>10} {:>10} | {:>10} {:>10} | {:>10} {:>10}", "n", "nnz", "dense mv", "spmv",
+                 "dense mm", "spmm", "dense mm", "spgemm");
+    for (size_t n : {500, 1000, 2000}) {
+        const Matrix a{random_sparse(n, 8, rng)}, x{Matrix::zeros(n, 1, 1.0)}, b{Matrix::zeros(n, 32, 1.0)};
+        const SparseMatrix s{a};
+        double t_mv{measure([&] { (void)(a * x); })};
+        double t_spmv{measure([&] { (void)(s * x); })};
+        double t_mm{measure([&] { (void)(a * b); })};
+        double t_spmm{measure([&] { (void)(s * b); })};
+        double t_gemm{measure([&] { (void)(a * a); })};
+        double t_spgemm{measure([&] { (void)(s * s); })};
+        std::println("{:>6} {:>6} | {:>8.3f}ms {:>8.3f}ms | {:>8.3f}ms {:>8.3f}ms | {:>8.1f}ms {:>8.3f}ms", n, s.nnz(),
+                     t_mv * 1e3, t_spmv * 1e3, t_mm * 1e3, t_spmm * 1e3, t_gemm * 1e3, t_spgemm * 1e3);
+    }
+}
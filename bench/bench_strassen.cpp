@@ -0,0 +1,63 @@
+#include "bench.hpp"
+#include "matoy/foundations/gemm.hpp"
+#include "matoy/foundations/reduce.hpp"
+#include "matoy/foundations/strassen.hpp"
+#include <print>
+#include <random>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::bench;
+
+// Random elements that are exact in single precision, so that the double precision product of the same values is
+// a reference for the single precision products.
+FloatMatrix random_matrix(size_t n, std::mt19937_64& rng) {
+    std::uniform_real_distribution<float> dist{-1.0f, 1.0f};
+    auto res{FloatMatrix::empty(n, n)};
+    for (size_t i{0}; i < n; i++) {
+        for (size_t j{0}; j < n; j++) {
+            res[i, j] = dist(rng);
+        }
+    }
+    return res;
+}
+
+// ||c - reference|| / (||a|| * ||b||), the quantity that the error bounds of both methods are stated in.
+double error(const FloatMatrix& c, const Matrix& reference, const Matrix& a, const Matrix& b) {
+    return frobenius_norm(Matrix(Matrix(c) - reference)) / (frobenius_norm(a) * frobenius_norm(b));
+}
+
+// n x n products: gemm against Strassen-Winograd with several crossovers, in double precision. STRASSEN_CROSSOVER is
+// the crossover that does best on the largest products. Then the normwise error of gemm and of Strassen-Winograd with
+// the deepest and with the default recursion, in single precision, against the double precision gemm of the same
+// inputs.
+int main() {
+    std::mt19937_64 rng{24};
+    const std::vector<size_t> crossovers{512, 1024, 2048, 4096};
+    std::print("{:>6} | {:>10}", "n", "gemm");
+    for (size_t crossover : crossovers) {
+        std::print(" {:>10}", std::format("x{}", crossover));
+    }
+    std::println(" | {:>10} {:>10} {:>10}", "err gemm", "err x256", std::format("err x{}", STRASSEN_CROSSOVER));
+
+    for (size_t n : {1024, 2048, 4096}) {
+        const auto fa{random_matrix(n, rng)}, fb{random_matrix(n, rng)};
+        const Matrix a{fa}, b{fb};
+        auto c{Matrix::empty(n, n)};
+        const double t_gemm{measure([&] { gemm(1.0, a.view(), b.view(), 0.0, c.view()); })};
+        std::print("{:>6} | {:>8.1f}ms", n, t_gemm * 1e3);
+        for (size_t crossover : crossovers) {
+            const double t{measure([&] { strassen(a.view(), b.view(), c.view(), crossover); })};
+            std::print(" {:>8.1f}ms", t * 1e3);
+        }
+
+        const auto reference{a * b};
+        auto fc{FloatMatrix::empty(n, n)};
+        gemm(1.0f, fa.view(), fb.view(), 0.0f, fc.view());
+        const double err_gemm{error(fc, reference, a, b)};
+        strassen(fa.view(), fb.view(), fc.view(), 256);
+        const double err_deep{error(fc, reference, a, b)};
+        strassen(fa.view(), fb.view(), fc.view(), STRASSEN_CROSSOVER);
+        std::println(" | {:>10.2e} {:>10.2e} {:>10.2e}", err_gemm, err_deep, error(fc, reference, a, b));
+    }
+}
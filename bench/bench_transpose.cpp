@@ -0,0 +1,25 @@
+#include "bench.hpp"
+#include "matoy/foundations/matrix.hpp"
+#include <print>
+
+using namespace matoy;
+using foundations::Layout;
+using namespace matoy::bench;
+
+int main() {
+    struct Shape {
+        size_t rows, cols;
+    };
+
+    std::println("{:>11} {:>9} {:>14} {:>15}", "shape", "copy ms", "transposed ms", "relayout ms");
+    for (auto [rows, cols] : {Shape{1000, 1000}, Shape{2000, 2000}, Shape{4000, 4000}, Shape{3000, 5000}}) {
+        auto a = Matrix::zeros(rows, cols, 1.0);
+        double t_copy = measure([&] { Matrix b{a}; });
+        double t_transposed = measure([&] { auto b = a.transposed(); });
+        // transposing only flips the layout; rearranging the buffer is the part that moves elements
+        double t_relayout = measure(
+            [&] { a.set_layout(a.layout() == Layout::RowMajor ? Layout::ColMajor : Layout::RowMajor); });
+        std::println("{:>11} {:>9.2f} {:>14.2f} {:>15.2f}", std::format("{}x{}", rows, cols), t_copy * 1e3,
+                     t_transposed * 1e3, t_relayout * 1e3);
+    }
+}
@@ -0,0 +1,300 @@
+#include "builtins.hpp"
+#include "matoy/foundations/cholesky.hpp"
+#include "matoy/foundations/eigen.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include "matoy/foundations/qr.hpp"
+#include "matoy/foundations/reduce.hpp"
+#include "matoy/foundations/strassen.hpp"
+#include "matoy/foundations/svd.hpp"
+#include "matoy/foundations/triangular.hpp"
+#include "ops.hpp"
+#include <algorithm>
+#include <iterator>
+
+namespace matoy::eval {
+
+namespace {
+
+using Args = std::vector<Value>;
+
+struct Builtin {
+    std::string_view name;
+    size_t arity;
+    auto (*call)(Args& args) -> ValueResult;
+};
+
+auto matrix_arg(Args& args, size_t i) -> diag::HintedResult<Matrix*> {
+    if (auto mat = foundations::densify(args[i])) {
+        return mat;
+    }
+    return diag::hint_error(std::format("expected a matrix for argument {}, found {}", i + 1, args[i]));
+}
+
+auto square_matrix_arg(Args& args, size_t i) -> diag::HintedResult<Matrix*> {
+    return matrix_arg(args, i).and_then([i](Matrix* mat) -> diag::HintedResult<Matrix*> {
+        if (!mat->is_square()) {
+            return diag::hint_error(std::format("expected a square matrix for argument {}", i + 1));
+        }
+        return mat;
+    });
+}
+
+auto size_arg(Args& args, size_t i) -> diag::HintedResult<size_t> {
+    if (auto n = std::get_if<values::int_t>(&args[i]); n && *n >= 0) {
+        return static_cast<size_t>(*n);
+    }
+    return diag::hint_error(std::format("expected a non-negative integer for argument {}, found {}", i + 1, args[i]));
+}
+
+auto det(Args& args) -> ValueResult {
+    if (auto band = std::get_if<BandMatrix>(&args[0])) {
+        return band->det();
+    }
+    if (auto batch = std::get_if<BatchedMatrix>(&args[0])) {
+        if (!batch->is_square()) {
+            return diag::hint_error("expected a batch of square matrices for argument 1");
+        }
+        return batch->det();
+    }
+    return square_matrix_arg(args, 0).transform([](Matrix* mat) -> Value { return foundations::det(*mat); });
+}
+
+// The lower triangular factor L of A = L * L^T.
+auto chol(Args& args) -> ValueResult {
+    return square_matrix_arg(args, 0).and_then([](Matrix* mat) -> ValueResult {
+        foundations::Cholesky chol{std::move(*mat)};
+        if (!chol.is_positive_definite()) {
+            return diag::hint_error("the matrix is not positive definite");
+        }
+        return simplify(BandMatrix::from_dense(chol.factor(), chol.factor().rows(), 0));
+    });
+}
+
+// The upper triangular factor R of A = Q * R, with min(m, n) rows.
+auto qr(Args& args) -> ValueResult {
+    return matrix_arg(args, 0).transform([](Matrix* mat) -> Value {
+        Matrix r{foundations::QR{std::move(*mat)}.r()};
+        if (r.is_square()) {
+            return simplify(BandMatrix::from_dense(r, 0, r.cols()));
+        }
+        return r;
+    });
+}
+
+// The orthonormal factor Q of A = Q * R, with min(m, n) columns.
+auto orth(Args& args) -> ValueResult {
+    return matrix_arg(args, 0).transform([](Matrix* mat) -> Value { return foundations::QR{std::move(*mat)}.q(); });
+}
+
+// The eigenvalues of a symmetric matrix as a column, in ascending order.
+auto eig(Args& args) -> ValueResult {
+    return square_matrix_arg(args, 0).and_then([](Matrix* mat) -> ValueResult {
+        if (!foundations::is_symmetric(*mat)) {
+            return diag::hint_error("expected a symmetric matrix for argument 1");
+        }
+        const foundations::SymmetricEigen eigen{std::move(*mat), false};
+        if (!eigen.converged()) {
+            return diag::hint_error("the eigenvalues did not converge");
+        }
+        return Matrix(eigen.values().size(), 1, eigen.values());
+    });
+}
+
+// The singular values as a column, in descending order.
+auto svd(Args& args) -> ValueResult {
+    return matrix_arg(args, 0).and_then([](Matrix* mat) -> ValueResult {
+        const foundations::SVD svd{std::move(*mat), false};
+        if (!svd.converged()) {
+            return diag::hint_error("the singular values did not converge");
+        }
+        return Matrix(svd.values().size(), 1, svd.values());
+    });
+}
+
+auto sparse(Args& args) -> ValueResult {
+    if (std::holds_alternative<SparseMatrix>(args[0])) {
+        return std::move(args[0]);
+    }
+    return matrix_arg(args, 0).transform([](Matrix* mat) -> Value { return SparseMatrix{*mat}; });
+}
+
+auto dense(Args& args) -> ValueResult {
+    if (auto mat = std::get_if<SparseMatrix>(&args[0])) {
+        return mat->to_dense();
+    }
+    if (auto mat = std::get_if<BandMatrix>(&args[0])) {
+        return mat->to_dense();
+    }
+    if (auto batch = std::get_if<BatchedMatrix>(&args[0])) {
+        return batch->to_stacked();
+    }
+    return matrix_arg(args, 0).transform([](Matrix* mat) -> Value { return std::move(*mat); });
+}
+
+// The blocks of `rows` rows of a matrix as a batch, e.g. batch([A; B; C], 2) for 2 x n matrices A, B and C.
+// dense(B) stacks them again.
+auto batch(Args& args) -> ValueResult {
+    return matrix_arg(args, 0).and_then([&args](Matrix* stacked) {
+        return size_arg(args, 1).and_then([stacked](size_t rows) -> ValueResult {
+            if (rows == 0 || stacked->rows() % rows != 0) {
+                return diag::hint_error(
+                    std::format("cannot split {} rows into blocks of {} rows", stacked->rows(), rows));
+            }
+            return BatchedMatrix::from_stacked(*stacked, rows);
+        });
+    });
+}
+
+auto eye(Args& args) -> ValueResult {
+    return size_arg(args, 0).transform([](size_t n) -> Value { return BandMatrix::identity(n); });
+}
+
+// A diagonal matrix with the elements of a row or column vector.
+auto diagonal(Args& args) -> ValueResult {
+    return matrix_arg(args, 0).and_then([](Matrix* vec) -> ValueResult {
+        if (vec->rows() != 1 && vec->cols() != 1) {
+            return diag::hint_error("expected a row or column vector for argument 1");
+        }
+        std::vector<double> elements(vec->size());
+        for (size_t k{0}; k < vec->size(); k++) {
+            elements[k] = vec->rows() == 1 ? (*vec)[0, k] : (*vec)[k, 0];
+        }
+        return BandMatrix::diagonal(elements);
+    });
+}
+
+auto tril(Args& args) -> ValueResult {
+    return square_matrix_arg(args, 0).transform(
+        [](Matrix* mat) { return simplify(BandMatrix::from_dense(*mat, mat->rows(), 0)); });
+}
+
+auto triu(Args& args) -> ValueResult {
+    return square_matrix_arg(args, 0).transform(
+        [](Matrix* mat) { return simplify(BandMatrix::from_dense(*mat, 0, mat->rows())); });
+}
+
+auto band(Args& args) -> ValueResult {
+    return square_matrix_arg(args, 0).and_then([&args](Matrix* mat) {
+        return size_arg(args, 1).and_then([&](size_t lower) {
+            return size_arg(args, 2).transform(
+                [&](size_t upper) { return simplify(BandMatrix::from_dense(*mat, lower, upper)); });
+        });
+    });
+}
+
+auto solve(Args& args) -> ValueResult {
+    return left_div(std::move(args[0]), std::move(args[1]));
+}
+
+// The X minimizing the norm of A * X - B.
+auto lstsq(Args& args) -> ValueResult {
+    return matrix_arg(args, 0).and_then([&args](Matrix* a) -> ValueResult {
+        if (a->rows() < a->cols()) {
+            return diag::hint_error("expected at least as many rows as columns for argument 1");
+        }
+        return left_div(std::move(*a), std::move(args[1]));
+    });
+}
+
+// A * B by Strassen-Winograd: faster for large products, but only accurate relative to the norms of A and B.
+auto strassen(Args& args) -> ValueResult {
+    return matrix_arg(args, 0).and_then([&args](Matrix* a) {
+        return matrix_arg(args, 1).and_then([a](Matrix* b) -> ValueResult {
+            if (a->cols() != b->rows()) {
+                return diag::hint_error(std::format("cannot multiply matrices of shapes {}x{} and {}x{}", a->rows(),
+                                                    a->cols(), b->rows(), b->cols()));
+            }
+            return foundations::strassen(*a, *b);
+        });
+    });
+}
+
+// The dimension collapsed by a reduction: 1 for one value per column, 2 for one value per row.
+auto axis_arg(Args& args, size_t i) -> diag::HintedResult<foundations::Axis> {
+    if (auto dim = std::get_if<values::int_t>(&args[i]); dim && (*dim == 1 || *dim == 2)) {
+        return *dim == 1 ? foundations::Axis::Rows : foundations::Axis::Cols;
+    }
+    return diag::hint_error(std::format("expected 1 or 2 for argument {}, found {}", i + 1, args[i]));
+}
+
+// A reduction along one axis, e.g. sum(A, 1) for the column sums and sum(A, 2) for the row sums. The totals are
+// the fields A.sum, A.mean, A.min and A.max.
+template <auto reduce>
+auto reduction(Args& args) -> ValueResult {
+    return matrix_arg(args, 0).and_then([&args](Matrix* mat) {
+        return axis_arg(args, 1).and_then([mat](foundations::Axis axis) -> ValueResult {
+            if constexpr (std::same_as<decltype(reduce(*mat, axis)), Matrix>) {
+                return reduce(*mat, axis);
+            } else {
+                auto res{reduce(*mat, axis)};
+                if (!res) {
+                    return diag::hint_error("the matrix is empty");
+                }
+                return std::move(*res);
+            }
+        });
+    });
+}
+
+// The norm induced by the vector 1-norm or 2-norm: the largest absolute column sum, or the largest singular value.
+// Both are the usual vector norms for columns, and rows use the vector norms too. The Frobenius norm is A.norm.
+auto norm(Args& args) -> ValueResult {
+    return matrix_arg(args, 0).and_then([&args](Matrix* mat) -> ValueResult {
+        const auto p = std::get_if<values::int_t>(&args[1]);
+        if (!p || (*p != 1 && *p != 2)) {
+            return diag::hint_error(std::format("expected 1 or 2 for argument 2, found {}", args[1]));
+        }
+        if (*p == 1) {
+            return mat->rows() == 1 ? foundations::norm_inf(*mat) : foundations::norm_1(*mat);
+        }
+        if (mat->rows() == 1 || mat->cols() == 1) {
+            return foundations::frobenius_norm(*mat);
+        }
+        const foundations::SVD svd{std::move(*mat), false};
+        if (!svd.converged()) {
+            return diag::hint_error("the singular values did not converge");
+        }
+        return svd.values().empty() ? 0.0 : svd.values().front();
+    });
+}
+
+constexpr Builtin builtins[]{
+    {"det", 1, det},
+    {"solve", 2, solve},
+    {"lstsq", 2, lstsq},
+    {"strassen", 2, strassen},
+    {"chol", 1, chol},
+    {"qr", 1, qr},
+    {"orth", 1, orth},
+    {"eig", 1, eig},
+    {"svd", 1, svd},
+    {"sparse", 1, sparse},
+    {"dense", 1, dense},
+    {"batch", 2, batch},
+    {"eye", 1, eye},
+    {"diag", 1, diagonal},
+    {"tril", 1, tril},
+    {"triu", 1, triu},
+    {"band", 3, band},
+    {"sum", 2, reduction<[](const Matrix& a, foundations::Axis axis) { return foundations::sum(a, axis); }>},
+    {"mean", 2, reduction<[](const Matrix& a, foundations::Axis axis) { return foundations::mean(a, axis); }>},
+    {"min", 2, reduction<[](const Matrix& a, foundations::Axis axis) { return foundations::min(a, axis); }>},
+    {"max", 2, reduction<[](const Matrix& a, foundations::Axis axis) { return foundations::max(a, axis); }>},
+    {"norm", 2, norm},
+};
+
+} // namespace
+
+auto call_builtin(std::string_view name, std::vector<Value> args) -> ValueResult {
+    auto it = std::ranges::find(builtins, name, &Builtin::name);
+    if (it == std::end(builtins)) {
+        return diag::hint_error(std::format("unknown function: {}", name));
+    }
+    if (args.size() != it->arity) {
+        return diag::hint_error(
+            std::format("function {} takes {} argument(s) but {} were given", name, it->arity, args.size()));
+    }
+    return it->call(args);
+}
+
+} // namespace matoy::eval
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "fwd.hpp"
+#include <string_view>
+#include <vector>
+
+namespace matoy::eval {
+
+// Call the builtin function `name` with already evaluated arguments.
+auto call_builtin(std::string_view name, std::vector<Value> args) -> ValueResult;
+
+} // namespace matoy::eval
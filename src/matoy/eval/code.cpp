@@ -1,9 +1,12 @@
 #include "matoy/diag.hpp"
 #include "matoy/eval/access.hpp"
+#include "matoy/eval/builtins.hpp"
 #include "matoy/eval/fields.hpp"
 #include "matoy/eval/fwd.hpp"
+#include "matoy/eval/index.hpp"
 #include "matoy/eval/ops.hpp"
 #include "matoy/eval/vm.hpp"
+#include "matoy/foundations/matrix_op.hpp"
 #include "matoy/syntax/ast.hpp"
 #include "matoy/syntax/op.hpp"
 
@@ -18,6 +21,8 @@ auto apply_assignment(const ast::Binary& binary, Vm& vm,
 
 auto decl_assign(const ast::Binary& binary, Vm& vm) -> diag::SourceResult<Value>;
 
+auto eval_subscripts(const ast::Index& index, Vm& vm) -> diag::SourceResult<std::vector<Subscript>>;
+
 template <>
 auto eval(const ast::Ident& self, Vm& vm) -> diag::SourceResult<Value> {
     return diag::to_source_error(clone(vm.scopes.get(self.get())), self.span());
@@ -43,23 +48,60 @@ auto eval(const ast::Bool& self, Vm&) -> diag::SourceResult<Value> {
     return self.get();
 }
 
+// The items of a matrix literal are scalars or blocks: the items of a row have the same number of rows, and all
+// rows have the same total number of columns, e.g. `[A, b; c.T, d]`. Consecutive scalars of a row are gathered
+// into one block, then foundations::block_matrix copies each block into place.
 template <>
 auto eval(const ast::Matrix& self, Vm& vm) -> diag::SourceResult<Value> {
-    auto [rows, cols] = self.shape();
-    std::vector<double> elems;
-    for (auto&& item : self.items()) {
-        auto val = eval(item, vm);
-        if (!val)
-            return val;
-        if (auto p = std::get_if<int64_t>(&*val)) {
-            elems.push_back(*p);
-        } else if (auto p = std::get_if<double>(&*val)) {
-            elems.push_back(*p);
-        } else {
-            return diag::source_error(get_span(item), "the item can't fit into a matrix");
+    std::vector<std::vector<Matrix>> rows;
+    size_t cols{0};
+    for (auto&& row : self.rows()) {
+        auto& blocks = rows.emplace_back();
+        std::vector<double> scalars;
+        const auto flush = [&]() {
+            if (!scalars.empty()) {
+                blocks.emplace_back(1, scalars.size(), scalars);
+                scalars.clear();
+            }
+        };
+        size_t height{0}, width{0};
+        bool first{true};
+        for (auto&& item : row.items()) {
+            auto val = eval(item, vm);
+            if (!val)
+                return val;
+            foundations::densify(*val);
+            size_t rows_of_item{1}, cols_of_item{1};
+            if (auto p = std::get_if<int64_t>(&*val)) {
+                scalars.push_back(static_cast<double>(*p));
+            } else if (auto p = std::get_if<double>(&*val)) {
+                scalars.push_back(*p);
+            } else if (auto p = std::get_if<Matrix>(&*val)) {
+                std::tie(rows_of_item, cols_of_item) = p->shape();
+                flush();
+                blocks.push_back(std::move(*p));
+            } else {
+                return diag::source_error(get_span(item), "the item can't fit into a matrix");
+            }
+            if (first) {
+                height = rows_of_item;
+                first = false;
+            } else if (rows_of_item != height) {
+                return diag::source_error(get_span(item),
+                                          std::format("expected {} rows like the rest of the row, found {}", height,
+                                                      rows_of_item));
+            }
+            width += cols_of_item;
+        }
+        flush();
+        if (rows.size() == 1) {
+            cols = width;
+        } else if (width != cols) {
+            return diag::source_error(get_span(row),
+                                      std::format("expected {} columns like the first row, found {}", cols, width));
         }
     }
-    return Matrix(rows, cols, elems);
+    return *foundations::block_matrix(rows);
 }
 
 template <>
@@ -99,10 +141,14 @@ auto eval(const ast::Unary& self, Vm& vm) -> diag::SourceResult<Value> {
 template <>
 auto eval(const ast::Binary& self, Vm& vm) -> diag::SourceResult<Value> {
     switch (self.op()) {
-    case syntax::BinOp::Add: return apply_binary(self, vm, add);
-    case syntax::BinOp::Sub: return apply_binary(self, vm, sub);
-    case syntax::BinOp::Mul: return apply_binary(self, vm, mul);
-    case syntax::BinOp::Div: return apply_binary(self, vm, div);
+    case syntax::BinOp::Add:     return apply_binary(self, vm, add);
+    case syntax::BinOp::Sub:     return apply_binary(self, vm, sub);
+    case syntax::BinOp::Mul:     return apply_binary(self, vm, mul);
+    case syntax::BinOp::Div:     return apply_binary(self, vm, div);
+    case syntax::BinOp::ElemMul: return apply_binary(self, vm, elem_mul);
+    case syntax::BinOp::ElemDiv: return apply_binary(self, vm, elem_div);
+    case syntax::BinOp::LeftDiv: return apply_binary(self, vm, left_div);
+    case syntax::BinOp::Pow:     return apply_binary(self, vm, pow);
 
     case syntax::BinOp::Eq:  return apply_binary(self, vm, eq);
     case syntax::BinOp::Neq: return apply_binary(self, vm, neq);
@@ -131,12 +177,39 @@ auto eval(const ast::FieldAccess& self, Vm& vm) -> diag::SourceResult<Value> {
     if (!value)
         return value;
     auto field = self.field();
-    return diag::to_source_error(get_field(*value, field.get()), self.span());
+    return diag::to_source_error(get_field(std::move(*value), field.get()), self.span());
 }
 
 template <>
-auto eval(const ast::FuncCall&, Vm&) -> diag::SourceResult<Value> {
-    return {};
+auto eval(const ast::FuncCall& self, Vm& vm) -> diag::SourceResult<Value> {
+    auto callee = self.callee();
+    auto ident = std::get_if<ast::Ident>(&callee);
+    if (!ident) {
+        return diag::source_error(get_span(callee), "only builtin functions can be called");
+    }
+
+    std::vector<Value> args;
+    for (auto&& item : self.args().items()) {
+        auto arg = eval(item, vm);
+        if (!arg)
+            return arg;
+        args.push_back(std::move(*arg));
+    }
+
+    return diag::to_source_error(call_builtin(ident->get(), std::move(args)), self.span());
+}
+
+template <>
+auto eval(const ast::Index& self, Vm& vm) -> diag::SourceResult<Value> {
+    auto target = eval(self.target(), vm);
+    if (!target)
+        return target;
+
+    auto subscripts = eval_subscripts(self, vm);
+    if (!subscripts)
+        return std::unexpected{std::move(subscripts).error()};
+
+    return diag::to_source_error(get_index(std::move(*target), *subscripts), self.span());
 }
 
 template <>
@@ -177,7 +250,34 @@ inline auto apply_assignment(const ast::Binary& binary, Vm& vm,
     if (!rhs)
         return rhs;
 
-    auto loc = access(binary.lhs(), vm);
+    // `A[i, j] = x` writes into the elements of A in place
+    auto lhs = binary.lhs();
+    if (auto index = std::get_if<ast::Index>(&lhs)) {
+        auto subscripts = eval_subscripts(*index, vm);
+        if (!subscripts)
+            return std::unexpected{std::move(subscripts).error()};
+
+        auto loc = access(index->target(), vm);
+        if (!loc)
+            return clone(std::move(loc));
+
+        auto res = [&]() -> ValueResult {
+            if (binary.op() == syntax::BinOp::Assign) {
+                return std::move(*rhs);
+            }
+            auto old = get_index(**loc, *subscripts);
+            if (!old)
+                return old;
+            // the old elements are released before writing, so that a slice sharing the buffer doesn't force a copy
+            return op(std::move(*old), std::move(*rhs));
+        }();
+        if (!res)
+            return diag::to_source_error(std::move(res), binary.span());
+
+        return diag::to_source_error(set_index(**loc, *subscripts, std::move(*res)), binary.span());
+    }
+
+    auto loc = access(lhs, vm);
     if (!loc)
         return clone(std::move(loc));
 
@@ -190,6 +290,36 @@ inline auto apply_assignment(const ast::Binary& binary, Vm& vm,
     return *res;
 }
 
+inline auto eval_subscripts(const ast::Index& index, Vm& vm) -> diag::SourceResult<std::vector<Subscript>> {
+    auto part = [&vm](const std::optional<ast::Expr>& expr) -> diag::SourceResult<std::optional<values::int_t>> {
+        if (!expr)
+            return std::nullopt;
+        auto value = eval(*expr, vm);
+        if (!value)
+            return std::unexpected{std::move(value).error()};
+        if (auto i = std::get_if<values::int_t>(&*value)) {
+            return *i;
+        }
+        return diag::source_error(get_span(*expr), std::format("expected an integer index, found {}", *value));
+    };
+
+    std::vector<Subscript> res;
+    for (auto& sub : index.subscripts()) {
+        auto range = std::get_if<ast::Range>(&sub);
+        auto start = part(range ? range->start() : std::get<ast::Expr>(sub));
+        if (!start)
+            return std::unexpected{std::move(start).error()};
+        auto stop = part(range ? range->stop() : std::nullopt);
+        if (!stop)
+            return std::unexpected{std::move(stop).error()};
+        auto step = part(range ? range->step() : std::nullopt);
+        if (!step)
+            return std::unexpected{std::move(step).error()};
+        res.push_back(Subscript{range != nullptr, *start, *stop, *step});
+    }
+    return res;
+}
+
 inline auto decl_assign(const ast::Binary& binary, Vm& vm) -> diag::SourceResult<Value> {
     auto ident = std::get<ast::Ident>(binary.lhs());
 
@@ -1,20 +1,75 @@
 #include "fields.hpp"
 #include "matoy/foundations/matrix_op.hpp"
+#include "matoy/foundations/reduce.hpp"
 #include "matoy/utils/match.hpp"
 
 namespace matoy::eval {
 
-auto get_field(const Value& self, std::string_view field) -> diag::StrResult<Value> {
-    return self.visit(utils::overloaded{
-        [field](const Matrix& matrix) -> diag::StrResult<Value> {
+auto get_field(Value self, std::string_view field) -> diag::StrResult<Value> {
+    return std::move(self).visit(utils::overloaded{
+        [field](Matrix&& matrix) -> diag::StrResult<Value> {
             if (field == "T") {
-                return matrix.transposed();
+                matrix.transpose();
+                return std::move(matrix);
             }
             if (field == "I") {
                 return ok_or_else(inverse(matrix), []() { return std::format("the matrix is not invertible"); });
             }
+            // reductions over all elements, see the builtins of the same names for one value per row or column
+            if (field == "sum") {
+                return foundations::sum(matrix);
+            }
+            if (field == "mean") {
+                return foundations::mean(matrix);
+            }
+            if (field == "min") {
+                return ok_or_else(foundations::min(matrix), []() { return std::format("the matrix is empty"); });
+            }
+            if (field == "max") {
+                return ok_or_else(foundations::max(matrix), []() { return std::format("the matrix is empty"); });
+            }
+            if (field == "norm") {
+                return foundations::frobenius_norm(matrix);
+            }
             return std::unexpected{std::format("type matrix does not contain field \"{}\"", field)};
         },
+        [field](SparseMatrix&& matrix) -> diag::StrResult<Value> {
+            if (field == "T") {
+                return matrix.transposed();
+            }
+            if (field == "nnz") {
+                return static_cast<values::int_t>(matrix.nnz());
+            }
+            // the inverse and the reductions have no sparse kernel
+            return get_field(matrix.to_dense(), field);
+        },
+        [field](BandMatrix&& matrix) -> diag::StrResult<Value> {
+            if (field == "T") {
+                return matrix.transposed();
+            }
+            if (field == "I") {
+                return ok_or_else(matrix.inverse().transform(foundations::simplify),
+                                  []() { return std::format("the matrix is not invertible"); });
+            }
+            // the reductions have no band kernel
+            return get_field(matrix.to_dense(), field);
+        },
+        [field](BatchedMatrix&& batch) -> diag::StrResult<Value> {
+            if (field == "T") {
+                return batch.transposed();
+            }
+            if (field == "I") {
+                if (!batch.is_square()) {
+                    return std::unexpected{"the matrices are not square"};
+                }
+                return ok_or_else(batch.inverse(),
+                                  []() { return std::format("a matrix in the batch is not invertible"); });
+            }
+            if (field == "count") {
+                return static_cast<values::int_t>(batch.count());
+            }
+            return std::unexpected{std::format("type batch does not contain field \"{}\"", field)};
+        },
         [](const auto&) -> diag::StrResult<Value> { return std::unexpected{"cannot access fields on type"}; },
     });
 }
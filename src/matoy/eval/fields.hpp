@@ -6,6 +6,6 @@
 
 namespace matoy::eval {
 
-auto get_field(const Value& self, std::string_view field) -> diag::StrResult<Value>;
+auto get_field(Value self, std::string_view field) -> diag::StrResult<Value>;
 
 } // namespace matoy::eval
@@ -39,7 +39,9 @@ template <> auto eval(const ast::Binary& self, Vm& vm) -> diag::SourceResult<Val
 
 template <> auto eval(const ast::FieldAccess& self, Vm& vm) -> diag::SourceResult<Value>;
 
-template <> auto eval(const ast::FuncCall&, Vm&) -> diag::SourceResult<Value>;
+template <> auto eval(const ast::FuncCall& self, Vm& vm) -> diag::SourceResult<Value>;
+
+template <> auto eval(const ast::Index& self, Vm& vm) -> diag::SourceResult<Value>;
 
 template <> auto eval(const ast::Expr& self, Vm& vm) -> diag::SourceResult<Value>;
 
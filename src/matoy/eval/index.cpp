@@ -0,0 +1,104 @@
+#include "index.hpp"
+#include "matoy/utils/match.hpp"
+#include <algorithm>
+#include <format>
+#include <string_view>
+#include <utility>
+
+namespace matoy::eval {
+
+using foundations::Slice;
+
+static auto to_slice(const Subscript& sub, size_t extent, std::string_view dim) -> diag::HintedResult<Slice> {
+    const auto n{static_cast<values::int_t>(extent)};
+    if (!sub.is_range) {
+        if (*sub.start < 0 || *sub.start >= n) {
+            return diag::hint_error(std::format("index {} is out of bounds for {} {}", *sub.start, extent, dim));
+        }
+        return Slice{static_cast<size_t>(*sub.start), 1};
+    }
+    const auto start{sub.start.value_or(0)}, stop{sub.stop.value_or(n)}, step{sub.step.value_or(1)};
+    if (step <= 0) {
+        return diag::hint_error(std::format("the step of a range must be positive, found {}", step));
+    }
+    if (start < 0 || stop > n || start > stop) {
+        return diag::hint_error(std::format("range {}:{} is out of bounds for {} {}", start, stop, extent, dim));
+    }
+    // rounded up without forming stop - start + step, which overflows for a large step
+    const auto count{(stop - start) / step + ((stop - start) % step != 0)};
+    return Slice{static_cast<size_t>(start), static_cast<size_t>(count), static_cast<size_t>(step)};
+}
+
+// The rows and the columns that the subscripts select.
+static auto to_slices(const Matrix& a, std::span<const Subscript> subscripts)
+    -> diag::HintedResult<std::pair<Slice, Slice>> {
+    if (subscripts.size() == 1 && (a.rows() == 1 || a.cols() == 1)) {
+        const bool row{a.rows() == 1};
+        auto s = to_slice(subscripts[0], row ? a.cols() : a.rows(), "elements");
+        if (!s)
+            return std::unexpected{std::move(s).error()};
+        return row ? std::pair{Slice{0, 1}, *s} : std::pair{*s, Slice{0, 1}};
+    }
+    if (subscripts.size() != 2) {
+        return diag::hint_error(
+            std::format("expected 2 subscripts for a {}x{} matrix, found {}", a.rows(), a.cols(), subscripts.size()));
+    }
+    auto rows = to_slice(subscripts[0], a.rows(), "rows");
+    if (!rows)
+        return std::unexpected{std::move(rows).error()};
+    auto cols = to_slice(subscripts[1], a.cols(), "columns");
+    if (!cols)
+        return std::unexpected{std::move(cols).error()};
+    return std::pair{*rows, *cols};
+}
+
+auto get_index(Value self, std::span<const Subscript> subscripts) -> ValueResult {
+    const auto matrix = foundations::densify(self);
+    if (!matrix) {
+        return diag::hint_error(std::format("cannot index {}", self));
+    }
+    auto slices = to_slices(*matrix, subscripts);
+    if (!slices)
+        return std::unexpected{std::move(slices).error()};
+    const auto [rows, cols] = *slices;
+    if (std::ranges::none_of(subscripts, &Subscript::is_range)) {
+        return std::as_const(*matrix)[rows.start, cols.start];
+    }
+    return matrix->slice(rows, cols);
+}
+
+// Writing into a sparse or band matrix may break its structure, so the variable holds a dense matrix afterwards.
+auto set_index(Value& self, std::span<const Subscript> subscripts, Value value) -> ValueResult {
+    const auto matrix = foundations::densify(self);
+    if (!matrix) {
+        return diag::hint_error(std::format("cannot index {}", self));
+    }
+    auto slices = to_slices(*matrix, subscripts);
+    if (!slices)
+        return std::unexpected{std::move(slices).error()};
+    const auto [rows, cols] = *slices;
+
+    foundations::densify(value);
+    auto block = value.visit(utils::overloaded{
+        [&](values::int_t x) -> diag::HintedResult<Matrix> {
+            return Matrix::zeros(rows.count, cols.count, static_cast<double>(x));
+        },
+        [&](values::float_t x) -> diag::HintedResult<Matrix> { return Matrix::zeros(rows.count, cols.count, x); },
+        [&](const Matrix& x) -> diag::HintedResult<Matrix> {
+            if (x.shape() != std::pair{rows.count, cols.count}) {
+                return diag::hint_error(std::format("cannot assign a {}x{} matrix to {} rows and {} columns",
+                                                    x.rows(), x.cols(), rows.count, cols.count));
+            }
+            return x;
+        },
+        [](const auto& x) -> diag::HintedResult<Matrix> {
+            return diag::hint_error(std::format("cannot assign {} to matrix elements", x));
+        },
+    });
+    if (!block)
+        return std::unexpected{std::move(block).error()};
+    matrix->set_slice(rows, cols, *block);
+    return value;
+}
+
+} // namespace matoy::eval
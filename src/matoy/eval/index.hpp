@@ -0,0 +1,23 @@
+#pragma once
+
+#include "fwd.hpp"
+#include <optional>
+#include <span>
+
+namespace matoy::eval {
+
+// A subscript of an index expression with its parts evaluated: a single index in `start`, or a range whose missing
+// parts span the whole dimension.
+struct Subscript {
+    bool is_range;
+    std::optional<values::int_t> start, stop, step;
+};
+
+// The element of a matrix at single indices, or the matrix at ranges, which shares the buffer when the ranges have
+// unit steps. Indices start at 0, ranges leave out their stop, and vectors also take a single subscript.
+auto get_index(Value self, std::span<const Subscript> subscripts) -> ValueResult;
+
+// Overwrite what `get_index` returns, in place, with a scalar or with a matrix of the same shape. Returns `value`.
+auto set_index(Value& self, std::span<const Subscript> subscripts, Value value) -> ValueResult;
+
+} // namespace matoy::eval
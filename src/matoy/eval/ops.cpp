@@ -1,8 +1,78 @@
 #include "ops.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include "matoy/foundations/qr.hpp"
 #include "matoy/utils/match.hpp"
+#include <cmath>
+#include <optional>
+#include <type_traits>
 
 namespace matoy::eval {
 
+namespace {
+
+// Results pass through unchanged, except for bands, which may have filled in.
+template <class T>
+auto simplified(T&& x) -> T&& {
+    return std::forward<T>(x);
+}
+
+auto simplified(BandMatrix&& x) -> Value {
+    return foundations::simplify(std::move(x));
+}
+
+template <class T>
+concept number = std::same_as<T, values::int_t> || std::same_as<T, values::float_t>;
+
+// An elementwise operation on two dense matrices, broadcasting vectors across the other operand.
+auto zip_matrices(auto op, Matrix&& a, Matrix&& b, std::string_view verb) -> ValueResult {
+    const auto [m, n] = a.shape();
+    return ok_or_else(op(std::move(a), b), [&] {
+        return diag::Hints{std::format("cannot {} matrices of shapes {}x{} and {}x{}", verb, m, n, b.rows(), b.cols())};
+    });
+}
+
+// Matrices in any storage. Their operators only assert that the shapes fit, so the shapes are checked here first.
+template <class T>
+concept matrix = std::same_as<T, Matrix> || std::same_as<T, SparseMatrix> || std::same_as<T, BandMatrix> ||
+                 std::same_as<T, BatchedMatrix>;
+
+// The error of a sum or product of two matrices whose shapes don't fit. Sums need the same shape and products
+// matching inner dimensions. Two batches also need the same count. A scalar fits anything.
+template <class A, class B>
+auto shape_mismatch(std::string_view verb, const A& a, const B& b, bool product) -> std::optional<diag::Hints> {
+    if constexpr (std::same_as<A, BatchedMatrix> && std::same_as<B, BatchedMatrix>) {
+        if (a.count() != b.count()) {
+            return diag::Hints{std::format("cannot {} batches of {} and {} matrices", verb, a.count(), b.count())};
+        }
+    }
+    if constexpr (matrix<A> && matrix<B>) {
+        if (product ? a.cols() != b.rows() : a.shape() != b.shape()) {
+            return diag::Hints{std::format("cannot {} matrices of shapes {}x{} and {}x{}", verb, a.rows(), a.cols(),
+                                           b.rows(), b.cols())};
+        }
+    }
+    return std::nullopt;
+}
+
+// A single matrix whose storage doesn't change its value, so that a sparse or band matrix equals the dense matrix of
+// its elements.
+template <class T>
+concept stored_matrix = std::same_as<T, Matrix> || std::same_as<T, SparseMatrix> || std::same_as<T, BandMatrix>;
+
+auto to_dense(const Matrix& a) -> const Matrix& {
+    return a;
+}
+
+auto to_dense(const SparseMatrix& a) -> Matrix {
+    return a.to_dense();
+}
+
+auto to_dense(const BandMatrix& a) -> Matrix {
+    return a.to_dense();
+}
+
+} // namespace
+
 auto pos(Value rhs) -> ValueResult {
     return std::move(rhs).visit<ValueResult>([](auto&& v) {
         if constexpr (requires { +v; }) {
@@ -14,13 +84,20 @@ auto pos(Value rhs) -> ValueResult {
 }
 
 auto neg(Value rhs) -> ValueResult {
-    return std::move(rhs).visit<ValueResult>([](auto&& v) {
-        if constexpr (requires { +v; }) {
-            return -v;
-        } else {
-            return diag::hint_error(std::format("cannot apply unary '-' to {}", v));
-        }
-    });
+    return std::move(rhs).visit<ValueResult>(utils::overloaded{
+        [](Matrix&& v) -> ValueResult {
+            v.negate();
+            return std::move(v);
+        },
+        [](SparseMatrix&& v) -> ValueResult { return -std::move(v); },
+        [](BatchedMatrix&& v) -> ValueResult { return -std::move(v); },
+        [](auto&& v) -> ValueResult {
+            if constexpr (requires { +v; }) {
+                return -v;
+            } else {
+                return diag::hint_error(std::format("cannot apply unary '-' to {}", v));
+            }
+        }});
 }
 
 auto not_(Value rhs) -> ValueResult {
@@ -31,33 +108,50 @@ auto not_(Value rhs) -> ValueResult {
 
 auto add(Value lhs, Value rhs) -> ValueResult {
     return std::visit<ValueResult>(
-        [](auto&& a, auto&& b) {
-            if constexpr (requires { a + b; }) {
-                return a + b;
-            } else {
-                return diag::hint_error(std::format("cannot add {} and {}", a, b));
-            }
-        },
+        utils::overloaded{
+            [](Matrix&& a, Matrix&& b) {
+                return zip_matrices(foundations::broadcast_add, std::move(a), std::move(b), "add");
+            },
+            [](auto&& a, auto&& b) -> ValueResult {
+                if constexpr (requires { a + b; }) {
+                    if (auto err{shape_mismatch("add", a, b, false)}) {
+                        return std::unexpected{std::move(*err)};
+                    }
+                    return simplified(std::move(a) + std::move(b));
+                } else {
+                    return diag::hint_error(std::format("cannot add {} and {}", a, b));
+                }
+            }},
         std::move(lhs), std::move(rhs));
 }
 
 auto sub(Value lhs, Value rhs) -> ValueResult {
     return std::visit<ValueResult>(
-        [](auto&& a, auto&& b) {
-            if constexpr (requires { a - b; }) {
-                return a - b;
-            } else {
-                return diag::hint_error(std::format("cannot subtract {1} from {0}", a, b));
-            }
-        },
+        utils::overloaded{
+            [](Matrix&& a, Matrix&& b) {
+                return zip_matrices(foundations::broadcast_sub, std::move(a), std::move(b), "subtract");
+            },
+            [](auto&& a, auto&& b) -> ValueResult {
+                if constexpr (requires { a - b; }) {
+                    if (auto err{shape_mismatch("subtract", a, b, false)}) {
+                        return std::unexpected{std::move(*err)};
+                    }
+                    return simplified(std::move(a) - std::move(b));
+                } else {
+                    return diag::hint_error(std::format("cannot subtract {1} from {0}", a, b));
+                }
+            }},
         std::move(lhs), std::move(rhs));
 }
 
 auto mul(Value lhs, Value rhs) -> ValueResult {
     return std::visit<ValueResult>(
-        [](auto&& a, auto&& b) {
+        [](auto&& a, auto&& b) -> ValueResult {
             if constexpr (requires { a* b; }) {
-                return a * b;
+                if (auto err{shape_mismatch("multiply", a, b, true)}) {
+                    return std::unexpected{std::move(*err)};
+                }
+                return simplified(std::move(a) * std::move(b));
             } else {
                 return diag::hint_error(std::format("cannot multiply {} with {}", a, b));
             }
@@ -69,7 +163,7 @@ auto div(Value lhs, Value rhs) -> ValueResult {
     return std::visit<ValueResult>(
         [](auto&& a, auto&& b) {
             if constexpr (requires { a / b; }) {
-                return a / b;
+                return simplified(std::move(a) / std::move(b));
             } else {
                 return diag::hint_error(std::format("cannot divide {} by {}", a, b));
             }
@@ -77,6 +171,123 @@ auto div(Value lhs, Value rhs) -> ValueResult {
         std::move(lhs), std::move(rhs));
 }
 
+// With a scalar on either side, .* is the same as * and ./ divides each element.
+auto elem_mul(Value lhs, Value rhs) -> ValueResult {
+    return std::visit<ValueResult>(
+        utils::overloaded{
+            [](Matrix&& a, Matrix&& b) {
+                return zip_matrices(foundations::broadcast_mul, std::move(a), std::move(b), "multiply");
+            },
+            [](auto&& a, auto&& b) -> ValueResult {
+                using A = std::remove_cvref_t<decltype(a)>;
+                using B = std::remove_cvref_t<decltype(b)>;
+                if constexpr ((number<A> || number<B>) && requires { a * b; }) {
+                    return simplified(std::move(a) * std::move(b));
+                } else {
+                    return diag::hint_error(std::format("cannot multiply {} and {} elementwise", a, b));
+                }
+            }},
+        std::move(lhs), std::move(rhs));
+}
+
+auto elem_div(Value lhs, Value rhs) -> ValueResult {
+    return std::visit<ValueResult>(
+        utils::overloaded{
+            [](Matrix&& a, Matrix&& b) {
+                return zip_matrices(foundations::broadcast_div, std::move(a), std::move(b), "divide");
+            },
+            []<number A>(A&& a, Matrix&& b) -> ValueResult {
+                const auto x{static_cast<values::float_t>(a)};
+                return Matrix(
+                    foundations::MapExpr{[x](double y) { return x / y; }, foundations::as_expr(std::move(b))});
+            },
+            [](auto&& a, auto&& b) -> ValueResult {
+                using B = std::remove_cvref_t<decltype(b)>;
+                if constexpr (number<B> && requires { a / b; }) {
+                    return simplified(std::move(a) / std::move(b));
+                } else {
+                    return diag::hint_error(std::format("cannot divide {} by {} elementwise", a, b));
+                }
+            }},
+        std::move(lhs), std::move(rhs));
+}
+
+auto left_div(Value lhs, Value rhs) -> ValueResult {
+    return std::visit<ValueResult>(
+        utils::overloaded{
+            [](Matrix&& a, Matrix&& b) -> ValueResult {
+                if (a.rows() < a.cols()) {
+                    return diag::hint_error("cannot left-divide by a matrix with fewer rows than columns");
+                }
+                if (a.rows() != b.rows()) {
+                    return diag::hint_error(
+                        std::format("cannot left-divide matrices with {} and {} rows", a.rows(), b.rows()));
+                }
+                if (!a.is_square()) {
+                    // overdetermined, so solve in the least-squares sense
+                    return ok_or_else(foundations::lstsq(a, b),
+                                      [] { return diag::Hints{"the matrix is rank deficient"}; });
+                }
+                return ok_or_else(foundations::solve(a, b), [] { return diag::Hints{"the matrix is singular"}; });
+            },
+            [](BandMatrix&& a, Matrix&& b) -> ValueResult {
+                if (a.rows() != b.rows()) {
+                    return diag::hint_error(
+                        std::format("cannot left-divide matrices with {} and {} rows", a.rows(), b.rows()));
+                }
+                return ok_or_else(a.solve(b), [] { return diag::Hints{"the matrix is singular"}; });
+            },
+            [](auto&& a, auto&& b) {
+                if constexpr (requires { b / a; }) {
+                    return b / a;
+                } else {
+                    return diag::hint_error(std::format("cannot left-divide {} by {}", b, a));
+                }
+            }},
+        std::move(lhs), std::move(rhs));
+}
+
+auto pow(Value lhs, Value rhs) -> ValueResult {
+    return std::visit<ValueResult>(
+        utils::overloaded{
+            [](values::int_t&& a, values::int_t&& b) -> ValueResult {
+                if (b < 0) {
+                    return std::pow(static_cast<values::float_t>(a), static_cast<values::float_t>(b));
+                }
+                // by squaring, in unsigned arithmetic so that overflow wraps around
+                uint64_t res{1}, base{static_cast<uint64_t>(a)};
+                for (auto e{static_cast<uint64_t>(b)}; e != 0; e >>= 1) {
+                    if (e & 1) {
+                        res *= base;
+                    }
+                    base *= base;
+                }
+                return static_cast<values::int_t>(res);
+            },
+            [](Matrix&& a, values::int_t&& b) -> ValueResult {
+                if (!a.is_square()) {
+                    return diag::hint_error("cannot raise a non-square matrix to a power");
+                }
+                return ok_or_else(foundations::power(std::move(a), b),
+                                  [] { return diag::Hints{"the matrix is singular"}; });
+            },
+            [](BandMatrix&& a, values::int_t&& b) -> ValueResult {
+                return ok_or_else(a.power(b).transform(foundations::simplify),
+                                  [] { return diag::Hints{"the matrix is singular"}; });
+            },
+            [](auto&& a, auto&& b) -> ValueResult {
+                using A = std::remove_cvref_t<decltype(a)>;
+                using B = std::remove_cvref_t<decltype(b)>;
+                if constexpr ((std::is_same_v<A, values::int_t> || std::is_same_v<A, values::float_t>) &&
+                              (std::is_same_v<B, values::int_t> || std::is_same_v<B, values::float_t>)) {
+                    return std::pow(static_cast<values::float_t>(a), static_cast<values::float_t>(b));
+                } else {
+                    return diag::hint_error(std::format("cannot raise {} to the power of {}", a, b));
+                }
+            }},
+        std::move(lhs), std::move(rhs));
+}
+
 auto and_(Value lhs, Value rhs) -> ValueResult {
     return std::visit<ValueResult>(
         utils::overloaded{
@@ -94,9 +305,14 @@ auto or_(Value lhs, Value rhs) -> ValueResult {
 }
 
 auto equal(const Value& lhs, const Value& rhs) -> bool {
-    return std::visit<bool>(utils::overloaded{                                              //
-                                              []<class T>(T&& a, T&& b) { return a == b; }, //
-                                              [](auto&&, auto&&) { return false; }},        //
+    return std::visit<bool>(utils::overloaded{[]<class T>(T&& a, T&& b) { return a == b; },
+                                              []<class A, class B>(const A& a, const B& b) {
+                                                  if constexpr (stored_matrix<A> && stored_matrix<B>) {
+                                                      return to_dense(a) == to_dense(b);
+                                                  } else {
+                                                      return false;
+                                                  }
+                                              }},
                             lhs, rhs);
 }
 
@@ -135,8 +351,14 @@ auto geq(Value lhs, Value rhs) -> ValueResult {
 auto aeq(Value lhs, Value rhs) -> ValueResult {
     return std::visit<ValueResult>(
         utils::overloaded{
-            []<class T>(T&& a, T&& b) { return foundations::approx(a, b); },
-            [](auto&& a, auto&& b) { return diag::hint_error(std::format("cannot compare {} and {}", a, b)); }},
+            []<class T>(T&& a, T&& b) -> ValueResult { return foundations::approx(a, b); },
+            []<class A, class B>(const A& a, const B& b) -> ValueResult {
+                if constexpr (stored_matrix<A> && stored_matrix<B>) {
+                    return foundations::approx(to_dense(a), to_dense(b));
+                } else {
+                    return diag::hint_error(std::format("cannot compare {} and {}", a, b));
+                }
+            }},
         lhs, rhs);
 }
 
@@ -20,6 +20,17 @@ auto mul(Value lhs, Value rhs) -> ValueResult;
 
 auto div(Value lhs, Value rhs) -> ValueResult;
 
+// Elementwise product and quotient. Like + and -, they broadcast a row or column vector (or a 1 x 1 matrix)
+// across the other operand, NumPy style: each dimension must either match or be 1 in one of the operands.
+auto elem_mul(Value lhs, Value rhs) -> ValueResult;
+
+auto elem_div(Value lhs, Value rhs) -> ValueResult;
+
+auto left_div(Value lhs, Value rhs) -> ValueResult;
+
+// Integer powers of square matrices by repeated squaring. Negative exponents invert the matrix first.
+auto pow(Value lhs, Value rhs) -> ValueResult;
+
 auto and_(Value lhs, Value rhs) -> ValueResult;
 
 auto or_(Value lhs, Value rhs) -> ValueResult;
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "cpu.hpp"
+#include <cstddef>
+
+#ifdef MATOY_X86_DISPATCH
+#include <immintrin.h>
+
+// One ymm register of floats or doubles, so that the AVX2 kernels are written once for both precisions.
+// Only meant to be called from functions compiled with [[gnu::target("avx2,fma")]].
+namespace matoy::foundations::avx2 {
+
+#define MATOY_AVX2 gnu::target("avx2,fma"), gnu::always_inline
+
+template <class T>
+struct Vec;
+
+template <>
+struct Vec<double> {
+    using reg = __m256d;
+    static constexpr size_t lanes = 4;
+
+    [[MATOY_AVX2]] static auto zero() -> reg {
+        return _mm256_setzero_pd();
+    }
+    [[MATOY_AVX2]] static auto set1(double x) -> reg {
+        return _mm256_set1_pd(x);
+    }
+    [[MATOY_AVX2]] static auto broadcast(const double* p) -> reg {
+        return _mm256_broadcast_sd(p);
+    }
+    [[MATOY_AVX2]] static auto load(const double* p) -> reg {
+        return _mm256_loadu_pd(p);
+    }
+    [[MATOY_AVX2]] static void store(double* p, reg x) {
+        _mm256_storeu_pd(p, x);
+    }
+    [[MATOY_AVX2]] static auto add(reg x, reg y) -> reg {
+        return _mm256_add_pd(x, y);
+    }
+    [[MATOY_AVX2]] static auto sub(reg x, reg y) -> reg {
+        return _mm256_sub_pd(x, y);
+    }
+    [[MATOY_AVX2]] static auto mul(reg x, reg y) -> reg {
+        return _mm256_mul_pd(x, y);
+    }
+    [[MATOY_AVX2]] static auto div(reg x, reg y) -> reg {
+        return _mm256_div_pd(x, y);
+    }
+    [[MATOY_AVX2]] static auto bit_xor(reg x, reg y) -> reg {
+        return _mm256_xor_pd(x, y);
+    }
+    // x * y + z with a single rounding
+    [[MATOY_AVX2]] static auto fmadd(reg x, reg y, reg z) -> reg {
+        return _mm256_fmadd_pd(x, y, z);
+    }
+    [[MATOY_AVX2]] static auto abs(reg x) -> reg {
+        return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+    }
+    [[MATOY_AVX2]] static auto min(reg x, reg y) -> reg {
+        return _mm256_min_pd(x, y);
+    }
+    [[MATOY_AVX2]] static auto max(reg x, reg y) -> reg {
+        return _mm256_max_pd(x, y);
+    }
+    // All bits set in the lanes where x <= y, none elsewhere.
+    [[MATOY_AVX2]] static auto less_equal(reg x, reg y) -> reg {
+        return _mm256_cmp_pd(x, y, _CMP_LE_OQ);
+    }
+    [[MATOY_AVX2]] static auto less(reg x, reg y) -> reg {
+        return _mm256_cmp_pd(x, y, _CMP_LT_OQ);
+    }
+    // All bits set in the lanes where x is NaN.
+    [[MATOY_AVX2]] static auto is_nan(reg x) -> reg {
+        return _mm256_cmp_pd(x, x, _CMP_UNORD_Q);
+    }
+    // x in the lanes where the mask is set, y elsewhere.
+    [[MATOY_AVX2]] static auto select(reg mask, reg x, reg y) -> reg {
+        return _mm256_blendv_pd(y, x, mask);
+    }
+    // One bit per lane, set where the mask is.
+    [[MATOY_AVX2]] static auto mask_bits(reg mask) -> unsigned {
+        return static_cast<unsigned>(_mm256_movemask_pd(mask));
+    }
+    [[MATOY_AVX2]] static auto sum(reg x) -> double {
+        const __m128d h{_mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1))};
+        return _mm_cvtsd_f64(_mm_add_sd(h, _mm_unpackhi_pd(h, h)));
+    }
+};
+
+template <>
+struct Vec<float> {
+    using reg = __m256;
+    static constexpr size_t lanes = 8;
+
+    [[MATOY_AVX2]] static auto zero() -> reg {
+        return _mm256_setzero_ps();
+    }
+    [[MATOY_AVX2]] static auto set1(float x) -> reg {
+        return _mm256_set1_ps(x);
+    }
+    [[MATOY_AVX2]] static auto broadcast(const float* p) -> reg {
+        return _mm256_broadcast_ss(p);
+    }
+    [[MATOY_AVX2]] static auto load(const float* p) -> reg {
+        return _mm256_loadu_ps(p);
+    }
+    [[MATOY_AVX2]] static void store(float* p, reg x) {
+        _mm256_storeu_ps(p, x);
+    }
+    [[MATOY_AVX2]] static auto add(reg x, reg y) -> reg {
+        return _mm256_add_ps(x, y);
+    }
+    [[MATOY_AVX2]] static auto sub(reg x, reg y) -> reg {
+        return _mm256_sub_ps(x, y);
+    }
+    [[MATOY_AVX2]] static auto mul(reg x, reg y) -> reg {
+        return _mm256_mul_ps(x, y);
+    }
+    [[MATOY_AVX2]] static auto div(reg x, reg y) -> reg {
+        return _mm256_div_ps(x, y);
+    }
+    [[MATOY_AVX2]] static auto bit_xor(reg x, reg y) -> reg {
+        return _mm256_xor_ps(x, y);
+    }
+    [[MATOY_AVX2]] static auto fmadd(reg x, reg y, reg z) -> reg {
+        return _mm256_fmadd_ps(x, y, z);
+    }
+    [[MATOY_AVX2]] static auto abs(reg x) -> reg {
+        return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x);
+    }
+    [[MATOY_AVX2]] static auto min(reg x, reg y) -> reg {
+        return _mm256_min_ps(x, y);
+    }
+    [[MATOY_AVX2]] static auto max(reg x, reg y) -> reg {
+        return _mm256_max_ps(x, y);
+    }
+    [[MATOY_AVX2]] static auto less_equal(reg x, reg y) -> reg {
+        return _mm256_cmp_ps(x, y, _CMP_LE_OQ);
+    }
+    [[MATOY_AVX2]] static auto less(reg x, reg y) -> reg {
+        return _mm256_cmp_ps(x, y, _CMP_LT_OQ);
+    }
+    [[MATOY_AVX2]] static auto is_nan(reg x) -> reg {
+        return _mm256_cmp_ps(x, x, _CMP_UNORD_Q);
+    }
+    [[MATOY_AVX2]] static auto select(reg mask, reg x, reg y) -> reg {
+        return _mm256_blendv_ps(y, x, mask);
+    }
+    [[MATOY_AVX2]] static auto mask_bits(reg mask) -> unsigned {
+        return static_cast<unsigned>(_mm256_movemask_ps(mask));
+    }
+    [[MATOY_AVX2]] static auto sum(reg x) -> float {
+        __m128 h{_mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1))};
+        h = _mm_add_ps(h, _mm_movehl_ps(h, h));
+        return _mm_cvtss_f32(_mm_add_ss(h, _mm_movehdup_ps(h)));
+    }
+};
+
+#undef MATOY_AVX2
+
+} // namespace matoy::foundations::avx2
+
+#endif
@@ -0,0 +1,474 @@
+#include "band.hpp"
+#include "matrix_op.hpp"
+#include "simd.hpp"
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace matoy::foundations {
+
+static constexpr auto EPS = std::numeric_limits<BandMatrix::value_type>::epsilon();
+
+BandMatrix::BandMatrix(size_t n, size_t lower, size_t upper)
+    : n_{n}, kl_{std::min(lower, n > 0 ? n - 1 : 0)}, ku_{std::min(upper, n > 0 ? n - 1 : 0)},
+      band_(n_ * width(), 0.0) {}
+
+BandMatrix::BandMatrix(const Matrix& dense) : n_{dense.rows()}, kl_{0}, ku_{0} {
+    assert(dense.is_square());
+    for (size_t i{0}; i < n_; i++) {
+        for (size_t j{0}; j < n_; j++) {
+            if (dense[i, j] != 0.0) {
+                kl_ = i > j ? std::max(kl_, i - j) : kl_;
+                ku_ = j > i ? std::max(ku_, j - i) : ku_;
+            }
+        }
+    }
+    *this = from_dense(dense, kl_, ku_);
+}
+
+auto BandMatrix::identity(size_t n) -> Self {
+    Self res(n, 0, 0);
+    std::ranges::fill(res.band_, 1.0);
+    return res;
+}
+
+auto BandMatrix::diagonal(std::span<const value_type> diag) -> Self {
+    Self res(diag.size(), 0, 0);
+    std::ranges::copy(diag, res.band_.begin());
+    return res;
+}
+
+auto BandMatrix::from_dense(const Matrix& dense, size_t lower, size_t upper) -> Self {
+    assert(dense.is_square());
+    Self res(dense.rows(), lower, upper);
+    for (size_t i{0}; i < res.n_; i++) {
+        for (size_t j{res.row_begin(i)}; j < res.row_end(i); j++) {
+            res.band_[res.index(i, j)] = dense[i, j];
+        }
+    }
+    return res;
+}
+
+auto BandMatrix::to_dense() const -> Matrix {
+    auto res{Matrix::zeros(n_, n_)};
+    double* x{res.data()};
+    const size_t ld{res.leading_dim()};
+    for (size_t i{0}; i < n_; i++) {
+        const size_t j0{row_begin(i)};
+        std::copy_n(band_.data() + index(i, j0), row_end(i) - j0, x + i * ld + j0);
+    }
+    return res;
+}
+
+auto BandMatrix::transposed() const -> Self {
+    Self res(n_, ku_, kl_);
+    for (size_t i{0}; i < n_; i++) {
+        for (size_t j{row_begin(i)}; j < row_end(i); j++) {
+            res.band_[res.index(j, i)] = band_[index(i, j)];
+        }
+    }
+    return res;
+}
+
+auto BandMatrix::widened(size_t lower, size_t upper) const -> Self {
+    Self res(n_, std::max(kl_, lower), std::max(ku_, upper));
+    for (size_t i{0}; i < n_; i++) {
+        const size_t j0{row_begin(i)};
+        std::copy_n(band_.data() + index(i, j0), row_end(i) - j0, res.band_.data() + res.index(i, j0));
+    }
+    return res;
+}
+
+// LU factorization of a band with partial pivoting, as in LAPACK's gbtrf.
+// Row interchanges let U grow to lower + upper diagonals above the main one, so each row keeps
+// 2 * lower + upper + 1 elements. The multipliers of L stay in the rows where they were computed, and
+// `piv_[k]` is the row that was swapped with row k at step k, so solving replays the steps in order.
+class BandLU {
+  public:
+    explicit BandLU(const BandMatrix& a)
+        : n_{a.rows()}, kl_{a.lower()}, ku_{a.lower() + a.upper()}, w_{kl_ + ku_ + 1}, lu_(n_ * w_, 0.0),
+          piv_(n_) {
+        for (size_t i{0}; i < n_; i++) {
+            for (size_t j{i > kl_ ? i - kl_ : 0}; j < std::min(n_, i + a.upper() + 1); j++) {
+                at(i, j) = a[i, j];
+            }
+        }
+        for (size_t k{0}; k < n_; k++) {
+            const size_t last{std::min(n_ - 1, k + kl_)}, len{std::min(n_, k + ku_ + 1) - k};
+            size_t p{k};
+            for (size_t r{k + 1}; r <= last; r++) {
+                if (std::abs(at(r, k)) > std::abs(at(p, k))) {
+                    p = r;
+                }
+            }
+            if (std::abs(at(p, k)) < EPS) {
+                singular_ = true;
+                return;
+            }
+            piv_[k] = p;
+            if (p != k) {
+                simd::swap(&at(k, k), &at(p, k), len);
+                sign_ = -sign_;
+            }
+            for (size_t r{k + 1}; r <= last; r++) {
+                const double l{at(r, k) / at(k, k)};
+                at(r, k) = l;
+                if (l != 0.0) {
+                    simd::axpy(&at(r, k + 1), -l, &at(k, k + 1), len - 1);
+                }
+            }
+        }
+    }
+
+    auto det() const -> double {
+        if (singular_) {
+            return 0.0;
+        }
+        double res{sign_};
+        for (size_t i{0}; i < n_; i++) {
+            res *= at(i, i);
+        }
+        return res;
+    }
+
+    auto solve(const Matrix& b) const -> std::optional<Matrix> {
+        if (singular_) {
+            return std::nullopt;
+        }
+        Matrix x{b};
+        for (size_t k{0}; k < n_; k++) {
+            x.swap_row(k, piv_[k]);
+            for (size_t r{k + 1}; r <= std::min(n_ - 1, k + kl_); r++) {
+                if (at(r, k) != 0.0) {
+                    x.add_row_multiple(r, k, -at(r, k));
+                }
+            }
+        }
+        for (size_t i{n_ - 1}; ~i; i--) {
+            for (size_t j{i + 1}; j < std::min(n_, i + ku_ + 1); j++) {
+                if (at(i, j) != 0.0) {
+                    x.add_row_multiple(i, j, -at(i, j));
+                }
+            }
+            x.multiply_row(i, 1.0 / at(i, i));
+        }
+        return x;
+    }
+
+  private:
+    auto at(size_t i, size_t j) -> double& {
+        return lu_[i * w_ + (j + kl_ - i)];
+    }
+
+    auto at(size_t i, size_t j) const -> double {
+        return lu_[i * w_ + (j + kl_ - i)];
+    }
+
+  private:
+    size_t n_;
+    size_t kl_;
+    size_t ku_;
+    size_t w_;
+    std::vector<double> lu_;
+    std::vector<size_t> piv_;
+    double sign_{1.0};
+    bool singular_{false};
+};
+
+auto BandMatrix::det() const -> value_type {
+    if (kl_ == 0 || ku_ == 0) {
+        value_type res{1.0};
+        for (size_t i{0}; i < n_; i++) {
+            res *= band_[index(i, i)];
+        }
+        return res;
+    }
+    if (is_tridiagonal()) {
+        // f(k + 1) = a(k, k) f(k) - a(k, k - 1) a(k - 1, k) f(k - 1), with f(0) = 1
+        value_type prev{1.0}, cur{band_[index(0, 0)]};
+        for (size_t k{1}; k < n_; k++) {
+            const value_type next{band_[index(k, k)] * cur - band_[index(k, k - 1)] * band_[index(k - 1, k)] * prev};
+            prev = std::exchange(cur, next);
+        }
+        return cur;
+    }
+    return BandLU{*this}.det();
+}
+
+auto BandMatrix::solve(const Matrix& b) const -> std::optional<Matrix> {
+    assert(b.rows() == n_);
+    if (kl_ == 0 || ku_ == 0) {
+        for (size_t i{0}; i < n_; i++) {
+            if (std::abs(band_[index(i, i)]) < EPS) {
+                return std::nullopt;
+            }
+        }
+        // forward substitution for lower triangular matrices, back substitution for upper ones
+        Matrix x{b};
+        for (size_t t{0}; t < n_; t++) {
+            const size_t i{ku_ == 0 ? t : n_ - 1 - t};
+            for (size_t k{row_begin(i)}; k < row_end(i); k++) {
+                if (const value_type a{band_[index(i, k)]}; k != i && a != 0.0) {
+                    x.add_row_multiple(i, k, -a);
+                }
+            }
+            x.multiply_row(i, 1.0 / band_[index(i, i)]);
+        }
+        return x;
+    }
+
+    // The Thomas algorithm doesn't pivot, which is only safe for diagonally dominant matrices.
+    bool dominant{is_tridiagonal()};
+    for (size_t i{0}; dominant && i < n_; i++) {
+        const value_type sub{i > 0 ? band_[index(i, i - 1)] : 0.0};
+        const value_type super{i + 1 < n_ ? band_[index(i, i + 1)] : 0.0};
+        dominant = std::abs(band_[index(i, i)]) >= std::abs(sub) + std::abs(super);
+    }
+    if (!dominant) {
+        return BandLU{*this}.solve(b);
+    }
+
+    // eliminate the subdiagonal downwards, keeping the scaled superdiagonal in c, then substitute upwards
+    Matrix x{b};
+    std::vector<value_type> c(n_, 0.0);
+    for (size_t i{0}; i < n_; i++) {
+        const value_type sub{i > 0 ? band_[index(i, i - 1)] : 0.0};
+        const value_type m{band_[index(i, i)] - (i > 0 ? sub * c[i - 1] : 0.0)};
+        if (std::abs(m) < EPS) {
+            return BandLU{*this}.solve(b);
+        }
+        c[i] = i + 1 < n_ ? band_[index(i, i + 1)] / m : 0.0;
+        if (sub != 0.0) {
+            x.add_row_multiple(i, i - 1, -sub);
+        }
+        x.multiply_row(i, 1.0 / m);
+    }
+    for (size_t i{n_ - 1}; i-- > 0;) {
+        if (c[i] != 0.0) {
+            x.add_row_multiple(i, i + 1, -c[i]);
+        }
+    }
+    return x;
+}
+
+auto BandMatrix::inverse() const -> std::optional<Self> {
+    if (is_diagonal()) {
+        Self res{*this};
+        for (value_type& x : res.band_) {
+            if (std::abs(x) < EPS) {
+                return std::nullopt;
+            }
+            x = 1.0 / x;
+        }
+        return res;
+    }
+    // the band constructor clamps the widths to n - 1
+    const size_t lower{ku_ == 0 || kl_ != 0 ? n_ : 0}, upper{kl_ == 0 || ku_ != 0 ? n_ : 0};
+    return solve(Matrix::identity(n_)).transform([&](const Matrix& x) { return from_dense(x, lower, upper); });
+}
+
+auto BandMatrix::power(int64_t k) const -> std::optional<Self> {
+    if (is_diagonal()) {
+        Self res{*this};
+        for (value_type& x : res.band_) {
+            if (k < 0 && x == 0.0) {
+                return std::nullopt;
+            }
+            x = std::pow(x, static_cast<value_type>(k));
+        }
+        return res;
+    }
+    return foundations::power(to_dense(), k).transform([](const Matrix& dense) { return Self{dense}; });
+}
+
+BandMatrix BandMatrix::operator+() const {
+    return *this;
+}
+
+BandMatrix BandMatrix::operator-() const {
+    Self res{*this};
+    res *= -1.0;
+    return res;
+}
+
+BandMatrix& BandMatrix::operator+=(const Self& other) {
+    assert(n_ == other.n_);
+    if (other.kl_ > kl_ || other.ku_ > ku_) {
+        *this = widened(other.kl_, other.ku_);
+    }
+    for (size_t i{0}; i < n_; i++) {
+        const size_t j0{other.row_begin(i)};
+        simd::add(band_.data() + index(i, j0), other.band_.data() + other.index(i, j0), other.row_end(i) - j0);
+    }
+    return *this;
+}
+
+BandMatrix& BandMatrix::operator-=(const Self& other) {
+    assert(n_ == other.n_);
+    if (other.kl_ > kl_ || other.ku_ > ku_) {
+        *this = widened(other.kl_, other.ku_);
+    }
+    for (size_t i{0}; i < n_; i++) {
+        const size_t j0{other.row_begin(i)};
+        simd::sub(band_.data() + index(i, j0), other.band_.data() + other.index(i, j0), other.row_end(i) - j0);
+    }
+    return *this;
+}
+
+// Scalar kernels only touch the slots inside the matrix, so that the padding stays zero even for 0 * inf or 0 / 0.
+
+BandMatrix& BandMatrix::operator*=(value_type value) {
+    for (size_t i{0}; i < n_; i++) {
+        simd::mul_scalar(band_.data() + index(i, row_begin(i)), value, row_end(i) - row_begin(i));
+    }
+    return *this;
+}
+
+BandMatrix& BandMatrix::operator/=(value_type value) {
+    for (size_t i{0}; i < n_; i++) {
+        simd::div_scalar(band_.data() + index(i, row_begin(i)), value, row_end(i) - row_begin(i));
+    }
+    return *this;
+}
+
+BandMatrix operator+(const BandMatrix& lhs, const BandMatrix& rhs) {
+    BandMatrix res{lhs};
+    res += rhs;
+    return res;
+}
+
+BandMatrix operator-(const BandMatrix& lhs, const BandMatrix& rhs) {
+    BandMatrix res{lhs};
+    res -= rhs;
+    return res;
+}
+
+// dense[i, j] += sign * band[i, j] for every element in the band.
+static void add_band(Matrix& dense, const BandMatrix& band, double sign) {
+    assert(dense.shape() == band.shape());
+    double* x{dense.data()};
+    const size_t rs{dense.row_stride()}, cs{dense.col_stride()};
+    for (size_t i{0}; i < band.rows(); i++) {
+        for (size_t j{i > band.lower() ? i - band.lower() : 0}; j < std::min(band.cols(), i + band.upper() + 1); j++) {
+            x[i * rs + j * cs] += sign * band[i, j];
+        }
+    }
+}
+
+Matrix operator+(const BandMatrix& lhs, Matrix rhs) {
+    add_band(rhs, lhs, 1.0);
+    return rhs;
+}
+
+Matrix operator+(Matrix lhs, const BandMatrix& rhs) {
+    add_band(lhs, rhs, 1.0);
+    return lhs;
+}
+
+Matrix operator-(const BandMatrix& lhs, Matrix rhs) {
+    rhs.negate();
+    add_band(rhs, lhs, 1.0);
+    return rhs;
+}
+
+Matrix operator-(Matrix lhs, const BandMatrix& rhs) {
+    add_band(lhs, rhs, -1.0);
+    return lhs;
+}
+
+BandMatrix operator*(BandMatrix lhs, double rhs) {
+    lhs *= rhs;
+    return lhs;
+}
+
+BandMatrix operator*(double lhs, BandMatrix rhs) {
+    rhs *= lhs;
+    return rhs;
+}
+
+BandMatrix operator/(BandMatrix lhs, double rhs) {
+    lhs /= rhs;
+    return lhs;
+}
+
+BandMatrix operator*(const BandMatrix& lhs, const BandMatrix& rhs) {
+    assert(lhs.n_ == rhs.n_);
+    BandMatrix res(lhs.n_, lhs.kl_ + rhs.kl_, lhs.ku_ + rhs.ku_);
+    // row i of the result combines the rows k of rhs with lhs[i, k] != 0, each a contiguous run in the band
+    for (size_t i{0}; i < lhs.n_; i++) {
+        for (size_t k{lhs.row_begin(i)}; k < lhs.row_end(i); k++) {
+            const double a{lhs.band_[lhs.index(i, k)]};
+            if (a == 0.0) {
+                continue;
+            }
+            const size_t j0{rhs.row_begin(k)};
+            simd::axpy(res.band_.data() + res.index(i, j0), a, rhs.band_.data() + rhs.index(k, j0),
+                       rhs.row_end(k) - j0);
+        }
+    }
+    return res;
+}
+
+Matrix operator*(const BandMatrix& lhs, const Matrix& rhs) {
+    assert(lhs.n_ == rhs.rows());
+    const size_t m{rhs.cols()};
+    auto res{Matrix::zeros(lhs.n_, m)};
+    const double* b{rhs.data()};
+    const size_t brs{rhs.row_stride()}, bcs{rhs.col_stride()};
+    double* c{res.data()};
+    const size_t ldc{res.leading_dim()};
+    for (size_t i{0}; i < lhs.n_; i++) {
+        for (size_t k{lhs.row_begin(i)}; k < lhs.row_end(i); k++) {
+            const double a{lhs.band_[lhs.index(i, k)]};
+            if (a == 0.0) {
+                continue;
+            }
+            if (bcs == 1) {
+                simd::axpy(c + i * ldc, a, b + k * brs, m);
+            } else {
+                for (size_t j{0}; j < m; j++) {
+                    c[i * ldc + j] += a * b[k * brs + j * bcs];
+                }
+            }
+        }
+    }
+    return res;
+}
+
+Matrix operator*(const Matrix& lhs, const BandMatrix& rhs) {
+    assert(lhs.cols() == rhs.n_);
+    auto res{Matrix::zeros(lhs.rows(), rhs.n_)};
+    const double* a{lhs.data()};
+    const size_t ars{lhs.row_stride()}, acs{lhs.col_stride()};
+    double* c{res.data()};
+    const size_t ldc{res.leading_dim()};
+    // row i of the result combines the rows k of rhs, scaled by lhs[i, k]
+    for (size_t i{0}; i < lhs.rows(); i++) {
+        for (size_t k{0}; k < rhs.n_; k++) {
+            const double x{a[i * ars + k * acs]};
+            if (x == 0.0) {
+                continue;
+            }
+            const size_t j0{rhs.row_begin(k)};
+            simd::axpy(c + i * ldc + j0, x, rhs.band_.data() + rhs.index(k, j0), rhs.row_end(k) - j0);
+        }
+    }
+    return res;
+}
+
+bool operator==(const BandMatrix& lhs, const BandMatrix& rhs) {
+    if (lhs.rows() != rhs.rows()) {
+        return false;
+    }
+    const size_t kl{std::max(lhs.lower(), rhs.lower())}, ku{std::max(lhs.upper(), rhs.upper())};
+    for (size_t i{0}; i < lhs.rows(); i++) {
+        for (size_t j{i > kl ? i - kl : 0}; j < std::min(lhs.cols(), i + ku + 1); j++) {
+            if (lhs[i, j] != rhs[i, j]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace matoy::foundations
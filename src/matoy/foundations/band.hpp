@@ -0,0 +1,233 @@
+#pragma once
+
+#include "approx.hpp"
+#include "matrix.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace matoy::foundations {
+
+// A square matrix whose nonzeros lie within `lower()` diagonals below and `upper()` diagonals above the main one.
+// Identity and diagonal matrices have both bandwidths 0, lower triangular matrices have upper() == 0, upper
+// triangular ones lower() == 0, and tridiagonal ones both 1.
+//
+// Row i keeps the columns [i - lower(), i + upper()] in a row of `lower() + upper() + 1` elements, so storage and
+// the kernels below are O(n * bandwidth). The slots of the first and last rows that fall outside the matrix are
+// zero.
+class BandMatrix {
+  public:
+    using value_type = double;
+    using Self = BandMatrix;
+
+    // A zero matrix.
+    BandMatrix(size_t n, size_t lower, size_t upper);
+
+    // Store a dense matrix with the narrowest band that holds all of its nonzeros.
+    explicit BandMatrix(const Matrix& dense);
+
+    static Self identity(size_t n);
+
+    static Self diagonal(std::span<const value_type> diag);
+
+    // The band of a dense matrix. Elements outside of it are dropped.
+    static Self from_dense(const Matrix& dense, size_t lower, size_t upper);
+
+    auto to_dense() const -> Matrix;
+
+    auto rows() const -> size_t {
+        return n_;
+    }
+
+    auto cols() const -> size_t {
+        return n_;
+    }
+
+    auto shape() const -> std::pair<size_t, size_t> {
+        return {n_, n_};
+    }
+
+    auto lower() const -> size_t {
+        return kl_;
+    }
+
+    auto upper() const -> size_t {
+        return ku_;
+    }
+
+    auto is_diagonal() const -> bool {
+        return kl_ == 0 && ku_ == 0;
+    }
+
+    auto is_lower_triangular() const -> bool {
+        return ku_ == 0;
+    }
+
+    auto is_upper_triangular() const -> bool {
+        return kl_ == 0;
+    }
+
+    auto is_tridiagonal() const -> bool {
+        return kl_ <= 1 && ku_ <= 1;
+    }
+
+    // Whether the band covers the whole matrix, leaving no structure to exploit.
+    auto is_full() const -> bool {
+        return kl_ + 1 >= n_ && ku_ + 1 >= n_;
+    }
+
+    auto in_band(size_t i, size_t j) const -> bool {
+        return j + kl_ >= i && j <= i + ku_;
+    }
+
+    auto operator[](size_t i, size_t j) const -> value_type {
+        return in_band(i, j) ? band_[index(i, j)] : 0.0;
+    }
+
+    // Element (i, j), which must lie within the band.
+    value_type& operator[](size_t i, size_t j) {
+        assert(in_band(i, j));
+        return band_[index(i, j)];
+    }
+
+    Self transposed() const;
+
+    // The same matrix with a band of at least the given widths.
+    Self widened(size_t lower, size_t upper) const;
+
+    // Product of the diagonal for triangular matrices, a three-term recurrence for tridiagonal ones,
+    // and a banded LU factorization otherwise.
+    auto det() const -> value_type;
+
+    // Solve A * X = B. Diagonal matrices divide, triangular ones substitute, tridiagonal ones use the Thomas
+    // algorithm, and anything else a banded LU factorization with partial pivoting.
+    // Returns nothing if the matrix is singular.
+    auto solve(const Matrix& b) const -> std::optional<Matrix>;
+
+    // The inverse keeps the shape of diagonal and triangular matrices. Other bands fill in completely.
+    auto inverse() const -> std::optional<Self>;
+
+    // Diagonal matrices raise each element. Other bands widen with every product, so they go through the dense
+    // power and keep whatever band the result has. Returns nothing for negative powers of a singular matrix.
+    auto power(int64_t k) const -> std::optional<Self>;
+
+#pragma region operators
+
+    Self operator+() const;
+
+    Self operator-() const;
+
+    // Widens this band to the union of both bands if needed.
+    Self& operator+=(const Self& other);
+
+    Self& operator-=(const Self& other);
+
+    Self& operator*=(value_type value);
+
+    Self& operator/=(value_type value);
+
+#pragma endregion operators
+
+  private:
+    auto width() const -> size_t {
+        return kl_ + ku_ + 1;
+    }
+
+    auto index(size_t i, size_t j) const -> size_t {
+        return i * width() + (j + kl_ - i);
+    }
+
+    // Columns [row_begin(i), row_end(i)) of row i lie inside both the band and the matrix.
+    auto row_begin(size_t i) const -> size_t {
+        return i > kl_ ? i - kl_ : 0;
+    }
+
+    auto row_end(size_t i) const -> size_t {
+        return std::min(n_, i + ku_ + 1);
+    }
+
+  private:
+    size_t n_;
+    size_t kl_;
+    size_t ku_;
+    std::vector<value_type> band_; // n_ rows of width()
+
+    friend BandMatrix operator*(const BandMatrix& lhs, const BandMatrix& rhs);
+    friend Matrix operator*(const BandMatrix& lhs, const Matrix& rhs);
+    friend Matrix operator*(const Matrix& lhs, const BandMatrix& rhs);
+};
+
+// Sums of bands are banded. Mixing with a dense matrix gives a dense result, adding the band into it.
+BandMatrix operator+(const BandMatrix& lhs, const BandMatrix& rhs);
+
+BandMatrix operator-(const BandMatrix& lhs, const BandMatrix& rhs);
+
+Matrix operator+(const BandMatrix& lhs, Matrix rhs);
+
+Matrix operator+(Matrix lhs, const BandMatrix& rhs);
+
+Matrix operator-(const BandMatrix& lhs, Matrix rhs);
+
+Matrix operator-(Matrix lhs, const BandMatrix& rhs);
+
+BandMatrix operator*(BandMatrix lhs, double rhs);
+
+BandMatrix operator*(double lhs, BandMatrix rhs);
+
+BandMatrix operator/(BandMatrix lhs, double rhs);
+
+// The product of bands is a band of the summed widths, e.g. diagonal x diagonal stays diagonal.
+BandMatrix operator*(const BandMatrix& lhs, const BandMatrix& rhs);
+
+// Each row of the result combines the rows of rhs within the band, so diagonal scaling is a single pass.
+Matrix operator*(const BandMatrix& lhs, const Matrix& rhs);
+
+Matrix operator*(const Matrix& lhs, const BandMatrix& rhs);
+
+bool operator==(const BandMatrix& lhs, const BandMatrix& rhs);
+
+template <>
+inline auto approx(const BandMatrix& x, const BandMatrix& y, int ulp) -> bool {
+    if (x.rows() != y.rows()) {
+        return false;
+    }
+    const size_t kl{std::max(x.lower(), y.lower())}, ku{std::max(x.upper(), y.upper())};
+    for (size_t i{0}; i < x.rows(); i++) {
+        for (size_t j{i > kl ? i - kl : 0}; j < std::min(x.cols(), i + ku + 1); j++) {
+            if (!approx(x[i, j], y[i, j], ulp)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace matoy::foundations
+
+namespace matoy {
+using foundations::BandMatrix;
+}
+
+// Band matrices print like the dense matrix they represent.
+template <>
+struct std::formatter<matoy::BandMatrix> : std::formatter<char> {
+    auto format(const matoy::BandMatrix& mat, format_context& ctx) const {
+        std::format_to(ctx.out(), "[");
+        for (size_t i = 0; i < mat.rows(); i++) {
+            if (i != 0) {
+                std::format_to(ctx.out(), "; ");
+            }
+            for (size_t j = 0; j < mat.cols(); j++) {
+                if (j != 0) {
+                    std::format_to(ctx.out(), ", ");
+                }
+                std::format_to(ctx.out(), "{}", mat[i, j]);
+            }
+        }
+        return std::format_to(ctx.out(), "]");
+    }
+};
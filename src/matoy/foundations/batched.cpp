@@ -0,0 +1,590 @@
+#include "batched.hpp"
+#include "avx2.hpp"
+#include "cpu.hpp"
+#include "fixed_matrix.hpp"
+#include "matrix_op.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <limits>
+#include <utility>
+
+namespace matoy::foundations {
+
+static constexpr auto EPS = std::numeric_limits<BatchedMatrix::value_type>::epsilon();
+
+// Lanes are processed in tiles that keep the operands of one output element in the L1 cache.
+static constexpr size_t LANE_TILE = 256;
+
+// Tiny matrices are cheap, so the lanes are only split across threads when there is enough work to pay for it.
+static constexpr size_t PARALLEL_MIN_FLOPS = 1 << 16;
+
+// Call f(k0, k1) on ranges of whole lane blocks covering [0, stride), in parallel if `flops` is large enough.
+template <class F>
+static void for_lane_ranges(size_t stride, size_t flops, F f) {
+    const size_t threads{num_threads()}, blocks{stride / BatchedMatrix::lane_block};
+    if (threads == 1 || blocks < 2 || flops < PARALLEL_MIN_FLOPS) {
+        f(0, stride);
+        return;
+    }
+    const size_t ranges{std::min(blocks, threads)}, step{(blocks + ranges - 1) / ranges * BatchedMatrix::lane_block};
+    parallel_for((stride + step - 1) / step, [&](size_t t) { f(t * step, std::min(stride, (t + 1) * step)); });
+}
+
+namespace {
+
+struct Kernels {
+    void (*multiply)(const BatchedMatrix&, const BatchedMatrix&, BatchedMatrix&, size_t, size_t);
+    // indexed by the order of the matrices minus one
+    void (*det[4])(const BatchedMatrix&, double*, size_t, size_t);
+    // false if one of the first count() matrices is singular
+    bool (*inverse[4])(const BatchedMatrix&, BatchedMatrix&, size_t, size_t);
+};
+
+void multiply_generic(const BatchedMatrix& a, const BatchedMatrix& b, BatchedMatrix& c, size_t k0, size_t k1) {
+    for (size_t t0{k0}; t0 < k1; t0 += LANE_TILE) {
+        const size_t t1{std::min(k1, t0 + LANE_TILE)};
+        for (size_t i{0}; i < a.rows(); i++) {
+            for (size_t j{0}; j < b.cols(); j++) {
+                double* x{c.lanes(i, j)};
+                std::fill(x + t0, x + t1, 0.0);
+                for (size_t l{0}; l < a.cols(); l++) {
+                    const double *y{a.lanes(i, l)}, *z{b.lanes(l, j)};
+                    for (size_t k{t0}; k < t1; k++) {
+                        x[k] += y[k] * z[k];
+                    }
+                }
+            }
+        }
+    }
+}
+
+// One matrix at a time through the closed forms of FixedMatrix.
+template <size_t N>
+auto gather(const BatchedMatrix& a, size_t k) -> FixedMatrix<N> {
+    FixedMatrix<N> m;
+    for (size_t i{0}; i < N; i++) {
+        for (size_t j{0}; j < N; j++) {
+            m[i, j] = a[k, i, j];
+        }
+    }
+    return m;
+}
+
+template <size_t N>
+void det_generic(const BatchedMatrix& a, double* out, size_t k0, size_t k1) {
+    for (size_t k{k0}; k < k1; k++) {
+        out[k] = gather<N>(a, k).det();
+    }
+}
+
+template <size_t N>
+bool inverse_generic(const BatchedMatrix& a, BatchedMatrix& res, size_t k0, size_t k1) {
+    bool invertible{true};
+    for (size_t k{k0}; k < k1; k++) {
+        const auto inv{gather<N>(a, k).inverse()};
+        if (!inv) {
+            invertible = invertible && k >= a.count();
+            continue;
+        }
+        for (size_t i{0}; i < N; i++) {
+            for (size_t j{0}; j < N; j++) {
+                res[k, i, j] = (*inv)[i, j];
+            }
+        }
+    }
+    return invertible;
+}
+
+#ifdef MATOY_X86_DISPATCH
+
+using V = avx2::Vec<double>;
+constexpr size_t W{V::lanes};
+
+// Two registers of lanes per iteration, in independent chains. The stride is a multiple of lane_block, so there
+// is no tail.
+[[gnu::target("avx2,fma")]] void multiply_avx2(const BatchedMatrix& a, const BatchedMatrix& b, BatchedMatrix& c,
+                                                size_t k0, size_t k1) {
+    static_assert(BatchedMatrix::lane_block % (2 * W) == 0);
+    for (size_t t0{k0}; t0 < k1; t0 += LANE_TILE) {
+        const size_t t1{std::min(k1, t0 + LANE_TILE)};
+        for (size_t i{0}; i < a.rows(); i++) {
+            for (size_t j{0}; j < b.cols(); j++) {
+                double* x{c.lanes(i, j)};
+                for (size_t k{t0}; k < t1; k += 2 * W) {
+                    auto s0{V::zero()}, s1{V::zero()};
+                    for (size_t l{0}; l < a.cols(); l++) {
+                        const double *y{a.lanes(i, l) + k}, *z{b.lanes(l, j) + k};
+                        s0 = V::fmadd(V::load(y), V::load(z), s0);
+                        s1 = V::fmadd(V::load(y + W), V::load(z + W), s1);
+                    }
+                    V::store(x + k, s0);
+                    V::store(x + k + W, s1);
+                }
+            }
+        }
+    }
+}
+
+// A register of lanes with operators, so that the closed forms below read like the ones of FixedMatrix.
+struct Lanes {
+    V::reg v;
+};
+
+[[gnu::target("avx2,fma"), gnu::always_inline]] inline Lanes operator+(Lanes x, Lanes y) {
+    return {V::add(x.v, y.v)};
+}
+
+[[gnu::target("avx2,fma"), gnu::always_inline]] inline Lanes operator-(Lanes x, Lanes y) {
+    return {V::sub(x.v, y.v)};
+}
+
+[[gnu::target("avx2,fma"), gnu::always_inline]] inline Lanes operator-(Lanes x) {
+    return {V::bit_xor(x.v, V::set1(-0.0))};
+}
+
+[[gnu::target("avx2,fma"), gnu::always_inline]] inline Lanes operator*(Lanes x, Lanes y) {
+    return {V::mul(x.v, y.v)};
+}
+
+// N x N matrices of lanes, loaded from k onwards.
+template <size_t N>
+struct LaneMatrix {
+    Lanes data[N * N];
+
+    [[gnu::target("avx2,fma"), gnu::always_inline]] auto operator[](size_t i, size_t j) -> Lanes& {
+        return data[i * N + j];
+    }
+
+    [[gnu::target("avx2,fma"), gnu::always_inline]] auto operator[](size_t i, size_t j) const -> const Lanes& {
+        return data[i * N + j];
+    }
+};
+
+template <size_t N>
+[[gnu::target("avx2,fma"), gnu::always_inline]] inline auto load(const BatchedMatrix& a, size_t k) -> LaneMatrix<N> {
+    LaneMatrix<N> m;
+    for (size_t i{0}; i < N; i++) {
+        for (size_t j{0}; j < N; j++) {
+            m[i, j] = {V::load(a.lanes(i, j) + k)};
+        }
+    }
+    return m;
+}
+
+// The lanes that are singular by the pivot test of the LU factorization, as in FixedMatrix::singular. The rows are
+// swapped lane by lane so that each pivot is the largest remaining element of its column, which gives the same
+// pivots even though the other rows end up in a different order.
+template <size_t N>
+[[gnu::target("avx2,fma"), gnu::always_inline]] inline auto singular(LaneMatrix<N> a) -> unsigned {
+    unsigned res{0};
+    for (size_t c{0}; c < N; c++) {
+        for (size_t r{c + 1}; r < N; r++) {
+            const auto larger{V::less(V::abs(a[c, c].v), V::abs(a[r, c].v))};
+            for (size_t j{c}; j < N; j++) {
+                const auto x{a[c, j].v}, y{a[r, j].v};
+                a[c, j] = {V::select(larger, y, x)};
+                a[r, j] = {V::select(larger, x, y)};
+            }
+        }
+        res |= V::mask_bits(V::less(V::abs(a[c, c].v), V::set1(EPS)));
+        for (size_t r{c + 1}; r < N; r++) {
+            const Lanes f{V::div(a[r, c].v, a[c, c].v)};
+            for (size_t j{c + 1}; j < N; j++) {
+                a[r, j] = a[r, j] - f * a[c, j];
+            }
+        }
+    }
+    return res;
+}
+
+// The adjugate and the determinant, exactly as in FixedMatrix::adjugate.
+template <size_t N>
+[[gnu::target("avx2,fma"), gnu::always_inline]] inline auto adjugate(const LaneMatrix<N>& a, LaneMatrix<N>& b)
+    -> Lanes {
+    if constexpr (N == 1) {
+        b[0, 0] = {V::set1(1.0)};
+        return a[0, 0];
+    } else if constexpr (N == 2) {
+        b[0, 0] = a[1, 1];
+        b[0, 1] = -a[0, 1];
+        b[1, 0] = -a[1, 0];
+        b[1, 1] = a[0, 0];
+        return a[0, 0] * a[1, 1] - a[0, 1] * a[1, 0];
+    } else if constexpr (N == 3) {
+        b[0, 0] = a[1, 1] * a[2, 2] - a[1, 2] * a[2, 1];
+        b[0, 1] = a[0, 2] * a[2, 1] - a[0, 1] * a[2, 2];
+        b[0, 2] = a[0, 1] * a[1, 2] - a[0, 2] * a[1, 1];
+        b[1, 0] = a[1, 2] * a[2, 0] - a[1, 0] * a[2, 2];
+        b[1, 1] = a[0, 0] * a[2, 2] - a[0, 2] * a[2, 0];
+        b[1, 2] = a[0, 2] * a[1, 0] - a[0, 0] * a[1, 2];
+        b[2, 0] = a[1, 0] * a[2, 1] - a[1, 1] * a[2, 0];
+        b[2, 1] = a[0, 1] * a[2, 0] - a[0, 0] * a[2, 1];
+        b[2, 2] = a[0, 0] * a[1, 1] - a[0, 1] * a[1, 0];
+        return a[0, 0] * b[0, 0] + a[0, 1] * b[1, 0] + a[0, 2] * b[2, 0];
+    } else {
+        const Lanes s0{a[0, 0] * a[1, 1] - a[1, 0] * a[0, 1]};
+        const Lanes s1{a[0, 0] * a[1, 2] - a[1, 0] * a[0, 2]};
+        const Lanes s2{a[0, 0] * a[1, 3] - a[1, 0] * a[0, 3]};
+        const Lanes s3{a[0, 1] * a[1, 2] - a[1, 1] * a[0, 2]};
+        const Lanes s4{a[0, 1] * a[1, 3] - a[1, 1] * a[0, 3]};
+        const Lanes s5{a[0, 2] * a[1, 3] - a[1, 2] * a[0, 3]};
+        const Lanes c0{a[2, 0] * a[3, 1] - a[3, 0] * a[2, 1]};
+        const Lanes c1{a[2, 0] * a[3, 2] - a[3, 0] * a[2, 2]};
+        const Lanes c2{a[2, 0] * a[3, 3] - a[3, 0] * a[2, 3]};
+        const Lanes c3{a[2, 1] * a[3, 2] - a[3, 1] * a[2, 2]};
+        const Lanes c4{a[2, 1] * a[3, 3] - a[3, 1] * a[2, 3]};
+        const Lanes c5{a[2, 2] * a[3, 3] - a[3, 2] * a[2, 3]};
+
+        b[0, 0] = a[1, 1] * c5 - a[1, 2] * c4 + a[1, 3] * c3;
+        b[0, 1] = -a[0, 1] * c5 + a[0, 2] * c4 - a[0, 3] * c3;
+        b[0, 2] = a[3, 1] * s5 - a[3, 2] * s4 + a[3, 3] * s3;
+        b[0, 3] = -a[2, 1] * s5 + a[2, 2] * s4 - a[2, 3] * s3;
+        b[1, 0] = -a[1, 0] * c5 + a[1, 2] * c2 - a[1, 3] * c1;
+        b[1, 1] = a[0, 0] * c5 - a[0, 2] * c2 + a[0, 3] * c1;
+        b[1, 2] = -a[3, 0] * s5 + a[3, 2] * s2 - a[3, 3] * s1;
+        b[1, 3] = a[2, 0] * s5 - a[2, 2] * s2 + a[2, 3] * s1;
+        b[2, 0] = a[1, 0] * c4 - a[1, 1] * c2 + a[1, 3] * c0;
+        b[2, 1] = -a[0, 0] * c4 + a[0, 1] * c2 - a[0, 3] * c0;
+        b[2, 2] = a[3, 0] * s4 - a[3, 1] * s2 + a[3, 3] * s0;
+        b[2, 3] = -a[2, 0] * s4 + a[2, 1] * s2 - a[2, 3] * s0;
+        b[3, 0] = -a[1, 0] * c3 + a[1, 1] * c1 - a[1, 2] * c0;
+        b[3, 1] = a[0, 0] * c3 - a[0, 1] * c1 + a[0, 2] * c0;
+        b[3, 2] = -a[3, 0] * s3 + a[3, 1] * s1 - a[3, 2] * s0;
+        b[3, 3] = a[2, 0] * s3 - a[2, 1] * s1 + a[2, 2] * s0;
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+}
+
+template <size_t N>
+[[gnu::target("avx2,fma")]] void det_avx2(const BatchedMatrix& a, double* out, size_t k0, size_t k1) {
+    for (size_t k{k0}; k < k1; k += W) {
+        const auto m{load<N>(a, k)};
+        LaneMatrix<N> adj;
+        const Lanes d{adjugate(m, adj)};
+        V::store(out + k, d.v);
+    }
+}
+
+template <size_t N>
+[[gnu::target("avx2,fma")]] bool inverse_avx2(const BatchedMatrix& a, BatchedMatrix& res, size_t k0, size_t k1) {
+    bool invertible{true};
+    for (size_t k{k0}; k < k1; k += W) {
+        const auto m{load<N>(a, k)};
+        LaneMatrix<N> adj;
+        const Lanes d{adjugate(m, adj)};
+        // singular padding lanes do not count
+        const unsigned lanes_singular{singular(m) | V::mask_bits(V::less_equal(V::abs(d.v), V::zero()))};
+        const unsigned valid{k >= a.count() ? 0u : a.count() - k >= W ? (1u << W) - 1 : (1u << (a.count() - k)) - 1};
+        invertible = invertible && (lanes_singular & valid) == 0;
+        const Lanes scale{V::div(V::set1(1.0), d.v)};
+        for (size_t i{0}; i < N; i++) {
+            for (size_t j{0}; j < N; j++) {
+                V::store(res.lanes(i, j) + k, (adj[i, j] * scale).v);
+            }
+        }
+    }
+    return invertible;
+}
+
+#endif
+
+auto select_kernels() -> Kernels {
+#ifdef MATOY_X86_DISPATCH
+    if (cpu::has_avx2_fma()) {
+        return {multiply_avx2,
+                {det_avx2<1>, det_avx2<2>, det_avx2<3>, det_avx2<4>},
+                {inverse_avx2<1>, inverse_avx2<2>, inverse_avx2<3>, inverse_avx2<4>}};
+    }
+#endif
+    return {multiply_generic,
+            {det_generic<1>, det_generic<2>, det_generic<3>, det_generic<4>},
+            {inverse_generic<1>, inverse_generic<2>, inverse_generic<3>, inverse_generic<4>}};
+}
+
+auto kernels() -> const Kernels& {
+    static const Kernels value{select_kernels()};
+    return value;
+}
+
+} // namespace
+
+BatchedMatrix::BatchedMatrix(size_t count, size_t rows, size_t cols)
+    : count_{count}, rows_{rows}, cols_{cols}, stride_{(count + lane_block - 1) / lane_block * lane_block},
+      values_(rows * cols * stride_, 0.0) {}
+
+auto BatchedMatrix::repeat(const Matrix& mat, size_t count) -> Self {
+    Self res(count, mat.rows(), mat.cols());
+    for (size_t i{0}; i < res.rows_; i++) {
+        for (size_t j{0}; j < res.cols_; j++) {
+            std::fill_n(res.lanes(i, j), count, mat[i, j]);
+        }
+    }
+    return res;
+}
+
+auto BatchedMatrix::from_stacked(const Matrix& stacked, size_t rows) -> Self {
+    assert(rows > 0 && stacked.rows() % rows == 0);
+    Self res(stacked.rows() / rows, rows, stacked.cols());
+    for (size_t k{0}; k < res.count_; k++) {
+        for (size_t i{0}; i < rows; i++) {
+            for (size_t j{0}; j < res.cols_; j++) {
+                res[k, i, j] = stacked[k * rows + i, j];
+            }
+        }
+    }
+    return res;
+}
+
+auto BatchedMatrix::to_stacked() const -> Matrix {
+    auto res{Matrix::empty(count_ * rows_, cols_)};
+    for (size_t k{0}; k < count_; k++) {
+        for (size_t i{0}; i < rows_; i++) {
+            for (size_t j{0}; j < cols_; j++) {
+                res[k * rows_ + i, j] = (*this)[k, i, j];
+            }
+        }
+    }
+    return res;
+}
+
+auto BatchedMatrix::matrix(size_t k) const -> Matrix {
+    assert(k < count_);
+    auto res{Matrix::empty(rows_, cols_)};
+    for (size_t i{0}; i < rows_; i++) {
+        for (size_t j{0}; j < cols_; j++) {
+            res[i, j] = (*this)[k, i, j];
+        }
+    }
+    return res;
+}
+
+void BatchedMatrix::set_matrix(size_t k, const Matrix& mat) {
+    assert(k < count_ && mat.shape() == shape());
+    for (size_t i{0}; i < rows_; i++) {
+        for (size_t j{0}; j < cols_; j++) {
+            (*this)[k, i, j] = mat[i, j];
+        }
+    }
+}
+
+auto BatchedMatrix::transposed() const -> Self {
+    Self res(count_, cols_, rows_);
+    for (size_t i{0}; i < rows_; i++) {
+        for (size_t j{0}; j < cols_; j++) {
+            std::copy_n(lanes(i, j), stride_, res.lanes(j, i));
+        }
+    }
+    return res;
+}
+
+auto BatchedMatrix::det() const -> Matrix {
+    assert(is_square());
+    std::vector<value_type> res(stride_);
+    if (rows_ == 0) {
+        std::ranges::fill(res, 1.0);
+    } else if (rows_ <= 4) {
+        const auto kernel{kernels().det[rows_ - 1]};
+        for_lane_ranges(stride_, stride_ * rows_ * rows_ * rows_,
+                        [&](size_t k0, size_t k1) { kernel(*this, res.data(), k0, k1); });
+    } else {
+        for (size_t k{0}; k < count_; k++) {
+            res[k] = foundations::det(matrix(k));
+        }
+    }
+    res.resize(count_);
+    return Matrix(count_, 1, res);
+}
+
+auto BatchedMatrix::inverse() const -> std::optional<Self> {
+    assert(is_square());
+    Self res(count_, rows_, cols_);
+    if (rows_ == 0) {
+        return res;
+    }
+    if (rows_ <= 4) {
+        const auto kernel{kernels().inverse[rows_ - 1]};
+        std::atomic<bool> invertible{true};
+        for_lane_ranges(stride_, stride_ * rows_ * rows_ * rows_, [&](size_t k0, size_t k1) {
+            if (!kernel(*this, res, k0, k1)) {
+                invertible.store(false, std::memory_order_relaxed);
+            }
+        });
+        return invertible.load() ? std::optional{std::move(res)} : std::nullopt;
+    }
+    for (size_t k{0}; k < count_; k++) {
+        const auto inv{foundations::inverse(matrix(k))};
+        if (!inv) {
+            return std::nullopt;
+        }
+        res.set_matrix(k, *inv);
+    }
+    return res;
+}
+
+auto BatchedMatrix::operator+() const -> Self {
+    return *this;
+}
+
+auto BatchedMatrix::operator-() const& -> Self {
+    Self res{*this};
+    simd::negate(res.values_.data(), res.values_.size());
+    return res;
+}
+
+auto BatchedMatrix::operator-() && -> Self {
+    simd::negate(values_.data(), values_.size());
+    return std::move(*this);
+}
+
+BatchedMatrix& BatchedMatrix::operator+=(const Self& other) {
+    assert(count_ == other.count_ && shape() == other.shape());
+    simd::add(values_.data(), other.values_.data(), values_.size());
+    return *this;
+}
+
+BatchedMatrix& BatchedMatrix::operator-=(const Self& other) {
+    assert(count_ == other.count_ && shape() == other.shape());
+    simd::sub(values_.data(), other.values_.data(), values_.size());
+    return *this;
+}
+
+BatchedMatrix& BatchedMatrix::operator+=(const Matrix& mat) {
+    assert(mat.shape() == shape());
+    for (size_t i{0}; i < rows_; i++) {
+        for (size_t j{0}; j < cols_; j++) {
+            simd::add_scalar(lanes(i, j), mat[i, j], stride_);
+        }
+    }
+    return *this;
+}
+
+BatchedMatrix& BatchedMatrix::operator-=(const Matrix& mat) {
+    assert(mat.shape() == shape());
+    for (size_t i{0}; i < rows_; i++) {
+        for (size_t j{0}; j < cols_; j++) {
+            simd::add_scalar(lanes(i, j), -mat[i, j], stride_);
+        }
+    }
+    return *this;
+}
+
+BatchedMatrix& BatchedMatrix::operator*=(value_type value) {
+    simd::mul_scalar(values_.data(), value, values_.size());
+    return *this;
+}
+
+BatchedMatrix& BatchedMatrix::operator/=(value_type value) {
+    simd::div_scalar(values_.data(), value, values_.size());
+    return *this;
+}
+
+BatchedMatrix operator+(BatchedMatrix lhs, const BatchedMatrix& rhs) {
+    lhs += rhs;
+    return lhs;
+}
+
+BatchedMatrix operator-(BatchedMatrix lhs, const BatchedMatrix& rhs) {
+    lhs -= rhs;
+    return lhs;
+}
+
+BatchedMatrix operator+(BatchedMatrix lhs, const Matrix& rhs) {
+    lhs += rhs;
+    return lhs;
+}
+
+BatchedMatrix operator+(const Matrix& lhs, BatchedMatrix rhs) {
+    rhs += lhs;
+    return rhs;
+}
+
+BatchedMatrix operator-(BatchedMatrix lhs, const Matrix& rhs) {
+    lhs -= rhs;
+    return lhs;
+}
+
+BatchedMatrix operator-(const Matrix& lhs, BatchedMatrix rhs) {
+    rhs = -std::move(rhs);
+    rhs += lhs;
+    return rhs;
+}
+
+BatchedMatrix operator*(BatchedMatrix lhs, double rhs) {
+    lhs *= rhs;
+    return lhs;
+}
+
+BatchedMatrix operator*(double lhs, BatchedMatrix rhs) {
+    rhs *= lhs;
+    return rhs;
+}
+
+BatchedMatrix operator/(BatchedMatrix lhs, double rhs) {
+    lhs /= rhs;
+    return lhs;
+}
+
+BatchedMatrix operator*(const BatchedMatrix& lhs, const BatchedMatrix& rhs) {
+    assert(lhs.count() == rhs.count() && lhs.cols() == rhs.rows());
+    BatchedMatrix res(lhs.count(), lhs.rows(), rhs.cols());
+    const auto kernel{kernels().multiply};
+    for_lane_ranges(res.stride(), res.stride() * lhs.rows() * lhs.cols() * rhs.cols(),
+                    [&](size_t k0, size_t k1) { kernel(lhs, rhs, res, k0, k1); });
+    return res;
+}
+
+BatchedMatrix operator*(const BatchedMatrix& lhs, const Matrix& rhs) {
+    assert(lhs.cols() == rhs.rows());
+    BatchedMatrix res(lhs.count(), lhs.rows(), rhs.cols());
+    // res(i, j) = sum over l of lhs(i, l) * rhs[l, j], a tile of lanes at a time
+    for_lane_ranges(res.stride(), res.stride() * lhs.rows() * lhs.cols() * rhs.cols(), [&](size_t k0, size_t k1) {
+        for (size_t t0{k0}; t0 < k1; t0 += LANE_TILE) {
+            const size_t n{std::min(k1, t0 + LANE_TILE) - t0};
+            for (size_t i{0}; i < res.rows(); i++) {
+                for (size_t j{0}; j < res.cols(); j++) {
+                    for (size_t l{0}; l < lhs.cols(); l++) {
+                        simd::axpy(res.lanes(i, j) + t0, rhs[l, j], lhs.lanes(i, l) + t0, n);
+                    }
+                }
+            }
+        }
+    });
+    return res;
+}
+
+BatchedMatrix operator*(const Matrix& lhs, const BatchedMatrix& rhs) {
+    assert(lhs.cols() == rhs.rows());
+    BatchedMatrix res(rhs.count(), lhs.rows(), rhs.cols());
+    for_lane_ranges(res.stride(), res.stride() * lhs.rows() * lhs.cols() * rhs.cols(), [&](size_t k0, size_t k1) {
+        for (size_t t0{k0}; t0 < k1; t0 += LANE_TILE) {
+            const size_t n{std::min(k1, t0 + LANE_TILE) - t0};
+            for (size_t i{0}; i < res.rows(); i++) {
+                for (size_t j{0}; j < res.cols(); j++) {
+                    for (size_t l{0}; l < lhs.cols(); l++) {
+                        simd::axpy(res.lanes(i, j) + t0, lhs[i, l], rhs.lanes(l, j) + t0, n);
+                    }
+                }
+            }
+        }
+    });
+    return res;
+}
+
+bool operator==(const BatchedMatrix& lhs, const BatchedMatrix& rhs) {
+    if (lhs.count() != rhs.count() || lhs.shape() != rhs.shape()) {
+        return false;
+    }
+    for (size_t i{0}; i < lhs.rows(); i++) {
+        for (size_t j{0}; j < lhs.cols(); j++) {
+            if (!std::equal(lhs.lanes(i, j), lhs.lanes(i, j) + lhs.count(), rhs.lanes(i, j))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace matoy::foundations
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "approx.hpp"
+#include "matrix.hpp"
+#include <cstddef>
+#include <format>
+#include <optional>
+#include <vector>
+
+namespace matoy::foundations {
+
+// A stack of `count()` matrices of the same shape, stored in a single buffer with the batch index running fastest:
+// element (i, j) of all matrices lies contiguously at `lanes(i, j)`, one lane per matrix, and consecutive elements
+// are `stride()` apart. The kernels below therefore treat the matrices like the lanes of a SIMD register and work on
+// a whole register of them at once, which pays off for the many tiny transforms a per-matrix loop spends its time
+// allocating and dispatching on.
+//
+// The stride is the count rounded up to a multiple of `lane_block`, so that the kernels never need a scalar tail.
+// The padding lanes take part in the arithmetic but are never observed.
+class BatchedMatrix {
+  public:
+    using value_type = double;
+    using Self = BatchedMatrix;
+
+    static constexpr size_t lane_block = 8;
+
+    // A batch of zero matrices.
+    BatchedMatrix(size_t count, size_t rows, size_t cols);
+
+    // `count` copies of a matrix.
+    static Self repeat(const Matrix& mat, size_t count);
+
+    // Split the rows of a matrix into consecutive blocks of `rows` rows, one matrix each.
+    static Self from_stacked(const Matrix& stacked, size_t rows);
+
+    // The matrices on top of each other, the inverse of `from_stacked`.
+    auto to_stacked() const -> Matrix;
+
+    auto count() const -> size_t {
+        return count_;
+    }
+
+    auto rows() const -> size_t {
+        return rows_;
+    }
+
+    auto cols() const -> size_t {
+        return cols_;
+    }
+
+    // The shape of each matrix.
+    auto shape() const -> std::pair<size_t, size_t> {
+        return {rows_, cols_};
+    }
+
+    auto is_square() const -> bool {
+        return rows_ == cols_;
+    }
+
+    auto stride() const -> size_t {
+        return stride_;
+    }
+
+    // Element (i, j) of every matrix, `stride()` lanes of which the first `count()` are meaningful.
+    auto lanes(size_t i, size_t j) const -> const value_type* {
+        return values_.data() + (i * cols_ + j) * stride_;
+    }
+
+    auto lanes(size_t i, size_t j) -> value_type* {
+        return values_.data() + (i * cols_ + j) * stride_;
+    }
+
+    auto operator[](size_t k, size_t i, size_t j) const -> const value_type& {
+        return lanes(i, j)[k];
+    }
+
+    auto operator[](size_t k, size_t i, size_t j) -> value_type& {
+        return lanes(i, j)[k];
+    }
+
+    // The k-th matrix.
+    auto matrix(size_t k) const -> Matrix;
+
+    void set_matrix(size_t k, const Matrix& mat);
+
+    Self transposed() const;
+
+    // The determinant of each matrix as a column. Up to 4 x 4 the closed forms of FixedMatrix run on a register of
+    // matrices at a time, larger ones go through `det` one by one.
+    auto det() const -> Matrix;
+
+    // The inverse of each matrix, computed like `det`. Returns nothing if any of them is singular.
+    auto inverse() const -> std::optional<Self>;
+
+#pragma region operators
+
+    Self operator+() const;
+
+    Self operator-() const&;
+
+    Self operator-() &&;
+
+    Self& operator+=(const Self& other);
+
+    Self& operator-=(const Self& other);
+
+    // Add the same matrix to each one.
+    Self& operator+=(const Matrix& mat);
+
+    Self& operator-=(const Matrix& mat);
+
+    Self& operator*=(value_type value);
+
+    Self& operator/=(value_type value);
+
+#pragma endregion operators
+
+  private:
+    size_t count_;
+    size_t rows_;
+    size_t cols_;
+    size_t stride_;
+    std::vector<value_type> values_; // rows_ * cols_ arrays of stride_ lanes
+};
+
+// Elementwise sums of batches, or of a batch and a single matrix added to each of its matrices.
+BatchedMatrix operator+(BatchedMatrix lhs, const BatchedMatrix& rhs);
+
+BatchedMatrix operator-(BatchedMatrix lhs, const BatchedMatrix& rhs);
+
+BatchedMatrix operator+(BatchedMatrix lhs, const Matrix& rhs);
+
+BatchedMatrix operator+(const Matrix& lhs, BatchedMatrix rhs);
+
+BatchedMatrix operator-(BatchedMatrix lhs, const Matrix& rhs);
+
+BatchedMatrix operator-(const Matrix& lhs, BatchedMatrix rhs);
+
+BatchedMatrix operator*(BatchedMatrix lhs, double rhs);
+
+BatchedMatrix operator*(double lhs, BatchedMatrix rhs);
+
+BatchedMatrix operator/(BatchedMatrix lhs, double rhs);
+
+// The products of corresponding matrices, a register of them per instruction.
+BatchedMatrix operator*(const BatchedMatrix& lhs, const BatchedMatrix& rhs);
+
+// The product of each matrix with the same matrix, scaling whole lanes by its elements.
+BatchedMatrix operator*(const BatchedMatrix& lhs, const Matrix& rhs);
+
+BatchedMatrix operator*(const Matrix& lhs, const BatchedMatrix& rhs);
+
+bool operator==(const BatchedMatrix& lhs, const BatchedMatrix& rhs);
+
+template <>
+inline auto approx(const BatchedMatrix& x, const BatchedMatrix& y, int ulp) -> bool {
+    if (x.count() != y.count() || x.shape() != y.shape()) {
+        return false;
+    }
+    for (size_t i{0}; i < x.rows(); i++) {
+        for (size_t j{0}; j < x.cols(); j++) {
+            for (size_t k{0}; k < x.count(); k++) {
+                if (!approx(x.lanes(i, j)[k], y.lanes(i, j)[k], ulp)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace matoy::foundations
+
+namespace matoy {
+using foundations::BatchedMatrix;
+}
+
+// A batch prints its matrices in braces, e.g. {[1, 0; 0, 1], [2, 0; 0, 2]}.
+template <>
+struct std::formatter<matoy::BatchedMatrix> : std::formatter<char> {
+    auto format(const matoy::BatchedMatrix& batch, format_context& ctx) const {
+        std::format_to(ctx.out(), "{{");
+        for (size_t k = 0; k < batch.count(); k++) {
+            std::format_to(ctx.out(), "{}[", k == 0 ? "" : ", ");
+            for (size_t i = 0; i < batch.rows(); i++) {
+                if (i != 0) {
+                    std::format_to(ctx.out(), "; ");
+                }
+                for (size_t j = 0; j < batch.cols(); j++) {
+                    if (j != 0) {
+                        std::format_to(ctx.out(), ", ");
+                    }
+                    std::format_to(ctx.out(), "{}", batch[k, i, j]);
+                }
+            }
+            std::format_to(ctx.out(), "]");
+        }
+        return std::format_to(ctx.out(), "}}");
+    }
+};
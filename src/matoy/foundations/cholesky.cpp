@@ -0,0 +1,93 @@
+#include "cholesky.hpp"
+#include "gemm.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+#include "triangular.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace matoy::foundations {
+
+Cholesky::Cholesky(Matrix mat, size_t block_size) : l_{std::move(mat)} {
+    assert(l_.is_square() && block_size > 0);
+    l_.set_layout(Layout::RowMajor);
+    if (l_.rows() > block_size) {
+        l_.set_leading_dim(Matrix::padded_leading_dim(l_.cols()));
+    }
+
+    const size_t n{l_.rows()};
+    auto a{l_.view()};
+    double* base{l_.data()};
+    const size_t ld{l_.leading_dim()};
+
+    for (size_t k0{}; k0 < n; k0 += block_size) {
+        const size_t k1{std::min(k0 + block_size, n)};
+
+        // factorize the diagonal block. Columns before k0 were already subtracted by the trailing updates, so
+        // only the dot products within the panel remain.
+        for (size_t j{k0}; j < k1; j++) {
+            const value_type d{a[j, j] - simd::dot(&a[j, k0], &a[j, k0], j - k0)};
+            if (!(d > 0.0) || !std::isfinite(d)) {
+                positive_definite_ = false;
+                return;
+            }
+            a[j, j] = std::sqrt(d);
+            for (size_t i{j + 1}; i < k1; i++) {
+                a[i, j] = (a[i, j] - simd::dot(&a[i, k0], &a[j, k0], j - k0)) / a[j, j];
+            }
+        }
+        if (k1 == n) {
+            break;
+        }
+
+        // L21 = A21 * L11^-T, by substitution on row chunks in parallel
+        constexpr size_t chunk{64};
+        parallel_for((n - k1 + chunk - 1) / chunk, [&](size_t t) {
+            const size_t r0{k1 + t * chunk}, r1{std::min(r0 + chunk, n)};
+            for (size_t i{r0}; i < r1; i++) {
+                for (size_t j{k0}; j < k1; j++) {
+                    a[i, j] = (a[i, j] - simd::dot(&a[i, k0], &a[j, k0], j - k0)) / a[j, j];
+                }
+            }
+        });
+
+        // A22 -= L21 * L21^T, restricted to the lower triangle by updating one block column at a time
+        constexpr size_t stripe{256};
+        for (size_t c0{k1}; c0 < n; c0 += stripe) {
+            const size_t c1{std::min(c0 + stripe, n)};
+            gemm(-1.0, strided<const double>(base + c0 * ld + k0, n - c0, k1 - k0, ld, 1),
+                 strided<const double>(base + c0 * ld + k0, k1 - k0, c1 - c0, 1, ld), 1.0,
+                 strided(base + c0 * ld + c0, n - c0, c1 - c0, ld, 1));
+        }
+    }
+
+    for (size_t i{}; i < n; i++) {
+        std::fill(base + i * ld + i + 1, base + i * ld + n, 0.0);
+    }
+}
+
+auto Cholesky::det() const -> value_type {
+    assert(positive_definite_);
+    value_type res{1.0};
+    for (size_t i{}; i < l_.rows(); i++) {
+        res *= l_[i, i] * l_[i, i];
+    }
+    return res;
+}
+
+auto Cholesky::solve(const Matrix& b) const -> std::optional<Matrix> {
+    assert(b.rows() == l_.rows());
+    if (!positive_definite_) {
+        return std::nullopt;
+    }
+    return solve_triangular(l_, b, Triangle::Lower).and_then([&](const Matrix& y) {
+        return solve_triangular(l_.transposed(), y, Triangle::Upper);
+    });
+}
+
+auto Cholesky::inverse() const -> std::optional<Matrix> {
+    return solve(Matrix::identity(l_.rows()));
+}
+
+} // namespace matoy::foundations
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "matrix.hpp"
+#include <optional>
+
+namespace matoy::foundations {
+
+// Cholesky factorization of a symmetric positive definite matrix: A = L * L^T with L lower triangular.
+// Only the lower triangle of A is read. Factorization stops at the first pivot that is not positive, which
+// means A is not positive definite (or too badly conditioned to tell).
+//
+// It needs half the work of LU and no pivoting. Like LU, columns are factorized in panels of `block_size` and
+// the trailing submatrix is updated with matrix products.
+class Cholesky {
+  public:
+    using value_type = Matrix::value_type;
+
+    static constexpr size_t default_block_size = 32;
+
+    explicit Cholesky(Matrix mat, size_t block_size = default_block_size);
+
+    auto is_positive_definite() const -> bool {
+        return positive_definite_;
+    }
+
+    // L, with zeros above the diagonal.
+    auto factor() const -> const Matrix& {
+        return l_;
+    }
+
+    // The product of the squared diagonal of L. Only meaningful if the matrix is positive definite.
+    auto det() const -> value_type;
+
+    // Solve A * X = B by substitution with L and L^T. Returns nothing if A is not positive definite.
+    auto solve(const Matrix& b) const -> std::optional<Matrix>;
+
+    auto inverse() const -> std::optional<Matrix>;
+
+  private:
+    Matrix l_;
+    bool positive_definite_{true};
+};
+
+} // namespace matoy::foundations
@@ -0,0 +1,19 @@
+#pragma once
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MATOY_X86_DISPATCH 1
+#endif
+
+namespace matoy::foundations::cpu {
+
+// Whether AVX2 and FMA instructions are available on the running CPU.
+inline auto has_avx2_fma() -> bool {
+#ifdef MATOY_X86_DISPATCH
+    static const bool value = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return value;
+#else
+    return false;
+#endif
+}
+
+} // namespace matoy::foundations::cpu
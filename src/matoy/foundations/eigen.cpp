@@ -0,0 +1,199 @@
+#include "eigen.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace matoy::foundations {
+
+static constexpr auto EPS = std::numeric_limits<Matrix::value_type>::epsilon();
+
+// QL iterations allowed per eigenvalue before giving up. Two or three are typical.
+static constexpr size_t MAX_ITERATIONS = 60;
+
+// Rows (or columns) handed to each parallel task.
+static constexpr size_t CHUNK = 64;
+
+static auto chunks(size_t n) -> size_t {
+    return (n + CHUNK - 1) / CHUNK;
+}
+
+// Reduce the symmetric matrix `a` to tridiagonal form Q^T * A * Q with diagonal d and off-diagonal e, where
+// e[k] couples k and k + 1. Q is the product of the reflectors I - tau[k] * v * v^T acting on k + 1, ..., n - 1,
+// which are stored in row k with their leading 1 implied: v = (1, a[k, k + 2], ..., a[k, n - 1]).
+static void tridiagonalize(strided_span<double> a, std::vector<double>& d, std::vector<double>& e,
+                           std::vector<double>& tau) {
+    const size_t n{a.extent(0)};
+    std::vector<double> v(n), w(n);
+    for (size_t k{0}; k + 1 < n; k++) {
+        const size_t len{n - k - 1};
+        double* x{&a[k, k + 1]};
+        const double alpha{x[0]}, norm2{simd::dot(x + 1, x + 1, len - 1)};
+        if (norm2 == 0.0) {
+            tau[k] = 0.0;
+            e[k] = alpha;
+            continue;
+        }
+        const double beta{-std::copysign(std::sqrt(alpha * alpha + norm2), alpha)};
+        tau[k] = (beta - alpha) / beta;
+        const double scale{1.0 / (alpha - beta)};
+        for (size_t i{1}; i < len; i++) {
+            x[i] *= scale;
+        }
+        x[0] = beta;
+        e[k] = beta;
+        v[0] = 1.0;
+        std::copy_n(x + 1, len - 1, v.begin() + 1);
+
+        // w = p - (tau / 2) * (p^T * v) * v with p = tau * A22 * v, so that H * A22 * H = A22 - v * w^T - w * v^T
+        parallel_for(chunks(len), [&](size_t t) {
+            for (size_t i{t * CHUNK}; i < std::min(len, (t + 1) * CHUNK); i++) {
+                w[i] = tau[k] * simd::dot(&a[k + 1 + i, k + 1], v.data(), len);
+            }
+        });
+        simd::axpy(w.data(), -0.5 * tau[k] * simd::dot(w.data(), v.data(), len), v.data(), len);
+        parallel_for(chunks(len), [&](size_t t) {
+            for (size_t i{t * CHUNK}; i < std::min(len, (t + 1) * CHUNK); i++) {
+                simd::axpy(&a[k + 1 + i, k + 1], -v[i], w.data(), len);
+                simd::axpy(&a[k + 1 + i, k + 1], -w[i], v.data(), len);
+            }
+        });
+    }
+    for (size_t k{0}; k < n; k++) {
+        d[k] = a[k, k];
+    }
+    if (n > 0) {
+        e[n - 1] = 0.0;
+    }
+}
+
+// Apply the rotations of one QL sweep, in the order i = m - 1, ..., l, to the rows i and i + 1 of vt.
+static void apply_rotations(Matrix& vt, size_t l, size_t m, const std::vector<double>& c, const std::vector<double>& s) {
+    const size_t n{vt.cols()};
+    parallel_for(chunks(n), [&](size_t t) {
+        const size_t c0{t * CHUNK}, len{std::min(n, c0 + CHUNK) - c0};
+        for (size_t i{m - 1}; i + 1 > l; i--) {
+            double* x{&vt[i, c0]};
+            double* y{&vt[i + 1, c0]};
+            for (size_t r{0}; r < len; r++) {
+                const double h{y[r]};
+                y[r] = s[i] * x[r] + c[i] * h;
+                x[r] = c[i] * x[r] - s[i] * h;
+            }
+        }
+    });
+}
+
+SymmetricEigen::SymmetricEigen(Matrix mat, bool compute_vectors) : vectors_{Matrix::zeros(0, 0)} {
+    assert(mat.is_square());
+    const size_t n{mat.rows()};
+    mat.set_layout(Layout::RowMajor);
+    if (n > CHUNK) {
+        mat.set_leading_dim(Matrix::padded_leading_dim(n));
+    }
+    auto a{mat.view()};
+    for (size_t i{0}; i < n; i++) {
+        for (size_t j{0}; j < i; j++) {
+            a[i, j] = a[j, i];
+        }
+    }
+
+    std::vector<value_type> d(n), e(n), tau(n);
+    tridiagonalize(a, d, e, tau);
+
+    // implicit QL with Wilkinson shifts, after the tql2 routine of EISPACK. Row i of vt is the eigenvector of
+    // the tridiagonal matrix belonging to d[i].
+    Matrix vt{compute_vectors ? Matrix::identity(n) : Matrix::zeros(0, 0)};
+    std::vector<value_type> rot_c(n), rot_s(n);
+    value_type f{0.0}, tst1{0.0};
+    for (size_t l{0}; l < n; l++) {
+        tst1 = std::max(tst1, std::abs(d[l]) + std::abs(e[l]));
+        size_t m{l};
+        while (m < n - 1 && std::abs(e[m]) > EPS * tst1) {
+            m++;
+        }
+        for (size_t iter{0}; m > l && std::abs(e[l]) > EPS * tst1; iter++) {
+            if (iter == MAX_ITERATIONS) {
+                converged_ = false;
+                return;
+            }
+            value_type g{d[l]};
+            value_type p{(d[l + 1] - g) / (2.0 * e[l])};
+            value_type r{std::copysign(std::hypot(p, 1.0), p)};
+            d[l] = e[l] / (p + r);
+            d[l + 1] = e[l] * (p + r);
+            const value_type dl1{d[l + 1]};
+            value_type h{g - d[l]};
+            for (size_t i{l + 2}; i < n; i++) {
+                d[i] -= h;
+            }
+            f += h;
+
+            p = d[m];
+            value_type c{1.0}, c2{1.0}, c3{1.0}, s{0.0}, s2{0.0};
+            const value_type el1{e[l + 1]};
+            for (size_t i{m - 1}; i + 1 > l; i--) {
+                c3 = c2;
+                c2 = c;
+                s2 = s;
+                g = c * e[i];
+                h = c * p;
+                r = std::hypot(p, e[i]);
+                e[i + 1] = s * r;
+                s = e[i] / r;
+                c = p / r;
+                p = c * d[i] - s * g;
+                d[i + 1] = h + s * (c * g + s * d[i]);
+                rot_c[i] = c;
+                rot_s[i] = s;
+            }
+            p = -s * s2 * c3 * el1 * e[l] / dl1;
+            e[l] = s * p;
+            d[l] = c * p;
+            if (compute_vectors) {
+                apply_rotations(vt, l, m, rot_c, rot_s);
+            }
+        }
+        d[l] += f;
+        e[l] = 0.0;
+    }
+
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::sort(order, {}, [&d](size_t i) { return d[i]; });
+    values_.resize(n);
+    for (size_t i{0}; i < n; i++) {
+        values_[i] = d[order[i]];
+    }
+    if (!compute_vectors) {
+        return;
+    }
+
+    // sort the eigenvectors, then take them back to the original basis with the reflectors of the reduction.
+    // Each task applies every reflector to its own chunk of eigenvectors, which are rows of the sorted vt.
+    auto sorted{Matrix::empty(n, n)};
+    for (size_t i{0}; i < n; i++) {
+        std::copy_n(&vt[order[i], 0], n, &sorted[i, 0]);
+    }
+    parallel_for(chunks(n), [&](size_t t) {
+        const size_t j0{t * CHUNK}, j1{std::min(n, j0 + CHUNK)};
+        for (size_t k{n < 3 ? 0 : n - 2}; k-- > 0;) {
+            if (tau[k] == 0.0) {
+                continue;
+            }
+            const size_t len{n - k - 1};
+            for (size_t j{j0}; j < j1; j++) {
+                double* z{&sorted[j, k + 1]};
+                const double proj{tau[k] * (z[0] + simd::dot(&a[k, k + 2], z + 1, len - 1))};
+                z[0] -= proj;
+                simd::axpy(z + 1, -proj, &a[k, k + 2], len - 1);
+            }
+        }
+    });
+    vectors_ = sorted.transposed();
+}
+
+} // namespace matoy::foundations
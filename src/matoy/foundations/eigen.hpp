@@ -0,0 +1,43 @@
+#pragma once
+
+#include "matrix.hpp"
+#include <vector>
+
+namespace matoy::foundations {
+
+// Eigendecomposition of a symmetric matrix: A = V * diag(values) * V^T with orthogonal V.
+// Only the upper triangle of A is read.
+//
+// A is first reduced to a tridiagonal matrix by Householder reflections, whose eigenvalues are then found by
+// the implicit QL algorithm with Wilkinson shifts. The rotations of each QL sweep, and the reflections that take
+// the eigenvectors back to the original basis, are applied to chunks of the eigenvectors in parallel.
+class SymmetricEigen {
+  public:
+    using value_type = Matrix::value_type;
+
+    // Without `compute_vectors` only the eigenvalues are found, in O(n^2) after the reduction.
+    explicit SymmetricEigen(Matrix mat, bool compute_vectors = true);
+
+    // Whether every eigenvalue converged within the iteration limit. The results are meaningless otherwise.
+    auto converged() const -> bool {
+        return converged_;
+    }
+
+    // The eigenvalues in ascending order.
+    auto values() const -> const std::vector<value_type>& {
+        return values_;
+    }
+
+    // The eigenvectors as the columns of an orthogonal matrix, in the order of `values()`.
+    // Empty unless they were requested.
+    auto vectors() const -> const Matrix& {
+        return vectors_;
+    }
+
+  private:
+    std::vector<value_type> values_;
+    Matrix vectors_;
+    bool converged_{true};
+};
+
+} // namespace matoy::foundations
@@ -0,0 +1,298 @@
+#pragma once
+
+#include "matrix.hpp"
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <utility>
+
+namespace matoy::foundations {
+
+// A matrix whose shape is known at compile time, stored inline without any heap allocation.
+// Everything except the conversions from and to `Matrix` is usable in constant expressions, and all loops
+// have constant trip counts, so the compiler unrolls them for the usual 2x2, 3x3 and 4x4 transforms.
+//
+// A literal deduces its shape: `FixedMatrix m{{1, 2}, {3, 4}}` is a FixedMatrix<2, 2>.
+template <size_t R, size_t C = R>
+class FixedMatrix {
+  public:
+    using value_type = double;
+    using Self = FixedMatrix;
+
+    // A zero matrix.
+    constexpr FixedMatrix() = default;
+
+    template <size_t... Cs>
+        requires(sizeof...(Cs) == R && ((Cs == C) && ...))
+    constexpr FixedMatrix(const value_type (&... rows)[Cs]) {
+        size_t i{0};
+        ((copy_row(i++, rows)), ...);
+    }
+
+    explicit FixedMatrix(const Matrix& mat) {
+        assert(mat.rows() == R && mat.cols() == C);
+        for (size_t i{0}; i < R; i++) {
+            for (size_t j{0}; j < C; j++) {
+                (*this)[i, j] = mat[i, j];
+            }
+        }
+    }
+
+    operator Matrix() const {
+        return Matrix(R, C, data_);
+    }
+
+    static constexpr auto identity() -> Self
+        requires(R == C)
+    {
+        Self res;
+        for (size_t i{0}; i < R; i++) {
+            res[i, i] = 1.0;
+        }
+        return res;
+    }
+
+    static constexpr auto rows() -> size_t {
+        return R;
+    }
+
+    static constexpr auto cols() -> size_t {
+        return C;
+    }
+
+    static constexpr auto size() -> size_t {
+        return R * C;
+    }
+
+    constexpr auto data() const -> const value_type* {
+        return data_.data();
+    }
+
+    constexpr auto data() -> value_type* {
+        return data_.data();
+    }
+
+    constexpr const value_type& operator[](size_t i, size_t j) const {
+        return data_[i * C + j];
+    }
+
+    constexpr value_type& operator[](size_t i, size_t j) {
+        return data_[i * C + j];
+    }
+
+    constexpr auto transposed() const -> FixedMatrix<C, R> {
+        FixedMatrix<C, R> res;
+        for (size_t i{0}; i < R; i++) {
+            for (size_t j{0}; j < C; j++) {
+                res[j, i] = (*this)[i, j];
+            }
+        }
+        return res;
+    }
+
+    // Closed-form determinant.
+    constexpr auto det() const -> value_type
+        requires(R == C && R <= 4)
+    {
+        return adjugate().second;
+    }
+
+    // Closed-form inverse via the adjugate. Returns nothing if the matrix is singular by the pivot test of the LU
+    // factorization, so that larger matrices get the same answer.
+    constexpr auto inverse() const -> std::optional<Self>
+        requires(R == C && R <= 4)
+    {
+        auto [adj, d] = adjugate();
+        if (singular() || d == 0.0) {
+            return std::nullopt;
+        }
+        return adj * (1.0 / d);
+    }
+
+    // Whether elimination with partial pivoting meets a column whose largest remaining element is below epsilon,
+    // the test of BasicLU.
+    constexpr auto singular() const -> bool
+        requires(R == C)
+    {
+        const auto abs = [](value_type x) { return x < 0 ? -x : x; };
+        Self a{*this};
+        for (size_t c{0}; c < R; c++) {
+            size_t k{c};
+            for (size_t r{c + 1}; r < R; r++) {
+                if (abs(a[r, c]) > abs(a[k, c])) {
+                    k = r;
+                }
+            }
+            if (abs(a[k, c]) < std::numeric_limits<value_type>::epsilon()) {
+                return true;
+            }
+            for (size_t j{c}; j < C; j++) {
+                std::swap(a[c, j], a[k, j]);
+            }
+            for (size_t r{c + 1}; r < R; r++) {
+                const value_type f{a[r, c] / a[c, c]};
+                for (size_t j{c + 1}; j < C; j++) {
+                    a[r, j] -= f * a[c, j];
+                }
+            }
+        }
+        return false;
+    }
+
+#pragma region operators
+
+    constexpr Self operator+() const {
+        return *this;
+    }
+
+    constexpr Self operator-() const {
+        Self res;
+        for (size_t k{0}; k < R * C; k++) {
+            res.data_[k] = -data_[k];
+        }
+        return res;
+    }
+
+    friend constexpr Self operator+(const Self& lhs, const Self& rhs) {
+        Self res;
+        for (size_t k{0}; k < R * C; k++) {
+            res.data_[k] = lhs.data_[k] + rhs.data_[k];
+        }
+        return res;
+    }
+
+    friend constexpr Self operator-(const Self& lhs, const Self& rhs) {
+        Self res;
+        for (size_t k{0}; k < R * C; k++) {
+            res.data_[k] = lhs.data_[k] - rhs.data_[k];
+        }
+        return res;
+    }
+
+    friend constexpr Self operator*(const Self& lhs, value_type rhs) {
+        Self res;
+        for (size_t k{0}; k < R * C; k++) {
+            res.data_[k] = lhs.data_[k] * rhs;
+        }
+        return res;
+    }
+
+    friend constexpr Self operator*(value_type lhs, const Self& rhs) {
+        return rhs * lhs;
+    }
+
+    friend constexpr Self operator/(const Self& lhs, value_type rhs) {
+        Self res;
+        for (size_t k{0}; k < R * C; k++) {
+            res.data_[k] = lhs.data_[k] / rhs;
+        }
+        return res;
+    }
+
+    template <size_t K>
+    friend constexpr auto operator*(const Self& lhs, const FixedMatrix<C, K>& rhs) -> FixedMatrix<R, K> {
+        FixedMatrix<R, K> res;
+        for (size_t i{0}; i < R; i++) {
+            for (size_t p{0}; p < C; p++) {
+                for (size_t j{0}; j < K; j++) {
+                    res[i, j] += lhs[i, p] * rhs[p, j];
+                }
+            }
+        }
+        return res;
+    }
+
+    friend constexpr bool operator==(const Self& lhs, const Self& rhs) = default;
+
+#pragma endregion operators
+
+  private:
+    constexpr void copy_row(size_t i, const value_type (&row)[C]) {
+        for (size_t j{0}; j < C; j++) {
+            (*this)[i, j] = row[j];
+        }
+    }
+
+    // The adjugate (transposed cofactor matrix) and the determinant.
+    constexpr auto adjugate() const -> std::pair<Self, value_type> {
+        const auto& a{*this};
+        Self b;
+        if constexpr (R == 1) {
+            b[0, 0] = 1.0;
+            return {b, a[0, 0]};
+        } else if constexpr (R == 2) {
+            b[0, 0] = a[1, 1];
+            b[0, 1] = -a[0, 1];
+            b[1, 0] = -a[1, 0];
+            b[1, 1] = a[0, 0];
+            return {b, a[0, 0] * a[1, 1] - a[0, 1] * a[1, 0]};
+        } else if constexpr (R == 3) {
+            b[0, 0] = a[1, 1] * a[2, 2] - a[1, 2] * a[2, 1];
+            b[0, 1] = a[0, 2] * a[2, 1] - a[0, 1] * a[2, 2];
+            b[0, 2] = a[0, 1] * a[1, 2] - a[0, 2] * a[1, 1];
+            b[1, 0] = a[1, 2] * a[2, 0] - a[1, 0] * a[2, 2];
+            b[1, 1] = a[0, 0] * a[2, 2] - a[0, 2] * a[2, 0];
+            b[1, 2] = a[0, 2] * a[1, 0] - a[0, 0] * a[1, 2];
+            b[2, 0] = a[1, 0] * a[2, 1] - a[1, 1] * a[2, 0];
+            b[2, 1] = a[0, 1] * a[2, 0] - a[0, 0] * a[2, 1];
+            b[2, 2] = a[0, 0] * a[1, 1] - a[0, 1] * a[1, 0];
+            return {b, a[0, 0] * b[0, 0] + a[0, 1] * b[1, 0] + a[0, 2] * b[2, 0]};
+        } else {
+            // 2x2 minors of the top two rows (s) and the bottom two rows (c)
+            const value_type s0{a[0, 0] * a[1, 1] - a[1, 0] * a[0, 1]};
+            const value_type s1{a[0, 0] * a[1, 2] - a[1, 0] * a[0, 2]};
+            const value_type s2{a[0, 0] * a[1, 3] - a[1, 0] * a[0, 3]};
+            const value_type s3{a[0, 1] * a[1, 2] - a[1, 1] * a[0, 2]};
+            const value_type s4{a[0, 1] * a[1, 3] - a[1, 1] * a[0, 3]};
+            const value_type s5{a[0, 2] * a[1, 3] - a[1, 2] * a[0, 3]};
+            const value_type c0{a[2, 0] * a[3, 1] - a[3, 0] * a[2, 1]};
+            const value_type c1{a[2, 0] * a[3, 2] - a[3, 0] * a[2, 2]};
+            const value_type c2{a[2, 0] * a[3, 3] - a[3, 0] * a[2, 3]};
+            const value_type c3{a[2, 1] * a[3, 2] - a[3, 1] * a[2, 2]};
+            const value_type c4{a[2, 1] * a[3, 3] - a[3, 1] * a[2, 3]};
+            const value_type c5{a[2, 2] * a[3, 3] - a[3, 2] * a[2, 3]};
+
+            b[0, 0] = a[1, 1] * c5 - a[1, 2] * c4 + a[1, 3] * c3;
+            b[0, 1] = -a[0, 1] * c5 + a[0, 2] * c4 - a[0, 3] * c3;
+            b[0, 2] = a[3, 1] * s5 - a[3, 2] * s4 + a[3, 3] * s3;
+            b[0, 3] = -a[2, 1] * s5 + a[2, 2] * s4 - a[2, 3] * s3;
+            b[1, 0] = -a[1, 0] * c5 + a[1, 2] * c2 - a[1, 3] * c1;
+            b[1, 1] = a[0, 0] * c5 - a[0, 2] * c2 + a[0, 3] * c1;
+            b[1, 2] = -a[3, 0] * s5 + a[3, 2] * s2 - a[3, 3] * s1;
+            b[1, 3] = a[2, 0] * s5 - a[2, 2] * s2 + a[2, 3] * s1;
+            b[2, 0] = a[1, 0] * c4 - a[1, 1] * c2 + a[1, 3] * c0;
+            b[2, 1] = -a[0, 0] * c4 + a[0, 1] * c2 - a[0, 3] * c0;
+            b[2, 2] = a[3, 0] * s4 - a[3, 1] * s2 + a[3, 3] * s0;
+            b[2, 3] = -a[2, 0] * s4 + a[2, 1] * s2 - a[2, 3] * s0;
+            b[3, 0] = -a[1, 0] * c3 + a[1, 1] * c1 - a[1, 2] * c0;
+            b[3, 1] = a[0, 0] * c3 - a[0, 1] * c1 + a[0, 2] * c0;
+            b[3, 2] = -a[3, 0] * s3 + a[3, 1] * s1 - a[3, 2] * s0;
+            b[3, 3] = a[2, 0] * s3 - a[2, 1] * s1 + a[2, 2] * s0;
+            return {b, s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0};
+        }
+    }
+
+  private:
+    std::array<value_type, R * C> data_{};
+};
+
+template <size_t C, size_t... Cs>
+FixedMatrix(const double (&)[C], const double (&... rows)[Cs]) -> FixedMatrix<1 + sizeof...(Cs), C>;
+
+template <size_t R, size_t C>
+inline auto approx(const FixedMatrix<R, C>& x, const FixedMatrix<R, C>& y, int ulp = 2) -> bool {
+    for (size_t k{0}; k < R * C; k++) {
+        if (!approx(x.data()[k], y.data()[k], ulp)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace matoy::foundations
+
+namespace matoy {
+using foundations::FixedMatrix;
+}
@@ -0,0 +1,330 @@
+#include "gemm.hpp"
+#include "avx2.hpp"
+#include "cpu.hpp"
+#include "matoy/utils/allocator.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace matoy::foundations {
+
+namespace {
+
+// Register tile of the micro-kernel: MR rows by two registers of columns, which is one cache line of `b`.
+constexpr size_t MR = 6;
+template <class T>
+constexpr size_t NR = 64 / sizeof(T);
+
+// Cache blocking: a packed MC x KC block of `a` stays in L2,
+// a packed KC x NC panel of `b` stays in L3 and one KC x NR sliver of it in L1.
+constexpr size_t MC = 96;
+constexpr size_t KC = 256;
+constexpr size_t NC = 4096;
+
+// Below this many multiply-adds, packing costs more than it saves.
+constexpr size_t SMALL_GEMM = 32 * 32 * 32;
+
+// From this many multiply-adds on, the output is split into tiles computed by separate threads.
+constexpr size_t PARALLEL_GEMM = 128 * 128 * 128;
+
+template <class T>
+struct Operand {
+    const T* p;
+    size_t rs;
+    size_t cs;
+
+    auto operator()(size_t i, size_t j) const -> const T& {
+        return p[i * rs + j * cs];
+    }
+
+    auto sub(size_t i, size_t j) const -> Operand {
+        return {p + i * rs + j * cs, rs, cs};
+    }
+};
+
+template <class T>
+struct Output {
+    T* p;
+    size_t rs;
+    size_t cs;
+
+    auto operator()(size_t i, size_t j) const -> T& {
+        return p[i * rs + j * cs];
+    }
+
+    auto sub(size_t i, size_t j) const -> Output {
+        return {p + i * rs + j * cs, rs, cs};
+    }
+};
+
+// Pack an mc x kc block of `a` into row panels of height MR, each stored column by column.
+// Rows past mc are padded with zeros so that the kernel always works on full tiles.
+template <class T>
+void pack_a(size_t mc, size_t kc, Operand<T> a, T* buf) {
+    for (size_t ir{0}; ir < mc; ir += MR) {
+        const size_t mr{std::min(MR, mc - ir)};
+        for (size_t p{0}; p < kc; p++) {
+            for (size_t i{0}; i < mr; i++) {
+                buf[i] = a(ir + i, p);
+            }
+            std::fill(buf + mr, buf + MR, T{0});
+            buf += MR;
+        }
+    }
+}
+
+// Pack a kc x nc panel of `b` into column panels of width NR, each stored row by row.
+template <class T>
+void pack_b(size_t kc, size_t nc, Operand<T> b, T* buf) {
+    constexpr size_t nr_max{NR<T>};
+    for (size_t jr{0}; jr < nc; jr += nr_max) {
+        const size_t nr{std::min(nr_max, nc - jr)};
+        for (size_t p{0}; p < kc; p++) {
+            if (b.cs == 1) {
+                std::copy_n(&b(p, jr), nr, buf);
+            } else {
+                for (size_t j{0}; j < nr; j++) {
+                    buf[j] = b(p, jr + j);
+                }
+            }
+            std::fill(buf + nr, buf + nr_max, T{0});
+            buf += nr_max;
+        }
+    }
+}
+
+// ab = a * b for one packed MR x kc sliver of `a` and one packed kc x NR sliver of `b`.
+template <class T>
+using kernel_fn = void (*)(size_t kc, const T* a, const T* b, T* ab);
+
+template <class T>
+void kernel_generic(size_t kc, const T* a, const T* b, T* ab) {
+    constexpr size_t nr{NR<T>};
+    T acc[MR * nr]{};
+    for (size_t p{0}; p < kc; p++) {
+        for (size_t i{0}; i < MR; i++) {
+            const T ai{a[i]};
+            for (size_t j{0}; j < nr; j++) {
+                acc[i * nr + j] += ai * b[j];
+            }
+        }
+        a += MR;
+        b += nr;
+    }
+    std::copy_n(acc, MR * nr, ab);
+}
+
+#ifdef MATOY_X86_DISPATCH
+
+// Keeps the whole 6 x NR tile in 12 ymm registers; each step broadcasts one element of `a`
+// and issues two FMAs against a row of `b`.
+template <class T>
+[[gnu::target("avx2,fma")]] void kernel_avx2(size_t kc, const T* a, const T* b, T* ab) {
+    using V = avx2::Vec<T>;
+    constexpr size_t w{V::lanes}, nr{NR<T>};
+    static_assert(nr == 2 * w);
+    auto c00 = V::zero(), c01 = V::zero();
+    auto c10 = V::zero(), c11 = V::zero();
+    auto c20 = V::zero(), c21 = V::zero();
+    auto c30 = V::zero(), c31 = V::zero();
+    auto c40 = V::zero(), c41 = V::zero();
+    auto c50 = V::zero(), c51 = V::zero();
+
+    for (size_t p{0}; p < kc; p++) {
+        const auto b0 = V::load(b);
+        const auto b1 = V::load(b + w);
+        typename V::reg ai;
+        ai = V::broadcast(a + 0);
+        c00 = V::fmadd(ai, b0, c00);
+        c01 = V::fmadd(ai, b1, c01);
+        ai = V::broadcast(a + 1);
+        c10 = V::fmadd(ai, b0, c10);
+        c11 = V::fmadd(ai, b1, c11);
+        ai = V::broadcast(a + 2);
+        c20 = V::fmadd(ai, b0, c20);
+        c21 = V::fmadd(ai, b1, c21);
+        ai = V::broadcast(a + 3);
+        c30 = V::fmadd(ai, b0, c30);
+        c31 = V::fmadd(ai, b1, c31);
+        ai = V::broadcast(a + 4);
+        c40 = V::fmadd(ai, b0, c40);
+        c41 = V::fmadd(ai, b1, c41);
+        ai = V::broadcast(a + 5);
+        c50 = V::fmadd(ai, b0, c50);
+        c51 = V::fmadd(ai, b1, c51);
+        a += MR;
+        b += nr;
+    }
+
+    V::store(ab + 0 * nr, c00);
+    V::store(ab + 0 * nr + w, c01);
+    V::store(ab + 1 * nr, c10);
+    V::store(ab + 1 * nr + w, c11);
+    V::store(ab + 2 * nr, c20);
+    V::store(ab + 2 * nr + w, c21);
+    V::store(ab + 3 * nr, c30);
+    V::store(ab + 3 * nr + w, c31);
+    V::store(ab + 4 * nr, c40);
+    V::store(ab + 4 * nr + w, c41);
+    V::store(ab + 5 * nr, c50);
+    V::store(ab + 5 * nr + w, c51);
+}
+
+#endif
+
+template <class T>
+auto select_kernel() -> kernel_fn<T> {
+#ifdef MATOY_X86_DISPATCH
+    if (cpu::has_avx2_fma()) {
+        return kernel_avx2<T>;
+    }
+#endif
+    return kernel_generic<T>;
+}
+
+// c = alpha * ab + beta * c for the valid mr x nr part of a tile.
+template <class T>
+void store_tile(size_t mr, size_t nr, T alpha, const T* ab, T beta, Output<T> c) {
+    if (nr == NR<T> && c.cs == 1) {
+        // whole contiguous rows, in loops of fixed length that the compiler vectorizes
+        for (size_t i{0}; i < mr; i++) {
+            const T* abi{ab + i * NR<T>};
+            T* ci{&c(i, 0)};
+            if (beta == T{0}) {
+                for (size_t j{0}; j < NR<T>; j++) {
+                    ci[j] = alpha * abi[j];
+                }
+            } else {
+                for (size_t j{0}; j < NR<T>; j++) {
+                    ci[j] = alpha * abi[j] + beta * ci[j];
+                }
+            }
+        }
+        return;
+    }
+    for (size_t i{0}; i < mr; i++) {
+        for (size_t j{0}; j < nr; j++) {
+            T& cij{c(i, j)};
+            cij = beta == T{0} ? alpha * ab[i * NR<T> + j] : alpha * ab[i * NR<T> + j] + beta * cij;
+        }
+    }
+}
+
+template <class T>
+void scale(size_t m, size_t n, T beta, Output<T> c) {
+    for (size_t i{0}; i < m; i++) {
+        for (size_t j{0}; j < n; j++) {
+            c(i, j) = beta == T{0} ? T{0} : beta * c(i, j);
+        }
+    }
+}
+
+template <class T>
+void gemm_small(size_t m, size_t n, size_t k, T alpha, Operand<T> a, Operand<T> b, T beta, Output<T> c) {
+    scale(m, n, beta, c);
+    for (size_t i{0}; i < m; i++) {
+        for (size_t p{0}; p < k; p++) {
+            const T aip{alpha * a(i, p)};
+            for (size_t j{0}; j < n; j++) {
+                c(i, j) += aip * b(p, j);
+            }
+        }
+    }
+}
+
+template <class T>
+void gemm_blocked(size_t m, size_t n, size_t k, T alpha, Operand<T> a, Operand<T> b, T beta, Output<T> c) {
+    static const kernel_fn<T> kernel{select_kernel<T>()};
+    constexpr size_t nr_max{NR<T>};
+
+    thread_local std::vector<T, utils::aligned_allocator<T>> a_buf;
+    thread_local std::vector<T, utils::aligned_allocator<T>> b_buf;
+    a_buf.resize(std::max(a_buf.size(), MC * KC));
+    b_buf.resize(std::max(b_buf.size(), KC * std::min(NC, (n + nr_max - 1) / nr_max * nr_max)));
+
+    alignas(32) T ab[MR * nr_max];
+
+    for (size_t jc{0}; jc < n; jc += NC) {
+        const size_t nc{std::min(NC, n - jc)};
+        for (size_t pc{0}; pc < k; pc += KC) {
+            const size_t kc{std::min(KC, k - pc)};
+            const T beta_pc{pc == 0 ? beta : T{1}};
+            pack_b(kc, nc, b.sub(pc, jc), b_buf.data());
+
+            for (size_t ic{0}; ic < m; ic += MC) {
+                const size_t mc{std::min(MC, m - ic)};
+                pack_a(mc, kc, a.sub(ic, pc), a_buf.data());
+
+                for (size_t jr{0}; jr < nc; jr += nr_max) {
+                    const size_t nr{std::min(nr_max, nc - jr)};
+                    for (size_t ir{0}; ir < mc; ir += MR) {
+                        const size_t mr{std::min(MR, mc - ir)};
+                        kernel(kc, a_buf.data() + ir * kc, b_buf.data() + jr * kc, ab);
+                        store_tile(mr, nr, alpha, ab, beta_pc, c.sub(ic + ir, jc + jr));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Split c into a grid of roughly `threads` tiles whose sides are multiples of the register tile,
+// and run the serial blocked kernel on each of them.
+// Every element is still accumulated in the same order, so the result is identical to the serial one.
+template <class T>
+void gemm_parallel(size_t m, size_t n, size_t k, T alpha, Operand<T> a, Operand<T> b, T beta, Output<T> c,
+                   size_t threads) {
+    constexpr size_t nr{NR<T>};
+    const double ratio{static_cast<double>(m) / static_cast<double>(n)};
+    const size_t pm{std::clamp<size_t>(std::lround(std::sqrt(threads * ratio)), 1, threads)};
+    const size_t pn{(threads + pm - 1) / pm};
+    const size_t tile_m{((m + pm - 1) / pm + MR - 1) / MR * MR};
+    const size_t tile_n{((n + pn - 1) / pn + nr - 1) / nr * nr};
+    const size_t tiles_m{(m + tile_m - 1) / tile_m};
+    const size_t tiles_n{(n + tile_n - 1) / tile_n};
+
+    parallel_for(tiles_m * tiles_n, [&](size_t t) {
+        const size_t i{t / tiles_n * tile_m}, j{t % tiles_n * tile_n};
+        gemm_blocked(std::min(tile_m, m - i), std::min(tile_n, n - j), k, alpha, a.sub(i, 0), b.sub(0, j), beta,
+                     c.sub(i, j));
+    });
+}
+
+template <class T>
+void gemm_impl(T alpha, strided_span<const T> a, strided_span<const T> b, T beta, strided_span<T> c) {
+    const size_t m{c.extent(0)}, n{c.extent(1)}, k{a.extent(1)};
+    assert(a.extent(0) == m && b.extent(0) == k && b.extent(1) == n);
+
+    const Operand<T> a_{a.data_handle(), a.stride(0), a.stride(1)};
+    const Operand<T> b_{b.data_handle(), b.stride(0), b.stride(1)};
+    const Output<T> c_{c.data_handle(), c.stride(0), c.stride(1)};
+
+    if (m == 0 || n == 0) {
+        return;
+    }
+    if (k == 0 || alpha == T{0}) {
+        scale(m, n, beta, c_);
+    } else if (m * n * k <= SMALL_GEMM) {
+        gemm_small(m, n, k, alpha, a_, b_, beta, c_);
+    } else if (const size_t threads{num_threads()}; threads > 1 && m * n * k >= PARALLEL_GEMM) {
+        gemm_parallel(m, n, k, alpha, a_, b_, beta, c_, threads);
+    } else {
+        gemm_blocked(m, n, k, alpha, a_, b_, beta, c_);
+    }
+}
+
+} // namespace
+
+void gemm(double alpha, strided_span<const double> a, strided_span<const double> b, double beta,
+          strided_span<double> c) {
+    gemm_impl(alpha, a, b, beta, c);
+}
+
+void gemm(float alpha, strided_span<const float> a, strided_span<const float> b, float beta,
+          strided_span<float> c) {
+    gemm_impl(alpha, a, b, beta, c);
+}
+
+} // namespace matoy::foundations
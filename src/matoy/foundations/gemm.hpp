@@ -0,0 +1,17 @@
+#pragma once
+
+#include "strided.hpp"
+
+namespace matoy::foundations {
+
+// General matrix multiplication: c = alpha * a * b + beta * c.
+// Operands may have arbitrary strides, so transposed or padded views are multiplied without copying.
+// If beta is zero, c is only written to.
+// Large products are split into tiles over `num_threads()` threads. Each element is accumulated in the same
+// order either way, so the parallel result is bitwise identical to the single-threaded one.
+// Single precision runs the same code with twice as many elements per register.
+void gemm(double alpha, strided_span<const double> a, strided_span<const double> b, double beta,
+          strided_span<double> c);
+void gemm(float alpha, strided_span<const float> a, strided_span<const float> b, float beta, strided_span<float> c);
+
+} // namespace matoy::foundations
@@ -0,0 +1,187 @@
+#include "lu.hpp"
+#include "gemm.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace matoy::foundations {
+
+template <class T>
+static constexpr auto EPS = std::numeric_limits<T>::epsilon();
+
+// Up to this many right-hand sides are solved column by column.
+static constexpr size_t FEW_COLUMNS = 8;
+
+template <class T>
+BasicLU<T>::BasicLU(matrix_type mat, size_t block_size) : lu_{std::move(mat)}, perm_(lu_.rows()) {
+    assert(lu_.is_square() && block_size > 0);
+    lu_.set_layout(Layout::RowMajor);
+    if (lu_.rows() > block_size) {
+        // the trailing updates stream down columns, which a power-of-two row length would map to few cache sets
+        lu_.set_leading_dim(matrix_type::padded_leading_dim(lu_.cols()));
+    }
+
+    const size_t n{lu_.rows()};
+    std::iota(perm_.begin(), perm_.end(), 0);
+    auto a{lu_.view()};
+    std::vector<T> panel;
+    std::vector<size_t> pivots(block_size);
+
+    for (size_t k0{}; k0 < n; k0 += block_size) {
+        const size_t k1{std::min(k0 + block_size, n)};
+
+        // factorize the panel of columns [k0, k1) in a column-major copy, which stays in cache and turns the
+        // pivot search and the updates into loops over contiguous columns. The row swaps are applied to the whole
+        // matrix afterwards.
+        const size_t w{k1 - k0}, rows{n - k0};
+        panel.resize(rows * w);
+        for (size_t j{0}; j < rows; j++) {
+            for (size_t c{0}; c < w; c++) {
+                panel[c * rows + j] = a[k0 + j, k0 + c];
+            }
+        }
+        for (size_t i{0}; i < w; i++) {
+            T* col{&panel[i * rows]};
+            // find the row with the greatest first element
+            size_t k{i};
+            T max{std::abs(col[i])};
+            for (size_t j{i + 1}; j < rows; j++) {
+                if (std::abs(col[j]) > max) {
+                    k = j;
+                    max = std::abs(col[j]);
+                }
+            }
+            if (max < EPS<T>) {
+                singular_ = true;
+                return;
+            }
+            pivots[i] = k;
+            if (k != i) {
+                for (size_t c{0}; c < w; c++) {
+                    std::swap(panel[c * rows + i], panel[c * rows + k]);
+                }
+            }
+            simd::mul_scalar(col + i + 1, T{1} / col[i], rows - i - 1);
+            for (size_t c{i + 1}; c < w; c++) {
+                T* other{&panel[c * rows]};
+                if (other[i] != T{0}) {
+                    simd::axpy(other + i + 1, -other[i], col + i + 1, rows - i - 1);
+                }
+            }
+        }
+        for (size_t i{0}; i < w; i++) {
+            if (const size_t k{k0 + pivots[i]}; k != k0 + i) {
+                lu_.swap_row(k0 + i, k);
+                std::swap(perm_[k0 + i], perm_[k]);
+                sign_ = -sign_;
+            }
+        }
+        for (size_t j{0}; j < rows; j++) {
+            for (size_t c{0}; c < w; c++) {
+                a[k0 + j, k0 + c] = panel[c * rows + j];
+            }
+        }
+        if (k1 == n) {
+            break;
+        }
+
+        // U12 = L11^-1 * A12, by forward substitution on column chunks in parallel
+        constexpr size_t chunk{256};
+        parallel_for((n - k1 + chunk - 1) / chunk, [&](size_t t) {
+            const size_t c0{k1 + t * chunk}, c1{std::min(c0 + chunk, n)};
+            for (size_t i{k0 + 1}; i < k1; i++) {
+                for (size_t p{k0}; p < i; p++) {
+                    simd::axpy(&a[i, c0], -a[i, p], &a[p, c0], c1 - c0);
+                }
+            }
+        });
+
+        // A22 -= L21 * U12
+        T* base{lu_.data()};
+        const size_t ld{lu_.leading_dim()};
+        gemm(T{-1}, strided<const T>(base + k1 * ld + k0, n - k1, k1 - k0, ld, 1),
+             strided<const T>(base + k0 * ld + k1, k1 - k0, n - k1, ld, 1), T{1},
+             strided(base + k1 * ld + k1, n - k1, n - k1, ld, 1));
+    }
+}
+
+template <class T>
+auto BasicLU<T>::det() const -> value_type {
+    if (singular_) {
+        return T{0};
+    }
+    value_type res{sign_};
+    for (size_t i{}; i < lu_.rows(); i++) {
+        res *= lu_[i, i];
+    }
+    return res;
+}
+
+template <class T>
+auto BasicLU<T>::solve(const matrix_type& b) const -> std::optional<matrix_type> {
+    assert(b.rows() == lu_.rows());
+    if (singular_) {
+        return std::nullopt;
+    }
+
+    const size_t n{lu_.rows()}, m{b.cols()};
+    // few columns are stored column-major, see below
+    matrix_type x{m <= FEW_COLUMNS ? matrix_type::empty(m, n).transposed() : matrix_type::empty(n, m)};
+    for (size_t i{}; i < n; i++) {
+        for (size_t j{}; j < m; j++) {
+            x[i, j] = b[perm_[i], j];
+        }
+    }
+
+    if (m <= FEW_COLUMNS) {
+        // substitute each column on its own, so that the updates are dot products of a row of the factors and the
+        // contiguous part of the column solved so far
+        const T* l{lu_.data()};
+        const size_t ld{lu_.leading_dim()};
+        for (size_t j{}; j < m; j++) {
+            T* xj{&x[0, j]};
+            for (size_t i{1}; i < n; i++) {
+                xj[i] -= simd::dot(l + i * ld, xj, i);
+            }
+            for (size_t i{n - 1}; ~i; i--) {
+                xj[i] = (xj[i] - simd::dot(l + i * ld + i + 1, xj + i + 1, n - i - 1)) / l[i * ld + i];
+            }
+        }
+        return x;
+    }
+
+    // forward substitution with the unit lower factor
+    for (size_t i{}; i < n; i++) {
+        for (size_t k{}; k < i; k++) {
+            if (lu_[i, k] != T{0}) {
+                x.add_row_multiple(i, k, -lu_[i, k]);
+            }
+        }
+    }
+    // back substitution with the upper factor
+    for (size_t i{n - 1}; ~i; i--) {
+        for (size_t k{i + 1}; k < n; k++) {
+            if (lu_[i, k] != T{0}) {
+                x.add_row_multiple(i, k, -lu_[i, k]);
+            }
+        }
+        x.multiply_row(i, T{1} / lu_[i, i]);
+    }
+
+    return x;
+}
+
+template <class T>
+auto BasicLU<T>::inverse() const -> std::optional<matrix_type> {
+    return solve(matrix_type::identity(lu_.rows()));
+}
+
+template class BasicLU<double>;
+template class BasicLU<float>;
+
+} // namespace matoy::foundations
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "matrix.hpp"
+#include <optional>
+#include <vector>
+
+namespace matoy::foundations {
+
+// LU factorization with partial pivoting: P * A = L * U.
+// L has a unit diagonal and is packed together with U into a single matrix.
+// Factorization stops at the first pivot that is numerically zero and marks the matrix as singular.
+//
+// Columns are factorized in panels of `block_size`. After each panel, the trailing submatrix is updated with
+// a single (parallel) matrix product, which is where almost all of the work happens for large matrices.
+// `FloatLU` factorizes in single precision at twice the speed, see RefinedLU for recovering double accuracy.
+template <class T>
+class BasicLU {
+  public:
+    using value_type = T;
+    using matrix_type = BasicMatrix<T>;
+
+    static constexpr size_t default_block_size = 32;
+
+    explicit BasicLU(matrix_type mat, size_t block_size = default_block_size);
+
+    auto is_singular() const -> bool {
+        return singular_;
+    }
+
+    // The packed factors: U on and above the diagonal, L below it.
+    auto factors() const -> const matrix_type& {
+        return lu_;
+    }
+
+    // Row i of P * A is row `pivots()[i]` of A.
+    auto pivots() const -> const std::vector<size_t>& {
+        return perm_;
+    }
+
+    auto det() const -> value_type;
+
+    // Solve A * X = B for X. Returns nothing if A is singular.
+    auto solve(const matrix_type& b) const -> std::optional<matrix_type>;
+
+    auto inverse() const -> std::optional<matrix_type>;
+
+  private:
+    matrix_type lu_;
+    std::vector<size_t> perm_;
+    value_type sign_{1};
+    bool singular_{false};
+};
+
+extern template class BasicLU<double>;
+extern template class BasicLU<float>;
+
+using LU = BasicLU<double>;
+using FloatLU = BasicLU<float>;
+
+} // namespace matoy::foundations
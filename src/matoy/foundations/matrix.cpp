@@ -1,199 +1,498 @@
 #include "matrix.hpp"
+#include "gemm.hpp"
+#include "simd.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <utility>
 
 namespace matoy::foundations {
 
-Matrix::Matrix(std::initializer_list<std::initializer_list<Matrix::value_type>> l)
+template <class T>
+BasicMatrix<T>::BasicMatrix(std::initializer_list<std::initializer_list<value_type>> l)
     : rows_{l.size()}, cols_{l.begin()->size()} {
     assert(l.size() > 0);
 
-    data_.resize(rows_ * cols_);
+    allocate();
+    T* x{data()};
     for (size_t i = 0; auto& l1 : l) {
         assert(l1.size() == cols_);
-        std::ranges::copy(l1, data_.begin() + i * cols_);
+        std::ranges::copy(l1, x + i * ld_);
         i++;
     }
 }
 
-Matrix Matrix::zeros(size_t rows, size_t cols, const Matrix::value_type& fill_value) {
-    Matrix res;
+template <class T>
+template <class U>
+BasicMatrix<T>::BasicMatrix(const BasicMatrix<U>& other)
+    : rows_{other.rows_}, cols_{other.cols_}, layout_{other.layout_} {
+    allocate();
+    const U* src{other.data()};
+    T* dst{data()};
+    for (size_t l{0}; l < lines(); l++) {
+        std::transform(src + l * other.ld_, src + l * other.ld_ + line_size(), dst + l * ld_,
+                       [](U x) { return static_cast<T>(x); });
+    }
+}
+
+template <class T>
+auto BasicMatrix<T>::zeros(size_t rows, size_t cols, const value_type& fill_value) -> Self {
+    Self res;
+    res.rows_ = rows;
+    res.cols_ = cols;
+    res.allocate();
+    std::ranges::fill(res.buffer(), fill_value);
+    return res;
+}
+
+template <class T>
+auto BasicMatrix<T>::empty(size_t rows, size_t cols) -> Self {
+    Self res;
     res.rows_ = rows;
     res.cols_ = cols;
-    res.data_.resize(rows * cols, fill_value);
+    res.allocate();
     return res;
 }
 
-Matrix Matrix::identity(size_t n) {
-    Matrix res = Matrix::zeros(n, n);
+template <class T>
+auto BasicMatrix<T>::padded(size_t rows, size_t cols) -> Self {
+    Self res;
+    res.rows_ = rows;
+    res.cols_ = cols;
+    res.allocate(padded_leading_dim(cols));
+    return res;
+}
+
+template <class T>
+auto BasicMatrix<T>::padded_leading_dim(size_t n) -> size_t {
+    constexpr size_t cache_line{64 / sizeof(value_type)}, page{4096 / sizeof(value_type)};
+    size_t ld{(n + cache_line - 1) / cache_line * cache_line};
+    if (ld % page == 0) {
+        ld += cache_line;
+    }
+    return ld;
+}
+
+static std::atomic<size_t> buffer_copies_{0};
+
+template <class T>
+auto BasicMatrix<T>::buffer_copies() -> size_t {
+    return buffer_copies_.load(std::memory_order_relaxed);
+}
+
+template <class T>
+void BasicMatrix<T>::allocate(size_t ld) {
+    ld_ = ld != 0 ? ld : line_size();
+    offset_ = 0;
+    assert(ld_ >= line_size());
+    if (storage_size() > inline_capacity) {
+        data_ = std::make_shared<buffer_type>(storage_size());
+    } else {
+        data_.reset();
+    }
+}
+
+template <class T>
+void BasicMatrix<T>::copy_buffer() {
+    const T* first{data_->data() + offset_};
+    if (offset_ == 0 && storage_size() == data_->size()) {
+        // the whole buffer, keeping any padding
+        data_ = std::make_shared<buffer_type>(first, first + storage_size());
+    } else {
+        // a block copies only its own lines, packed, so a narrow block of a wide matrix doesn't copy the lines between
+        const size_t n{line_size()};
+        auto copy{std::make_shared<buffer_type>(lines() * n)};
+        for (size_t l{0}; l < lines(); l++) {
+            std::copy_n(first + l * ld_, n, copy->data() + l * n);
+        }
+        data_ = std::move(copy);
+        ld_ = n;
+    }
+    offset_ = 0;
+    buffer_copies_.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <class T>
+auto BasicMatrix<T>::identity(size_t n) -> Self {
+    Self res = Self::zeros(n, n);
     for (size_t i = 0; i < n; i++) {
-        res[i, i] = 1.0;
+        res[i, i] = T{1};
+    }
+    return res;
+}
+
+// Transposition walks the matrix in square tiles of this size, so that the rows being read
+// and the rows being written both stay in L1.
+static constexpr size_t TRANSPOSE_TILE = 16;
+
+// dst = src^T, where src is rows x cols with row stride lds and dst has row stride ldd.
+template <class T>
+static void transpose_tiled(size_t rows, size_t cols, const T* src, size_t lds, T* dst, size_t ldd) {
+    for (size_t i0{0}; i0 < rows; i0 += TRANSPOSE_TILE) {
+        const size_t i1{std::min(i0 + TRANSPOSE_TILE, rows)};
+        for (size_t j0{0}; j0 < cols; j0 += TRANSPOSE_TILE) {
+            const size_t j1{std::min(j0 + TRANSPOSE_TILE, cols)};
+            for (size_t j{j0}; j < j1; j++) {
+                for (size_t i{i0}; i < i1; i++) {
+                    dst[j * ldd + i] = src[i * lds + j];
+                }
+            }
+        }
+    }
+}
+
+// In-place transpose of an n x n matrix with row stride ld, swapping mirrored tiles.
+template <class T>
+static void transpose_square(size_t n, T* a, size_t ld) {
+    for (size_t i0{0}; i0 < n; i0 += TRANSPOSE_TILE) {
+        const size_t i1{std::min(i0 + TRANSPOSE_TILE, n)};
+        for (size_t i{i0}; i < i1; i++) {
+            for (size_t j{i + 1}; j < i1; j++) {
+                std::swap(a[i * ld + j], a[j * ld + i]);
+            }
+        }
+        for (size_t j0{i1}; j0 < n; j0 += TRANSPOSE_TILE) {
+            const size_t j1{std::min(j0 + TRANSPOSE_TILE, n)};
+            for (size_t i{i0}; i < i1; i++) {
+                for (size_t j{j0}; j < j1; j++) {
+                    std::swap(a[i * ld + j], a[j * ld + i]);
+                }
+            }
+        }
+    }
+}
+
+template <class T>
+auto BasicMatrix<T>::transposed() const -> Self {
+    auto res{*this};
+    res.transpose();
+    return res;
+}
+
+template <class T>
+void BasicMatrix<T>::transpose() {
+    std::swap(rows_, cols_);
+    layout_ = layout_ == Layout::RowMajor ? Layout::ColMajor : Layout::RowMajor;
+}
+
+template <class T>
+void BasicMatrix<T>::set_layout(Layout layout) {
+    if (layout == layout_) {
+        return;
+    }
+    // the buffer holds either the matrix or its transpose in row-major order, so switching is a transpose of it
+    if (is_square()) {
+        T* x{data()};
+        transpose_square(rows_, x, ld_);
+    } else {
+        Self res;
+        res.rows_ = rows_;
+        res.cols_ = cols_;
+        res.layout_ = layout;
+        res.allocate();
+        transpose_tiled(lines(), line_size(), std::as_const(*this).data(), ld_, res.data(), res.ld_);
+        *this = std::move(res);
+    }
+    layout_ = layout;
+}
+
+template <class T>
+void BasicMatrix<T>::set_leading_dim(size_t ld) {
+    if (ld == ld_) {
+        return;
+    }
+    Self res;
+    res.rows_ = rows_;
+    res.cols_ = cols_;
+    res.layout_ = layout_;
+    res.allocate(ld);
+    res.set_block(0, 0, *this);
+    *this = std::move(res);
+}
+
+template <class T>
+void BasicMatrix<T>::set_block(size_t row, size_t col, const Self& block) {
+    assert(row + block.rows_ <= rows_ && col + block.cols_ <= cols_);
+    if (block.size() == 0) {
+        return;
+    }
+    // look at both buffers as row-major: a column-major matrix is the row-major buffer of its transpose
+    const bool row_major{layout_ == Layout::RowMajor};
+    T* dst{data()};
+    dst += row_major ? row * ld_ + col : col * ld_ + row;
+    const size_t r{row_major ? block.rows_ : block.cols_}, c{row_major ? block.cols_ : block.rows_};
+    if (block.layout_ == layout_) {
+        for (size_t i{0}; i < r; i++) {
+            std::copy_n(block.data() + i * block.ld_, c, dst + i * ld_);
+        }
+    } else {
+        transpose_tiled(c, r, block.data(), block.ld_, dst, ld_);
+    }
+}
+
+template <class T>
+auto BasicMatrix<T>::block(size_t row, size_t col, size_t rows, size_t cols) const -> Self {
+    assert(row + rows <= rows_ && col + cols <= cols_);
+    Self res;
+    res.rows_ = rows;
+    res.cols_ = cols;
+    res.layout_ = layout_;
+    if (!data_ || rows * cols == 0) {
+        // inline elements can't be shared
+        res.allocate();
+        for (size_t i{0}; i < rows; i++) {
+            for (size_t j{0}; j < cols; j++) {
+                res[i, j] = (*this)[row + i, col + j];
+            }
+        }
+        return res;
     }
+    res.ld_ = ld_;
+    res.data_ = data_;
+    res.offset_ = offset_ + (layout_ == Layout::RowMajor ? row * ld_ + col : col * ld_ + row);
     return res;
 }
 
-Matrix Matrix::transposed() const {
-    auto res{Matrix::zeros(cols_, rows_)};
-    for (size_t i{0}; i < rows_; i++) {
-        for (size_t j{0}; j < cols_; j++) {
-            res[j, i] = (*this)[i, j];
+template <class T>
+auto BasicMatrix<T>::slice(Slice rows, Slice cols) const -> Self {
+    if (rows.step == 1 && cols.step == 1) {
+        return block(rows.start, cols.start, rows.count, cols.count);
+    }
+    Self res;
+    res.rows_ = rows.count;
+    res.cols_ = cols.count;
+    res.layout_ = layout_;
+    res.allocate();
+    const auto src{subview(view(), rows, cols)};
+    for (size_t i{0}; i < rows.count; i++) {
+        for (size_t j{0}; j < cols.count; j++) {
+            res[i, j] = src[i, j];
         }
     }
     return res;
 }
 
-void Matrix::swap_row(size_t r1, size_t r2) {
+template <class T>
+void BasicMatrix<T>::set_slice(Slice rows, Slice cols, const Self& values) {
+    assert(values.shape() == std::pair(rows.count, cols.count));
+    if (rows.step == 1 && cols.step == 1) {
+        set_block(rows.start, cols.start, values);
+        return;
+    }
+    const auto dst{subview(view(), rows, cols)};
+    const auto src{values.view()};
+    for (size_t i{0}; i < rows.count; i++) {
+        for (size_t j{0}; j < cols.count; j++) {
+            dst[i, j] = src[i, j];
+        }
+    }
+}
+
+template <class T>
+void BasicMatrix<T>::swap_row(size_t r1, size_t r2) {
+    if (r1 == r2) {
+        return;
+    }
+    if (layout_ == Layout::RowMajor) {
+        T* base{data()};
+        simd::swap(base + r1 * ld_, base + r2 * ld_, cols_);
+        return;
+    }
     for (size_t j = 0; j < cols_; j++) {
         std::swap((*this)[r1, j], (*this)[r2, j]);
     }
 }
 
-void Matrix::multiply_row(size_t r, const Matrix::value_type& x) {
+template <class T>
+void BasicMatrix<T>::multiply_row(size_t r, const value_type& x) {
+    if (layout_ == Layout::RowMajor) {
+        T* base{data()};
+        simd::mul_scalar(base + r * ld_, x, cols_);
+        return;
+    }
     for (size_t j = 0; j < cols_; j++) {
         (*this)[r, j] *= x;
     }
 }
 
-void Matrix::add_row_multiple(size_t r1, size_t r2, const Matrix::value_type& x) {
+template <class T>
+void BasicMatrix<T>::add_row_multiple(size_t r1, size_t r2, const value_type& x) {
+    if (layout_ == Layout::RowMajor) {
+        T* base{data()};
+        simd::axpy(base + r1 * ld_, x, base + r2 * ld_, cols_);
+        return;
+    }
     for (size_t j = 0; j < cols_; j++) {
         (*this)[r1, j] += (*this)[r2, j] * x;
     }
 }
 
-Matrix Matrix::operator+() const {
-    return *this;
+// Apply a kernel over contiguous memory to each row (row-major) or column (column-major) of `self`,
+// or to the whole buffer at once when there is no padding.
+template <class T, class F>
+static void for_each_line(BasicMatrix<T>& self, F f) {
+    T* x{self.data()};
+    if (self.is_contiguous()) {
+        f(x, self.size());
+        return;
+    }
+    const bool row_major{self.layout() == Layout::RowMajor};
+    const size_t lines{row_major ? self.rows() : self.cols()}, n{row_major ? self.cols() : self.rows()};
+    for (size_t l{0}; l < lines; l++) {
+        f(x + l * self.leading_dim(), n);
+    }
 }
 
-Matrix Matrix::operator-() const {
-    auto res{*this};
-    for (size_t i{0}; i < data_.size(); i++) {
-        res.data_[i] = -res.data_[i];
-    }
-    return res;
+template <class T>
+void BasicMatrix<T>::negate() {
+    for_each_line(*this, [](T* x, size_t n) { simd::negate(x, n); });
 }
 
-Matrix operator+(const Matrix& lhs, const Matrix& rhs) {
-    assert(lhs.shape() == rhs.shape());
-    auto res{lhs};
-    res += rhs;
-    return res;
+template <class T>
+auto BasicMatrix<T>::operator+() const -> Self {
+    return *this;
 }
 
-Matrix operator+(const Matrix& lhs, Matrix::value_type rhs) {
-    auto res{lhs};
-    res += rhs;
+template <class T>
+static auto multiply(const BasicMatrix<T>& lhs, const BasicMatrix<T>& rhs) -> BasicMatrix<T> {
+    assert(lhs.cols() == rhs.rows());
+    auto res{BasicMatrix<T>::empty(lhs.rows(), rhs.cols())};
+    gemm(T{1}, lhs.view(), rhs.view(), T{0}, res.view());
     return res;
 }
 
-Matrix operator+(Matrix::value_type lhs, const Matrix& rhs) {
-    auto res{rhs};
-    res += lhs;
-    return res;
+Matrix operator*(const Matrix& lhs, const Matrix& rhs) {
+    return multiply(lhs, rhs);
 }
 
-Matrix operator-(const Matrix& lhs, const Matrix& rhs) {
-    assert(lhs.shape() == rhs.shape());
-    auto res{lhs};
-    res -= rhs;
-    return res;
+FloatMatrix operator*(const FloatMatrix& lhs, const FloatMatrix& rhs) {
+    return multiply(lhs, rhs);
 }
 
-Matrix operator-(const Matrix& lhs, Matrix::value_type rhs) {
-    auto res{lhs};
-    res -= rhs;
-    return res;
+template <class T>
+static void multiply_to(BasicMatrix<T>& c, const BasicMatrix<T>& a, const BasicMatrix<T>& b) {
+    assert(a.cols() == b.rows());
+    if (&c == &a || &c == &b) {
+        c = a * b;
+        return;
+    }
+    if (c.shape() != std::pair{a.rows(), b.cols()} || c.is_shared()) {
+        c = BasicMatrix<T>::empty(a.rows(), b.cols());
+    }
+    gemm(T{1}, a.view(), b.view(), T{0}, c.view());
 }
 
-Matrix operator-(Matrix::value_type lhs, const Matrix& rhs) {
-    auto res{rhs};
-    res -= lhs;
-    return res;
+void multiply_into(Matrix& c, const Matrix& a, const Matrix& b) {
+    multiply_to(c, a, b);
 }
 
-Matrix operator*(const Matrix& lhs, const Matrix& rhs) {
-    assert(lhs.cols_ == rhs.rows_);
-    auto res{Matrix::zeros(lhs.rows_, rhs.cols_)};
-    auto v{res.view()};
-    auto v1{lhs.view()};
-    auto v2{rhs.view()};
-    for (size_t i{0}; i < lhs.rows_; i++) {
-        for (size_t k{0}; k < lhs.cols_; k++) {
-            for (size_t j{0}; j < rhs.cols_; j++) {
-                v[i, j] += v1[i, k] * v2[k, j];
-            }
+void multiply_into(FloatMatrix& c, const FloatMatrix& a, const FloatMatrix& b) {
+    multiply_to(c, a, b);
+}
+
+template <class T>
+static void add_to(BasicMatrix<T>& c, const BasicMatrix<T>& a, const BasicMatrix<T>& b) {
+    assert(a.shape() == b.shape());
+    if (&c == &b) {
+        c += a;
+        return;
+    }
+    if (&c != &a) {
+        if (c.shape() != a.shape() || c.is_shared()) {
+            c = BasicMatrix<T>::empty(a.rows(), a.cols());
         }
+        c.set_block(0, 0, a);
     }
-    return res;
+    c += b;
 }
 
-Matrix operator*(const Matrix& lhs, Matrix::value_type rhs) {
-    auto res{lhs};
-    res *= rhs;
-    return res;
+void add_into(Matrix& c, const Matrix& a, const Matrix& b) {
+    add_to(c, a, b);
 }
 
-Matrix operator*(Matrix::value_type lhs, const Matrix& rhs) {
-    auto res{rhs};
-    res *= lhs;
-    return res;
+void add_into(FloatMatrix& c, const FloatMatrix& a, const FloatMatrix& b) {
+    add_to(c, a, b);
 }
 
-Matrix operator/(const Matrix& lhs, Matrix::value_type rhs) {
-    auto res{lhs};
-    res /= rhs;
-    return res;
+template <class T>
+static auto equal(const BasicMatrix<T>& lhs, const BasicMatrix<T>& rhs) -> bool {
+    if (lhs.shape() != rhs.shape()) {
+        return false;
+    }
+    if (lhs.layout() == rhs.layout() && lhs.is_contiguous() && rhs.is_contiguous()) {
+        return std::ranges::equal(lhs.buffer(), rhs.buffer());
+    }
+    for (size_t i{0}; i < lhs.rows(); i++) {
+        for (size_t j{0}; j < lhs.cols(); j++) {
+            if (lhs[i, j] != rhs[i, j]) {
+                return false;
+            }
+        }
+    }
+    return true;
 }
 
 bool operator==(const Matrix& lhs, const Matrix& rhs) {
-    return lhs.shape() == rhs.shape() && lhs.data_ == rhs.data_;
+    return equal(lhs, rhs);
 }
 
-Matrix& Matrix::operator+=(const Matrix& other) {
+bool operator==(const FloatMatrix& lhs, const FloatMatrix& rhs) {
+    return equal(lhs, rhs);
+}
+
+template <class T>
+auto BasicMatrix<T>::operator+=(const Self& other) -> Self& {
     assert(shape() == other.shape());
-    for (size_t i{0}; i < data_.size(); i++) {
-        data_[i] += other.data_[i];
+    if (layout_ == other.layout_ && is_contiguous() && other.is_contiguous()) {
+        simd::add(data(), other.data(), size());
+        return *this;
     }
-    return *this;
+    return *this += MatrixLeaf<const Self&>{other};
 }
 
-Matrix& Matrix::operator+=(value_type value) {
-    for (size_t i{0}; i < data_.size(); i++) {
-        data_[i] += value;
-    }
+template <class T>
+auto BasicMatrix<T>::operator+=(value_type value) -> Self& {
+    for_each_line(*this, [value](T* x, size_t n) { simd::add_scalar(x, value, n); });
     return *this;
 }
 
-Matrix& Matrix::operator-=(const Matrix& other) {
+template <class T>
+auto BasicMatrix<T>::operator-=(const Self& other) -> Self& {
     assert(shape() == other.shape());
-    for (size_t i{0}; i < data_.size(); i++) {
-        data_[i] -= other.data_[i];
+    if (layout_ == other.layout_ && is_contiguous() && other.is_contiguous()) {
+        simd::sub(data(), other.data(), size());
+        return *this;
     }
-    return *this;
+    return *this -= MatrixLeaf<const Self&>{other};
 }
 
-Matrix& Matrix::operator-=(value_type value) {
-    for (size_t i{0}; i < data_.size(); i++) {
-        data_[i] -= value;
-    }
+template <class T>
+auto BasicMatrix<T>::operator-=(value_type value) -> Self& {
+    for_each_line(*this, [value](T* x, size_t n) { simd::add_scalar(x, -value, n); });
     return *this;
 }
 
-Matrix& Matrix::operator*=(const Matrix& other) {
+template <class T>
+auto BasicMatrix<T>::operator*=(const Self& other) -> Self& {
     return *this = *this * other;
 }
 
-Matrix& Matrix::operator*=(value_type value) {
-    for (size_t i{0}; i < data_.size(); i++) {
-        data_[i] *= value;
-    }
+template <class T>
+auto BasicMatrix<T>::operator*=(value_type value) -> Self& {
+    for_each_line(*this, [value](T* x, size_t n) { simd::mul_scalar(x, value, n); });
     return *this;
 }
 
-Matrix& Matrix::operator/=(value_type value) {
-    for (size_t i{0}; i < data_.size(); i++) {
-        data_[i] /= value;
-    }
+template <class T>
+auto BasicMatrix<T>::operator/=(value_type value) -> Self& {
+    for_each_line(*this, [value](T* x, size_t n) { simd::div_scalar(x, value, n); });
     return *this;
 }
 
+template class BasicMatrix<double>;
+template class BasicMatrix<float>;
+
+template BasicMatrix<double>::BasicMatrix(const BasicMatrix<float>&);
+template BasicMatrix<float>::BasicMatrix(const BasicMatrix<double>&);
+
 } // namespace matoy::foundations
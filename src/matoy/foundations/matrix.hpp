@@ -1,27 +1,88 @@
 #pragma once
 
 #include "approx.hpp"
+#include "matoy/utils/allocator.hpp"
+#include "matrix_expr.hpp"
+#include "strided.hpp"
 #include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
 #include <format>
 #include <initializer_list>
-#include <mdspan>
+#include <memory>
 #include <ranges>
+#include <span>
 #include <vector>
 
 namespace matoy::foundations {
 
-class Matrix {
+// A dense matrix of T, which is double or float. `Matrix` and `FloatMatrix` below name the two precisions, which
+// share the kernels. Lazy elementwise expressions only evaluate into double precision.
+template <class T>
+class BasicMatrix {
   public:
-    using value_type = double;
-    using Self = Matrix;
+    using value_type = T;
+    using buffer_type =
+        std::vector<value_type, utils::default_init_allocator<value_type, utils::aligned_allocator<value_type>>>;
+    using Self = BasicMatrix;
 
-    Matrix(size_t rows, size_t cols, std::ranges::input_range auto&& data) : rows_{rows}, cols_{cols}, data_{data} {}
+    // Matrices with at most this many elements keep them inline instead of in a heap buffer.
+    static constexpr size_t inline_capacity = 16;
 
-    Matrix(std::initializer_list<std::initializer_list<value_type>> l);
+    BasicMatrix(size_t rows, size_t cols, std::ranges::input_range auto&& data) : rows_{rows}, cols_{cols} {
+        allocate();
+        std::ranges::copy(data, this->data());
+    }
+
+    BasicMatrix(std::initializer_list<std::initializer_list<value_type>> l);
+
+    // Convert the elements to another precision, keeping the layout.
+    template <class U>
+    explicit BasicMatrix(const BasicMatrix<U>& other);
+
+    // Evaluate an elementwise expression in a single pass.
+    // The result is column-major only if every matrix in the expression is.
+    template <matrix_expr E>
+        requires std::same_as<T, double>
+    BasicMatrix(const E& expr)
+        : rows_{expr.rows()}, cols_{expr.cols()},
+          layout_{expr.has_layout(Layout::ColMajor) ? Layout::ColMajor : Layout::RowMajor} {
+        allocate();
+        eval_expr(expr, [](value_type& x, value_type y) { x = y; });
+    }
+
+    // An expiring expression that owns an unshared matrix, such as `std::move(a) * 2.0 + b`, is evaluated into the
+    // buffer of that matrix instead of a new one.
+    template <matrix_expr E>
+        requires(std::same_as<T, double> && !std::is_lvalue_reference_v<E>)
+    BasicMatrix(E&& expr) : BasicMatrix{evaluate_in_place(expr)} {}
+
+    // Evaluate into the existing buffer when the shape matches.
+    template <matrix_expr E>
+        requires std::same_as<T, double>
+    Self& operator=(const E& expr) {
+        if (rows_ != expr.rows() || cols_ != expr.cols()) {
+            return *this = Self(expr);
+        }
+        eval_expr(expr, [](value_type& x, value_type y) { x = y; });
+        return *this;
+    }
 
-    static Matrix zeros(size_t rows, size_t cols, const value_type& fill_value = {});
+    static Self zeros(size_t rows, size_t cols, const value_type& fill_value = {});
 
-    static Matrix identity(size_t n);
+    // A matrix with uninitialized elements, for results that are about to be overwritten.
+    static Self empty(size_t rows, size_t cols);
+
+    // Like `empty`, but with rows padded to `padded_leading_dim(cols)`.
+    static Self padded(size_t rows, size_t cols);
+
+    // A leading dimension of at least n whose rows start on cache-line boundaries, and which is not a
+    // multiple of 4 KiB, so that walking down a column doesn't keep hitting the same cache set.
+    static auto padded_leading_dim(size_t n) -> size_t;
+
+    static Self identity(size_t n);
 
     auto size() const -> size_t {
         return rows_ * cols_;
@@ -43,32 +104,101 @@ class Matrix {
         return cols_;
     }
 
+    auto layout() const -> Layout {
+        return layout_;
+    }
+
+    // Distance in the buffer between consecutive rows (row-major) or columns (column-major).
+    auto leading_dim() const -> size_t {
+        return ld_;
+    }
+
+    // Whether the buffer holds no padding between rows or columns.
+    auto is_contiguous() const -> bool {
+        return ld_ == (layout_ == Layout::RowMajor ? cols_ : rows_);
+    }
+
+    // Distance in the buffer between (i, j) and (i + 1, j).
+    auto row_stride() const -> size_t {
+        return layout_ == Layout::RowMajor ? ld_ : 1;
+    }
+
+    // Distance in the buffer between (i, j) and (i, j + 1).
+    auto col_stride() const -> size_t {
+        return layout_ == Layout::RowMajor ? 1 : ld_;
+    }
+
+    // Move the elements into a buffer with the given leading dimension, which may add or remove padding.
+    void set_leading_dim(size_t ld);
+
+    // Copies of a matrix, and blocks taken from it, share one heap buffer until one of them is written to.
+    // Every non-const access to the elements goes through `unshare()` first, so take pointers and views
+    // through a const reference when only reading, and read the strides after taking them. A block copies only its
+    // own elements, into a buffer without the lines of its parent between them.
+    void unshare() {
+        if (data_.use_count() > 1) {
+            copy_buffer();
+        }
+    }
+
+    auto is_shared() const -> bool {
+        return data_.use_count() > 1;
+    }
+
+    // The number of times any matrix buffer has been copied by `unshare()`.
+    static auto buffer_copies() -> size_t;
+
+    // The raw buffer, in the order given by `layout()` and `leading_dim()`.
     auto data() const -> const value_type* {
-        return data_.data();
+        return data_ ? data_->data() + offset_ : inline_.data();
     }
 
     auto data() -> value_type* {
-        return data_.data();
+        unshare();
+        return data_ ? data_->data() + offset_ : inline_.data();
     }
 
-    auto view() const {
-        return std::mdspan(data_.data(), rows_, cols_);
+    auto view() const -> strided_span<const value_type> {
+        return strided(data(), rows_, cols_, row_stride(), col_stride());
     }
 
-    auto view() {
-        return std::mdspan(data_.data(), rows_, cols_);
+    auto view() -> strided_span<value_type> {
+        value_type* x{data()};
+        return strided(x, rows_, cols_, row_stride(), col_stride());
     }
 
-    auto buffer() const -> const auto& {
-        return data_;
+    // The whole buffer, including any padding.
+    auto buffer() const -> std::span<const value_type> {
+        return {data(), storage_size()};
     }
 
-    auto buffer() -> auto& {
-        return data_;
+    auto buffer() -> std::span<value_type> {
+        value_type* x{data()};
+        return {x, storage_size()};
     }
 
     Self transposed() const;
 
+    // Transpose in O(1) by switching the layout. No element is moved.
+    void transpose();
+
+    // Rearrange the buffer into the given layout, keeping the logical matrix unchanged.
+    // Square matrices are rearranged without allocating.
+    void set_layout(Layout layout);
+
+    // Overwrite the block of this matrix starting at (row, col) with `block`.
+    void set_block(size_t row, size_t col, const Self& block);
+
+    // The rows x cols block starting at (row, col), without copying: it points into this matrix's heap buffer with
+    // the same layout and leading dimension, so every kernel takes it like any padded matrix.
+    Self block(size_t row, size_t col, size_t rows, size_t cols) const;
+
+    // The elements at the given rows and columns. Unit steps give a `block`, other steps a compact copy.
+    Self slice(Slice rows, Slice cols) const;
+
+    // Overwrite the elements at the given rows and columns with `values`, which has their shape.
+    void set_slice(Slice rows, Slice cols, const Self& values);
+
 #pragma region basic_transformation
 
     void swap_row(size_t r1, size_t r2);
@@ -77,92 +207,185 @@ class Matrix {
 
     void add_row_multiple(size_t r1, size_t r2, const value_type& x);
 
+    // Negate every element in place.
+    void negate();
+
 #pragma endregion basic_transformation
 
 #pragma region operators
 
     const value_type& operator[](size_t i, size_t j) const {
-        return data_[i * cols_ + j];
+        return data()[i * row_stride() + j * col_stride()];
     }
 
     value_type& operator[](size_t i, size_t j) {
-        return data_[i * cols_ + j];
+        return data()[i * row_stride() + j * col_stride()];
     }
 
     Self operator+() const;
 
-    Self operator-() const;
-
-    friend Self operator+(const Self& lhs, const Self& rhs);
+    // Elementwise arithmetic builds lazy expressions, see matrix_expr.hpp.
 
-    friend Self operator+(const Self& lhs, value_type rhs);
+    Self& operator+=(const Self& other);
 
-    friend Self operator+(value_type lhs, const Self& rhs);
+    Self& operator+=(value_type value);
 
-    friend Self operator-(const Self& lhs, const Self& rhs);
+    Self& operator-=(const Self& other);
 
-    friend Self operator-(const Self& lhs, value_type rhs);
+    Self& operator-=(value_type value);
 
-    friend Self operator-(value_type lhs, const Self& rhs);
+    template <matrix_expr E>
+    Self& operator+=(const E& expr) {
+        eval_expr(expr, [](value_type& x, value_type y) { x += y; });
+        return *this;
+    }
 
-    friend Self operator*(const Self& lhs, const Self& rhs);
+    template <matrix_expr E>
+    Self& operator-=(const E& expr) {
+        eval_expr(expr, [](value_type& x, value_type y) { x -= y; });
+        return *this;
+    }
 
-    friend Self operator*(const Self& lhs, value_type rhs);
+    Self& operator*=(const Self& other);
 
-    friend Self operator*(value_type lhs, const Self& rhs);
+    Self& operator*=(value_type value);
 
-    friend Self operator/(const Self& lhs, value_type rhs);
+    Self& operator/=(value_type value);
 
-    friend bool operator==(const Self& lhs, const Self& rhs);
+#pragma endregion operators
 
-    Self& operator+=(const Self& other);
+  private:
+    template <class U>
+    friend class BasicMatrix;
 
-    Self& operator+=(value_type value);
+    BasicMatrix() = default;
 
-    Self& operator-=(const Self& other);
+    // Number of rows (row-major) or columns (column-major) in the buffer, and the length of each.
+    auto lines() const -> size_t {
+        return layout_ == Layout::RowMajor ? rows_ : cols_;
+    }
 
-    Self& operator-=(value_type value);
+    auto line_size() const -> size_t {
+        return layout_ == Layout::RowMajor ? cols_ : rows_;
+    }
 
-    Self& operator*=(const Self& other);
+    auto storage_size() const -> size_t {
+        return lines() == 0 ? 0 : (lines() - 1) * ld_ + line_size();
+    }
 
-    Self& operator*=(value_type value);
+    // Give this matrix fresh, uninitialized storage with leading dimension `ld`, or no padding if it is 0.
+    void allocate(size_t ld = 0);
 
-    Self& operator/=(value_type value);
+    void copy_buffer();
 
-#pragma endregion operators
+    template <class E>
+    static Self evaluate_in_place(E& expr) {
+        Self* target{expr.target()};
+        if (!target || target->is_shared()) {
+            return Self(std::as_const(expr));
+        }
+        target->eval_expr(expr, [](value_type& x, value_type y) { x = y; });
+        return std::move(*target);
+    }
 
-  private:
-    Matrix() = default;
+    // Side of the square tiles in which a matrix is walked when its operands are stored in the other order.
+    static constexpr size_t expr_tile = 16;
+
+    // Update each element x of this matrix with f(x, y), where y is the element of `expr` at the same position.
+    template <class E, class F>
+    void eval_expr(const E& expr, F f) {
+        assert(rows_ == expr.rows() && cols_ == expr.cols());
+        value_type* x{data()};
+        if (expr.has_layout(layout_)) {
+            const size_t n{line_size()};
+            for (size_t l{0}; l < lines(); l++) {
+                value_type* line{x + l * ld_};
+                for (size_t k{0}; k < n; k++) {
+                    f(line[k], expr.flat(l, k));
+                }
+            }
+            return;
+        }
+        const size_t rs{row_stride()}, cs{col_stride()};
+        for (size_t i0{0}; i0 < rows_; i0 += expr_tile) {
+            const size_t i1{std::min(i0 + expr_tile, rows_)};
+            for (size_t j0{0}; j0 < cols_; j0 += expr_tile) {
+                const size_t j1{std::min(j0 + expr_tile, cols_)};
+                for (size_t i{i0}; i < i1; i++) {
+                    for (size_t j{j0}; j < j1; j++) {
+                        f(x[i * rs + j * cs], expr[i, j]);
+                    }
+                }
+            }
+        }
+    }
 
   private:
     size_t rows_;
     size_t cols_;
-    std::vector<value_type> data_;
-
-    friend struct std::formatter<matoy::foundations::Matrix>;
+    size_t ld_;
+    std::shared_ptr<buffer_type> data_; // null when the elements are inline
+    size_t offset_{0};                  // of the first element in *data_, for blocks of another matrix
+    std::array<value_type, inline_capacity> inline_;
+    Layout layout_{Layout::RowMajor};
 };
 
+extern template class BasicMatrix<double>;
+extern template class BasicMatrix<float>;
+
+using Matrix = BasicMatrix<double>;
+using FloatMatrix = BasicMatrix<float>;
+
+// Matrix product, computed with `gemm`. Expression operands are evaluated first.
+Matrix operator*(const Matrix& lhs, const Matrix& rhs);
+FloatMatrix operator*(const FloatMatrix& lhs, const FloatMatrix& rhs);
+
+// c = a * b in the buffer of c, which is only replaced when its shape differs or it is shared, so a loop computing
+// products of one shape allocates nothing. c may be a or b, which costs a temporary.
+void multiply_into(Matrix& c, const Matrix& a, const Matrix& b);
+void multiply_into(FloatMatrix& c, const FloatMatrix& a, const FloatMatrix& b);
+
+// c = a + b in the buffer of c, like `c = a + b`, but through the vectorized kernel when the layouts agree.
+void add_into(Matrix& c, const Matrix& a, const Matrix& b);
+void add_into(FloatMatrix& c, const FloatMatrix& a, const FloatMatrix& b);
+
+bool operator==(const Matrix& lhs, const Matrix& rhs);
+bool operator==(const FloatMatrix& lhs, const FloatMatrix& rhs);
+
 template <>
 inline auto approx(const Matrix& x, const Matrix& y, int ulp) -> bool {
-    return x.shape() == y.shape() &&
-           std::ranges::equal(x.buffer(), y.buffer(), [ulp](auto& x, auto& y) { return approx(x, y, ulp); });
+    if (x.shape() != y.shape()) {
+        return false;
+    }
+    if (x.layout() == y.layout() && x.is_contiguous() && y.is_contiguous()) {
+        return std::ranges::equal(x.buffer(), y.buffer(), [ulp](auto& x, auto& y) { return approx(x, y, ulp); });
+    }
+    for (size_t i = 0; i < x.rows(); i++) {
+        for (size_t j = 0; j < x.cols(); j++) {
+            if (!approx(x[i, j], y[i, j], ulp)) {
+                return false;
+            }
+        }
+    }
+    return true;
 }
 
 } // namespace matoy::foundations
 
 namespace matoy {
+using foundations::FloatMatrix;
 using foundations::Matrix;
 }
 
-template <>
-struct std::formatter<matoy::Matrix> : std::formatter<char> {
-    auto format(const matoy::Matrix& mat, format_context& ctx) const {
+template <class T>
+struct std::formatter<matoy::foundations::BasicMatrix<T>> : std::formatter<char> {
+    auto format(const matoy::foundations::BasicMatrix<T>& mat, format_context& ctx) const {
         std::format_to(ctx.out(), "[");
-        for (size_t i = 0; i < mat.rows_; i++) {
+        for (size_t i = 0; i < mat.rows(); i++) {
             if (i != 0) {
                 std::format_to(ctx.out(), "; ");
             }
-            for (size_t j = 0; j < mat.cols_; j++) {
+            for (size_t j = 0; j < mat.cols(); j++) {
                 if (j != 0) {
                     std::format_to(ctx.out(), ", ");
                 }
@@ -172,3 +395,10 @@ struct std::formatter<matoy::Matrix> : std::formatter<char> {
         return std::format_to(ctx.out(), "]");
     }
 };
+
+template <matoy::foundations::matrix_expr E>
+struct std::formatter<E> : std::formatter<matoy::Matrix> {
+    auto format(const E& expr, format_context& ctx) const {
+        return std::formatter<matoy::Matrix>::format(matoy::Matrix(expr), ctx);
+    }
+};
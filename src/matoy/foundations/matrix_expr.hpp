@@ -0,0 +1,299 @@
+#pragma once
+
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace matoy::foundations {
+
+template <class T>
+class BasicMatrix;
+using Matrix = BasicMatrix<double>;
+
+// How the elements of a matrix are laid out in its buffer, given the leading dimension ld.
+enum class Layout : uint8_t {
+    RowMajor, // element (i, j) at i * ld + j
+    ColMajor, // element (i, j) at j * ld + i
+};
+
+// Lazy elementwise expressions over matrices.
+//
+// Elementwise operators return expression nodes that only record their operands. The whole expression is
+// evaluated in a single pass when it is converted to a `Matrix`, so `a + b * 2.0 - c` allocates one result
+// and reads each operand once.
+//
+// A node provides rows(), cols(), has_layout(layout), flat(line, k) and operator[](i, j). flat(line, k) is the k-th
+// element of a row (row-major) or column (column-major), and is only used when every matrix in the expression has
+// the layout of the destination.
+// Lvalue matrices are held by reference and rvalue matrices by value, so a node never refers to a temporary.
+// Element (i, j) of a node only depends on element (i, j) of its operands, so an expression may be assigned to
+// a matrix it reads from. target() returns a full-shape matrix that the node owns, if any, which an expiring
+// expression is then evaluated into instead of a new buffer.
+
+template <class E>
+inline constexpr bool is_matrix_expr = false;
+
+template <class E>
+concept matrix_expr = is_matrix_expr<std::remove_cvref_t<E>>;
+
+// A matrix, or an expression that evaluates to one.
+template <class T>
+concept matrix_operand = matrix_expr<T> || std::same_as<std::remove_cvref_t<T>, Matrix>;
+
+// M is either `const Matrix&` or `Matrix`.
+template <class M>
+struct MatrixLeaf {
+    M mat;
+
+    auto rows() const -> size_t {
+        return mat.rows();
+    }
+
+    auto cols() const -> size_t {
+        return mat.cols();
+    }
+
+    auto has_layout(Layout layout) const -> bool {
+        return mat.layout() == layout;
+    }
+
+    auto flat(size_t line, size_t k) const -> double {
+        return mat.data()[line * mat.leading_dim() + k];
+    }
+
+    auto operator[](size_t i, size_t j) const -> double {
+        return mat[i, j];
+    }
+
+    auto target() -> Matrix* {
+        if constexpr (std::is_reference_v<M>) {
+            return nullptr;
+        } else {
+            return &mat;
+        }
+    }
+};
+
+template <class Op, class E>
+struct MapExpr {
+    Op op;
+    E arg;
+
+    MapExpr(Op op, E arg) : op{std::move(op)}, arg{std::move(arg)} {}
+
+    auto rows() const -> size_t {
+        return arg.rows();
+    }
+
+    auto cols() const -> size_t {
+        return arg.cols();
+    }
+
+    auto has_layout(Layout layout) const -> bool {
+        return arg.has_layout(layout);
+    }
+
+    auto flat(size_t line, size_t k) const -> double {
+        return op(arg.flat(line, k));
+    }
+
+    auto operator[](size_t i, size_t j) const -> double {
+        return op(arg[i, j]);
+    }
+
+    auto target() -> Matrix* {
+        return arg.target();
+    }
+};
+
+template <class Op, class L, class R>
+struct ZipExpr {
+    Op op;
+    L lhs;
+    R rhs;
+
+    ZipExpr(Op op, L lhs, R rhs) : op{std::move(op)}, lhs{std::move(lhs)}, rhs{std::move(rhs)} {
+        assert(this->lhs.rows() == this->rhs.rows() && this->lhs.cols() == this->rhs.cols());
+    }
+
+    auto rows() const -> size_t {
+        return lhs.rows();
+    }
+
+    auto cols() const -> size_t {
+        return lhs.cols();
+    }
+
+    auto has_layout(Layout layout) const -> bool {
+        return lhs.has_layout(layout) && rhs.has_layout(layout);
+    }
+
+    auto flat(size_t line, size_t k) const -> double {
+        return op(lhs.flat(line, k), rhs.flat(line, k));
+    }
+
+    auto operator[](size_t i, size_t j) const -> double {
+        return op(lhs[i, j], rhs[i, j]);
+    }
+
+    auto target() -> Matrix* {
+        Matrix* res{lhs.target()};
+        return res ? res : rhs.target();
+    }
+};
+
+// An operand with a single row or column repeated to a larger shape, NumPy style, without copying it: element (i, j)
+// is element (0, j) of a row vector, (i, 0) of a column vector and (0, 0) of a 1 x 1 operand. When the expansion is
+// real, only row-major results of row-major operands take the flat path, where the repeated index steps by 0.
+template <class E>
+struct BroadcastExpr {
+    E arg;
+    std::pair<size_t, size_t> shape;
+    size_t line_step, k_step;
+
+    BroadcastExpr(E arg, size_t rows, size_t cols) : arg{std::move(arg)}, shape{rows, cols} {
+        assert(this->arg.rows() == rows || this->arg.rows() == 1);
+        assert(this->arg.cols() == cols || this->arg.cols() == 1);
+        line_step = expanded() && this->arg.rows() == 1 ? 0 : 1;
+        k_step = expanded() && this->arg.cols() == 1 ? 0 : 1;
+    }
+
+    auto rows() const -> size_t {
+        return shape.first;
+    }
+
+    auto cols() const -> size_t {
+        return shape.second;
+    }
+
+    auto expanded() const -> bool {
+        return arg.rows() != rows() || arg.cols() != cols();
+    }
+
+    auto has_layout(Layout layout) const -> bool {
+        return arg.has_layout(layout) && (layout == Layout::RowMajor || !expanded());
+    }
+
+    auto flat(size_t line, size_t k) const -> double {
+        return arg.flat(line * line_step, k * k_step);
+    }
+
+    auto operator[](size_t i, size_t j) const -> double {
+        return arg[arg.rows() == 1 ? 0 : i, arg.cols() == 1 ? 0 : j];
+    }
+
+    auto target() -> Matrix* {
+        return expanded() ? nullptr : arg.target();
+    }
+};
+
+template <class M>
+inline constexpr bool is_matrix_expr<MatrixLeaf<M>> = true;
+
+template <class Op, class E>
+inline constexpr bool is_matrix_expr<MapExpr<Op, E>> = true;
+
+template <class Op, class L, class R>
+inline constexpr bool is_matrix_expr<ZipExpr<Op, L, R>> = true;
+
+template <class E>
+inline constexpr bool is_matrix_expr<BroadcastExpr<E>> = true;
+
+template <matrix_operand T>
+auto as_expr(T&& x) {
+    using U = std::remove_cvref_t<T>;
+    if constexpr (matrix_expr<T>) {
+        return U{std::forward<T>(x)};
+    } else if constexpr (std::is_lvalue_reference_v<T>) {
+        return MatrixLeaf<const U&>{x};
+    } else {
+        return MatrixLeaf<U>{std::move(x)};
+    }
+}
+
+#pragma region operators
+
+template <matrix_operand E>
+auto operator-(E&& arg) {
+    return MapExpr{std::negate<>{}, as_expr(std::forward<E>(arg))};
+}
+
+template <matrix_operand L, matrix_operand R>
+auto operator+(L&& lhs, R&& rhs) {
+    return ZipExpr{std::plus<>{}, as_expr(std::forward<L>(lhs)), as_expr(std::forward<R>(rhs))};
+}
+
+template <matrix_operand L, matrix_operand R>
+auto operator-(L&& lhs, R&& rhs) {
+    return ZipExpr{std::minus<>{}, as_expr(std::forward<L>(lhs)), as_expr(std::forward<R>(rhs))};
+}
+
+template <matrix_operand E>
+auto operator+(E&& lhs, double rhs) {
+    return MapExpr{[rhs](double x) { return x + rhs; }, as_expr(std::forward<E>(lhs))};
+}
+
+template <matrix_operand E>
+auto operator+(double lhs, E&& rhs) {
+    return MapExpr{[lhs](double x) { return lhs + x; }, as_expr(std::forward<E>(rhs))};
+}
+
+template <matrix_operand E>
+auto operator-(E&& lhs, double rhs) {
+    return MapExpr{[rhs](double x) { return x - rhs; }, as_expr(std::forward<E>(lhs))};
+}
+
+template <matrix_operand E>
+auto operator-(double lhs, E&& rhs) {
+    return MapExpr{[lhs](double x) { return lhs - x; }, as_expr(std::forward<E>(rhs))};
+}
+
+template <matrix_operand E>
+auto operator*(E&& lhs, double rhs) {
+    return MapExpr{[rhs](double x) { return x * rhs; }, as_expr(std::forward<E>(lhs))};
+}
+
+template <matrix_operand E>
+auto operator*(double lhs, E&& rhs) {
+    return MapExpr{[lhs](double x) { return lhs * x; }, as_expr(std::forward<E>(rhs))};
+}
+
+template <matrix_operand E>
+auto operator/(E&& lhs, double rhs) {
+    return MapExpr{[rhs](double x) { return x / rhs; }, as_expr(std::forward<E>(lhs))};
+}
+
+#pragma endregion operators
+
+// The shape that two operands of an elementwise operation broadcast to: each dimension has to match, or be 1 in one
+// of them. Returns nothing if the shapes are incompatible.
+inline auto broadcast_shape(std::pair<size_t, size_t> lhs, std::pair<size_t, size_t> rhs)
+    -> std::optional<std::pair<size_t, size_t>> {
+    const auto dim = [](size_t x, size_t y) -> std::optional<size_t> {
+        if (x == y || y == 1) {
+            return x;
+        }
+        if (x == 1) {
+            return y;
+        }
+        return std::nullopt;
+    };
+    const auto rows{dim(lhs.first, rhs.first)}, cols{dim(lhs.second, rhs.second)};
+    if (!rows || !cols) {
+        return std::nullopt;
+    }
+    return std::pair{*rows, *cols};
+}
+
+// Repeat an operand with a single row or column up to `rows x cols`, see BroadcastExpr.
+template <matrix_operand E>
+auto broadcast(E&& arg, size_t rows, size_t cols) {
+    return BroadcastExpr{as_expr(std::forward<E>(arg)), rows, cols};
+}
+
+} // namespace matoy::foundations
@@ -1,20 +1,30 @@
 #include "matrix_op.hpp"
+#include "cholesky.hpp"
+#include "fixed_matrix.hpp"
+#include "gemm.hpp"
+#include "lu.hpp"
+#include "refined_lu.hpp"
+#include "triangular.hpp"
 #include <cassert>
+#include <cmath>
+#include <functional>
+#include <utility>
 
 namespace matoy::foundations {
 
-static constexpr auto EPS = std::numeric_limits<Matrix::value_type>::epsilon();
+// From this size on, a single precision factorization with refinement beats the double one. Each right-hand side
+// costs a few refinement steps of O(n^2), so it only pays off for up to REFINED_SOLVE_COLUMNS of them per
+// REFINED_SOLVE_SIZE rows.
+static constexpr size_t REFINED_SOLVE_SIZE = 256;
+static constexpr size_t REFINED_SOLVE_COLUMNS = 8;
 
 auto concat_h(const Matrix& a, const Matrix& b) -> Matrix {
     assert(a.rows() == b.rows());
 
     const size_t n{a.rows()}, m1{a.cols()}, m2{b.cols()}, m{m1 + m2};
-    Matrix res = Matrix::zeros(n, m);
-
-    for (size_t i{}; i < n; i++) {
-        std::ranges::copy(a.data() + i * m1, a.data() + (i + 1) * m1, res.data() + i * m);
-        std::ranges::copy(b.data() + i * m2, b.data() + (i + 1) * m2, res.data() + i * m + m1);
-    }
+    Matrix res = Matrix::empty(n, m);
+    res.set_block(0, 0, a);
+    res.set_block(0, m1, b);
 
     return res;
 }
@@ -23,86 +33,215 @@ auto concat_v(const Matrix& a, const Matrix& b) -> Matrix {
     assert(a.cols() == b.cols());
 
     const size_t m{a.cols()}, n1{a.rows()}, n2{b.rows()}, n{n1 + n2};
-    Matrix res = Matrix::zeros(n, m);
-
-    std::ranges::copy(a.data(), a.data() + a.size(), res.data());
-    std::ranges::copy(b.data(), b.data() + b.size(), res.data() + n1 * m);
+    Matrix res = Matrix::empty(n, m);
+    res.set_block(0, 0, a);
+    res.set_block(n1, 0, b);
 
     return res;
 }
 
-auto det(Matrix mat) -> Matrix::value_type {
-    assert(mat.is_square());
-
-    size_t n = mat.rows();
-    Matrix::value_type res{1.0};
-
-    for (size_t i{}; i < n; i++) {
-        // find the row with the greatest first element
-        size_t k{i};
-        for (size_t j{i}; j < n; j++) {
-            if (std::abs(mat[j, i]) > std::abs(mat[k, i])) {
-                k = j;
+auto block_matrix(std::span<const std::vector<Matrix>> rows) -> std::optional<Matrix> {
+    if (rows.size() == 1 && rows[0].size() == 1) {
+        return rows[0][0];
+    }
+    size_t height{0}, width{0};
+    for (size_t r{0}; r < rows.size(); r++) {
+        size_t row_width{0};
+        for (const auto& block : rows[r]) {
+            if (block.rows() != rows[r][0].rows()) {
+                return std::nullopt;
             }
+            row_width += block.cols();
         }
-        if (std::abs(mat[k, i]) < EPS) {
-            return 0.0;
+        if (r > 0 && row_width != width) {
+            return std::nullopt;
         }
-        if (k != i) {
-            mat.swap_row(i, k);
-            res = -res;
+        width = row_width;
+        height += rows[r].empty() ? 0 : rows[r][0].rows();
+    }
+
+    auto res{Matrix::empty(height, width)};
+    size_t i{0};
+    for (const auto& row : rows) {
+        size_t j{0};
+        for (const auto& block : row) {
+            res.set_block(i, j, block);
+            j += block.cols();
         }
-        res *= mat[i, i];
-        mat.multiply_row(i, 1.0 / mat[i, i]);
-        for (size_t j{i + 1}; j < n; j++) {
-            if (std::abs(mat[j, i]) > EPS) {
-                mat.add_row_multiple(j, i, -mat[j, i]);
-            }
+        i += row.empty() ? 0 : row[0].rows();
+    }
+    return res;
+}
+
+template <class Op>
+static auto broadcast_zip(Op op, Matrix a, const Matrix& b) -> std::optional<Matrix> {
+    const auto shape{broadcast_shape(a.shape(), b.shape())};
+    if (!shape) {
+        return std::nullopt;
+    }
+    const auto [rows, cols] = *shape;
+    const ZipExpr expr{op, broadcast(a, rows, cols), broadcast(b, rows, cols)};
+    if (a.shape() == *shape) {
+        a = expr;
+        return a;
+    }
+    return Matrix(expr);
+}
+
+auto broadcast_add(Matrix a, const Matrix& b) -> std::optional<Matrix> {
+    return broadcast_zip(std::plus<>{}, std::move(a), b);
+}
+
+auto broadcast_sub(Matrix a, const Matrix& b) -> std::optional<Matrix> {
+    return broadcast_zip(std::minus<>{}, std::move(a), b);
+}
+
+auto broadcast_mul(Matrix a, const Matrix& b) -> std::optional<Matrix> {
+    return broadcast_zip(std::multiplies<>{}, std::move(a), b);
+}
+
+auto broadcast_div(Matrix a, const Matrix& b) -> std::optional<Matrix> {
+    return broadcast_zip(std::divides<>{}, std::move(a), b);
+}
+
+// Small matrices use the closed forms of FixedMatrix, which are cheaper than setting up an LU factorization.
+template <size_t N>
+static auto small_inverse(const Matrix& mat) -> std::optional<Matrix> {
+    return FixedMatrix<N>{mat}.inverse().transform([](const FixedMatrix<N>& inv) -> Matrix { return inv; });
+}
+
+// The triangle a matrix is zero outside of, if any.
+static auto triangle_of(const Matrix& mat) -> std::optional<Triangle> {
+    if (is_triangular(mat, Triangle::Lower)) {
+        return Triangle::Lower;
+    }
+    if (is_triangular(mat, Triangle::Upper)) {
+        return Triangle::Upper;
+    }
+    return std::nullopt;
+}
+
+// Symmetric matrices with a positive diagonal are worth trying Cholesky on, which fails early if they are not
+// positive definite after all. Both checks usually reject a general matrix within its first few rows.
+static auto try_cholesky(const Matrix& mat) -> std::optional<Cholesky> {
+    for (size_t i{}; i < mat.rows(); i++) {
+        if (!(mat[i, i] > 0.0)) {
+            return std::nullopt;
         }
     }
+    if (!is_symmetric(mat)) {
+        return std::nullopt;
+    }
+    Cholesky chol{mat};
+    if (!chol.is_positive_definite()) {
+        return std::nullopt;
+    }
+    return chol;
+}
 
-    return res;
+auto det(Matrix mat) -> Matrix::value_type {
+    assert(mat.is_square());
+    switch (mat.rows()) {
+    case 1:  return FixedMatrix<1>{mat}.det();
+    case 2:  return FixedMatrix<2>{mat}.det();
+    case 3:  return FixedMatrix<3>{mat}.det();
+    case 4:  return FixedMatrix<4>{mat}.det();
+    default: break;
+    }
+    if (triangle_of(mat)) {
+        Matrix::value_type res{1.0};
+        for (size_t i{}; i < mat.rows(); i++) {
+            res *= mat[i, i];
+        }
+        return res;
+    }
+    if (const auto chol{try_cholesky(mat)}) {
+        return chol->det();
+    }
+    return LU{std::move(mat)}.det();
 }
 
 auto inverse(const Matrix& mat) -> std::optional<Matrix> {
     assert(mat.is_square());
+    switch (mat.rows()) {
+    case 1:  return small_inverse<1>(mat);
+    case 2:  return small_inverse<2>(mat);
+    case 3:  return small_inverse<3>(mat);
+    case 4:  return small_inverse<4>(mat);
+    default: break;
+    }
+    if (const auto tri{triangle_of(mat)}) {
+        return solve_triangular(mat, Matrix::identity(mat.rows()), *tri);
+    }
+    if (const auto chol{try_cholesky(mat)}) {
+        return chol->inverse();
+    }
+    return LU{mat}.inverse();
+}
+
+auto solve(const Matrix& a, const Matrix& b) -> std::optional<Matrix> {
+    assert(a.is_square() && a.rows() == b.rows());
+    if (const auto tri{triangle_of(a)}) {
+        return solve_triangular(a, b, *tri);
+    }
+    if (const auto chol{try_cholesky(a)}) {
+        return chol->solve(b);
+    }
+    if (a.rows() >= REFINED_SOLVE_SIZE && b.cols() * REFINED_SOLVE_SIZE <= a.rows() * REFINED_SOLVE_COLUMNS) {
+        return RefinedLU{a}.solve(b);
+    }
+    return LU{a}.solve(b);
+}
 
+auto power(Matrix mat, int64_t k) -> std::optional<Matrix> {
+    assert(mat.is_square());
     const size_t n{mat.rows()};
-    Matrix a{concat_h(mat, Matrix::identity(n))};
-
-    for (size_t i{}; i < n; i++) {
-        // find the row with the greatest first element
-        size_t k{i};
-        for (size_t j{i}; j < n; j++) {
-            if (std::abs(a[j, i]) > std::abs(a[k, i])) {
-                k = j;
+    // a diagonal matrix is raised elementwise without pivoting, so only a zero element has no negative power
+    if (is_triangular(mat, Triangle::Lower) && is_triangular(mat, Triangle::Upper)) {
+        for (size_t i{}; i < n; i++) {
+            if (k < 0 && mat[i, i] == 0.0) {
+                return std::nullopt;
             }
+            mat[i, i] = std::pow(mat[i, i], static_cast<double>(k));
         }
-        if (std::abs(a[k, i]) < EPS) {
+        return mat;
+    }
+    if (k == 0) {
+        return Matrix::identity(n);
+    }
+    if (k < 0) {
+        auto inv{inverse(mat)};
+        if (!inv) {
             return std::nullopt;
         }
-        if (k != i) {
-            a.swap_row(i, k);
-        }
-        a.multiply_row(i, 1.0 / a[i, i]);
-        for (size_t j{i + 1}; j < n; j++) {
-            if (std::abs(a[j, i]) > EPS) {
-                a.add_row_multiple(j, i, -a[j, i]);
+        mat = std::move(*inv);
+    }
+    auto e{k < 0 ? -static_cast<uint64_t>(k) : static_cast<uint64_t>(k)};
+
+    // base holds mat^(2^i) and acc the product of the powers for the bits seen so far. Each product is written
+    // into the spare buffer, which then swaps places with its left operand.
+    Matrix base{std::move(mat)};
+    base.unshare();
+    auto spare{Matrix::empty(n, n)};
+    std::optional<Matrix> acc;
+    while (true) {
+        if (e & 1) {
+            if (!acc) {
+                acc = base;
+                acc->unshare();
+            } else {
+                gemm(1.0, std::as_const(*acc).view(), std::as_const(base).view(), 0.0, spare.view());
+                std::swap(*acc, spare);
             }
         }
-    }
-    for (size_t i{n - 1}; ~i; i--) {
-        for (size_t k{0}; k < i; k++) {
-            a.add_row_multiple(k, i, -a[k, i]);
+        e >>= 1;
+        if (e == 0) {
+            break;
         }
+        gemm(1.0, std::as_const(base).view(), std::as_const(base).view(), 0.0, spare.view());
+        std::swap(base, spare);
     }
-
-    // get the left part
-    Matrix res = Matrix::zeros(n, n);
-    for (size_t i{}; i < n; i++) {
-        std::copy(a.data() + i * (n * 2) + n, a.data() + (i + 1) * (n * 2), res.data() + i * n);
-    }
-    return res;
+    return acc;
 }
 
 } // namespace matoy::foundations
@@ -1,7 +1,10 @@
 #pragma once
 
 #include "matrix.hpp"
+#include <cstdint>
 #include <optional>
+#include <span>
+#include <vector>
 
 namespace matoy::foundations {
 
@@ -9,8 +12,39 @@ auto concat_h(const Matrix& a, const Matrix& b) -> Matrix;
 
 auto concat_v(const Matrix& a, const Matrix& b) -> Matrix;
 
+// A matrix from rows of blocks, like the literal `[A, B; C, D]`: the blocks of a row have the same number of rows,
+// and the rows add up to the same number of columns. The result is allocated once and each block is copied into
+// place a row at a time. Returns nothing if the blocks don't fit together.
+auto block_matrix(std::span<const std::vector<Matrix>> rows) -> std::optional<Matrix>;
+
+// Elementwise operations that broadcast operands with a single row or column across the other one, NumPy style, so
+// that `broadcast_mul(a, v)` scales the columns of `a` by a row vector `v` without expanding it, see
+// `broadcast_shape`. The result is evaluated into `a` when it already has the full shape.
+// Returns nothing if the shapes are incompatible.
+
+auto broadcast_add(Matrix a, const Matrix& b) -> std::optional<Matrix>;
+
+auto broadcast_sub(Matrix a, const Matrix& b) -> std::optional<Matrix>;
+
+auto broadcast_mul(Matrix a, const Matrix& b) -> std::optional<Matrix>;
+
+auto broadcast_div(Matrix a, const Matrix& b) -> std::optional<Matrix>;
+
+// The solvers below pick a method from the structure of the matrix: closed forms up to 4 x 4, substitution for
+// triangular matrices, Cholesky for symmetric positive definite ones and LU with partial pivoting otherwise.
+// Large systems with few right-hand sides are solved by a single precision LU with iterative refinement, see
+// RefinedLU, which reaches the same accuracy.
+
 auto det(Matrix mat) -> Matrix::value_type;
 
 auto inverse(const Matrix& mat) -> std::optional<Matrix>;
 
+// Solve a * x = b for a square `a`, without forming its inverse.
+auto solve(const Matrix& a, const Matrix& b) -> std::optional<Matrix>;
+
+// The k-th power of a square matrix, by repeated squaring in three buffers regardless of k. Diagonal matrices
+// (including the identity) raise their diagonal instead. Negative powers are powers of the inverse.
+// Returns nothing for negative powers of a singular matrix.
+auto power(Matrix mat, int64_t k) -> std::optional<Matrix>;
+
 } // namespace matoy::foundations
@@ -0,0 +1,147 @@
+#include "parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace matoy::foundations {
+
+namespace {
+
+// Set on worker threads, and on the calling thread while it takes part in a job.
+thread_local bool in_parallel_region{false};
+
+auto default_num_threads() -> size_t {
+    if (const char* env = std::getenv("MATOY_NUM_THREADS")) {
+        size_t n{};
+        auto [ptr, ec] = std::from_chars(env, env + std::strlen(env), n);
+        if (ec == std::errc{} && n > 0) {
+            return n;
+        }
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+class ThreadPool {
+  public:
+    explicit ThreadPool(size_t threads) {
+        for (size_t i{1}; i < threads; i++) {
+            workers.emplace_back([this](std::stop_token stop) { work(stop); });
+        }
+    }
+
+    auto size() const -> size_t {
+        return workers.size() + 1;
+    }
+
+    // Returns false without running anything if another thread is using the pool.
+    auto run(size_t n, const std::function<void(size_t)>& f) -> bool {
+        std::unique_lock submit{submit_mutex, std::try_to_lock};
+        if (!submit) {
+            return false;
+        }
+
+        Job job{&f, n};
+        {
+            std::lock_guard lock{mutex};
+            current = &job;
+            generation++;
+        }
+        wake.notify_all();
+
+        in_parallel_region = true;
+        job.work();
+        in_parallel_region = false;
+
+        std::unique_lock lock{mutex};
+        current = nullptr;
+        finished.wait(lock, [&job] { return job.active == 0; });
+        return true;
+    }
+
+  private:
+    struct Job {
+        const std::function<void(size_t)>* f;
+        size_t n;
+        std::atomic<size_t> next{0};
+        size_t active{0}; // workers inside `work`, guarded by the pool mutex
+
+        void work() {
+            for (size_t i = next++; i < n; i = next++) {
+                (*f)(i);
+            }
+        }
+    };
+
+    void work(std::stop_token stop) {
+        in_parallel_region = true;
+        size_t seen{0};
+        std::unique_lock lock{mutex};
+        while (wake.wait(lock, stop, [&] { return generation != seen; })) {
+            seen = generation;
+            Job* job{current};
+            if (!job) {
+                continue;
+            }
+            job->active++;
+            lock.unlock();
+            job->work();
+            lock.lock();
+            if (--job->active == 0) {
+                finished.notify_all();
+            }
+        }
+    }
+
+    std::mutex submit_mutex;
+    std::mutex mutex;
+    std::condition_variable_any wake;
+    std::condition_variable finished;
+    Job* current{nullptr};
+    size_t generation{0};
+    // Declared last so that the workers are stopped and joined before anything they use is destroyed.
+    std::vector<std::jthread> workers;
+};
+
+std::mutex pool_mutex;
+std::unique_ptr<ThreadPool> pool;
+
+auto get_pool() -> ThreadPool& {
+    std::lock_guard lock{pool_mutex};
+    if (!pool) {
+        pool = std::make_unique<ThreadPool>(default_num_threads());
+    }
+    return *pool;
+}
+
+} // namespace
+
+auto num_threads() -> size_t {
+    return get_pool().size();
+}
+
+void set_num_threads(size_t n) {
+    std::lock_guard lock{pool_mutex};
+    pool.reset();
+    pool = std::make_unique<ThreadPool>(n == 0 ? default_num_threads() : n);
+}
+
+void parallel_for(size_t n, const std::function<void(size_t)>& f) {
+    if (n > 1 && !in_parallel_region) {
+        auto& p = get_pool();
+        if (p.size() > 1 && p.run(n, f)) {
+            return;
+        }
+    }
+    for (size_t i{0}; i < n; i++) {
+        f(i);
+    }
+}
+
+} // namespace matoy::foundations
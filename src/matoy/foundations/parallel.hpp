@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace matoy::foundations {
+
+// Number of threads used by parallel kernels, including the calling thread.
+// Defaults to the `MATOY_NUM_THREADS` environment variable, or to the hardware concurrency if it is unset.
+auto num_threads() -> size_t;
+
+// Change the number of threads used by parallel kernels. Zero restores the default.
+// Must not be called while a parallel kernel is running.
+void set_num_threads(size_t n);
+
+// Call `f(0)`, ..., `f(n - 1)` on the worker threads, with the calling thread taking part.
+// Nested calls, and calls made while the workers are busy, run serially on the calling thread.
+// `f` must not throw.
+void parallel_for(size_t n, const std::function<void(size_t)>& f);
+
+} // namespace matoy::foundations
@@ -0,0 +1,272 @@
+#include "qr.hpp"
+#include "gemm.hpp"
+#include "parallel.hpp"
+#include "triangular.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace matoy::foundations {
+
+static constexpr auto EPS = std::numeric_limits<Matrix::value_type>::epsilon();
+
+// TSQR is used up to this many columns (of A and B together), with chunks of about this many elements.
+static constexpr size_t TSQR_MAX_COLS = 64;
+static constexpr size_t TSQR_CHUNK_ELEMENTS = size_t{1} << 15;
+// Chunks are short, so narrower panels move more of their factorization into matrix products.
+static constexpr size_t TSQR_BLOCK_SIZE = 16;
+
+// The top-left rows x cols block of a matrix.
+static auto leading_block(const Matrix& mat, size_t rows, size_t cols) -> Matrix {
+    auto res{Matrix::empty(rows, cols)};
+    for (size_t i{0}; i < rows; i++) {
+        for (size_t j{0}; j < cols; j++) {
+            res[i, j] = mat[i, j];
+        }
+    }
+    return res;
+}
+
+// Whether the first n diagonal elements of R are all far enough from zero to solve with.
+static auto has_full_rank(const Matrix& r, size_t n, size_t m) -> bool {
+    Matrix::value_type largest{0.0};
+    for (size_t i{0}; i < n; i++) {
+        largest = std::max(largest, std::abs(r[i, i]));
+    }
+    const Matrix::value_type tol{EPS * largest * static_cast<double>(std::max(m, n))};
+    for (size_t i{0}; i < n; i++) {
+        if (!(std::abs(r[i, i]) > tol)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QR::QR(Matrix mat, size_t block_size) : qr_{std::move(mat)}, block_size_{block_size} {
+    assert(block_size > 0);
+    qr_.set_layout(Layout::RowMajor);
+    if (qr_.cols() > block_size) {
+        qr_.set_leading_dim(Matrix::padded_leading_dim(qr_.cols()));
+    }
+
+    const size_t m{qr_.rows()}, n{qr_.cols()}, k{std::min(m, n)};
+    tau_.resize(k);
+    auto a{qr_.view()};
+    std::vector<value_type> w(std::min(block_size, n));
+
+    for (size_t k0{0}; k0 < k; k0 += block_size) {
+        const size_t k1{std::min(k0 + block_size, k)}, panel_end{std::min(k0 + block_size, n)};
+
+        // factorize the panel column by column, applying each reflector to the rest of the panel only
+        for (size_t j{k0}; j < k1; j++) {
+            value_type norm2{0.0};
+            for (size_t i{j + 1}; i < m; i++) {
+                norm2 += a[i, j] * a[i, j];
+            }
+            const value_type alpha{a[j, j]};
+            if (norm2 == 0.0) {
+                tau_[j] = 0.0; // already zero below the diagonal, H = I
+                continue;
+            }
+            const value_type beta{-std::copysign(std::sqrt(alpha * alpha + norm2), alpha)};
+            tau_[j] = (beta - alpha) / beta;
+            const value_type scale{1.0 / (alpha - beta)};
+            for (size_t i{j + 1}; i < m; i++) {
+                a[i, j] *= scale;
+            }
+            a[j, j] = beta;
+
+            // A[j:, j+1:panel_end] -= tau * v * (v^T * A[j:, j+1:panel_end]), with v[j] = 1
+            const size_t len{panel_end - j - 1};
+            if (len == 0) {
+                continue;
+            }
+            std::copy_n(&a[j, j + 1], len, w.begin());
+            for (size_t i{j + 1}; i < m; i++) {
+                const value_type vi{a[i, j]};
+                const value_type* row{&a[i, j + 1]};
+                for (size_t c{0}; c < len; c++) {
+                    w[c] += vi * row[c];
+                }
+            }
+            for (size_t c{0}; c < len; c++) {
+                w[c] *= tau_[j];
+                a[j, j + 1 + c] -= w[c];
+            }
+            for (size_t i{j + 1}; i < m; i++) {
+                const value_type vi{a[i, j]};
+                value_type* row{&a[i, j + 1]};
+                for (size_t c{0}; c < len; c++) {
+                    row[c] -= vi * w[c];
+                }
+            }
+        }
+
+        // T is upper triangular with T[j, j] = tau_j and T[0:j, j] = -tau_j * T[0:j, 0:j] * (V^T * v_j)
+        const size_t nb{k1 - k0};
+        const Matrix v{reflectors(t_.size())};
+        auto gram{Matrix::empty(nb, nb)};
+        gemm(1.0, v.transposed().view(), v.view(), 0.0, gram.view());
+        auto t{Matrix::zeros(nb, nb)};
+        for (size_t j{0}; j < nb; j++) {
+            t[j, j] = tau_[k0 + j];
+            for (size_t i{0}; i < j; i++) {
+                value_type sum{0.0};
+                for (size_t p{i}; p < j; p++) {
+                    sum += t[i, p] * gram[p, j];
+                }
+                t[i, j] = -tau_[k0 + j] * sum;
+            }
+        }
+        t_.push_back(std::move(t));
+
+        // A[k0:, panel_end:] = (I - V * T^T * V^T) * A[k0:, panel_end:]
+        if (panel_end < n) {
+            double* base{qr_.data()};
+            const size_t ld{qr_.leading_dim()}, cols{n - panel_end};
+            auto vta{Matrix::empty(nb, cols)};
+            gemm(1.0, v.transposed().view(), strided<const double>(base + k0 * ld + panel_end, m - k0, cols, ld, 1),
+                 0.0, vta.view());
+            const Matrix& tt{t_.back()};
+            for (size_t i{nb - 1}; ~i; i--) {
+                vta.multiply_row(i, tt[i, i]);
+                for (size_t p{0}; p < i; p++) {
+                    vta.add_row_multiple(i, p, tt[p, i]);
+                }
+            }
+            gemm(-1.0, v.view(), vta.view(), 1.0, strided(base + k0 * ld + panel_end, m - k0, cols, ld, 1));
+        }
+    }
+}
+
+auto QR::reflectors(size_t p) const -> Matrix {
+    const size_t k0{p * block_size_}, k1{std::min(k0 + block_size_, tau_.size())}, m{qr_.rows()};
+    auto v{Matrix::zeros(m - k0, k1 - k0)};
+    for (size_t i{0}; i < m - k0; i++) {
+        for (size_t j{0}; j < std::min(i + 1, k1 - k0); j++) {
+            v[i, j] = i == j ? 1.0 : qr_[k0 + i, k0 + j];
+        }
+    }
+    return v;
+}
+
+void QR::apply_panel(size_t p, Matrix& c, bool transpose) const {
+    const size_t k0{p * block_size_}, m{qr_.rows()}, cols{c.cols()};
+    const Matrix v{reflectors(p)};
+    const Matrix& t{t_[p]};
+    const size_t nb{v.cols()};
+
+    double* base{c.data()};
+    const size_t ld{c.leading_dim()};
+    auto w{Matrix::empty(nb, cols)};
+    gemm(1.0, v.transposed().view(), strided<const double>(base + k0 * ld, m - k0, cols, ld, 1), 0.0, w.view());
+    // W = T^T * W from the last row up, or T * W from the first row down, so each row reads unchanged ones
+    if (transpose) {
+        for (size_t i{nb - 1}; ~i; i--) {
+            w.multiply_row(i, t[i, i]);
+            for (size_t q{0}; q < i; q++) {
+                w.add_row_multiple(i, q, t[q, i]);
+            }
+        }
+    } else {
+        for (size_t i{0}; i < nb; i++) {
+            w.multiply_row(i, t[i, i]);
+            for (size_t q{i + 1}; q < nb; q++) {
+                w.add_row_multiple(i, q, t[i, q]);
+            }
+        }
+    }
+    gemm(-1.0, v.view(), w.view(), 1.0, strided(base + k0 * ld, m - k0, cols, ld, 1));
+}
+
+auto QR::is_rank_deficient() const -> bool {
+    return !has_full_rank(qr_, tau_.size(), qr_.rows());
+}
+
+auto QR::r() const -> Matrix {
+    const size_t k{tau_.size()};
+    auto res{Matrix::zeros(k, qr_.cols())};
+    for (size_t i{0}; i < k; i++) {
+        for (size_t j{i}; j < qr_.cols(); j++) {
+            res[i, j] = qr_[i, j];
+        }
+    }
+    return res;
+}
+
+auto QR::q() const -> Matrix {
+    auto res{Matrix::zeros(qr_.rows(), tau_.size())};
+    for (size_t i{0}; i < tau_.size(); i++) {
+        res[i, i] = 1.0;
+    }
+    return apply_q(std::move(res));
+}
+
+auto QR::apply_qt(Matrix b) const -> Matrix {
+    assert(b.rows() == qr_.rows());
+    b.set_layout(Layout::RowMajor);
+    for (size_t p{0}; p < t_.size(); p++) {
+        apply_panel(p, b, true);
+    }
+    return b;
+}
+
+auto QR::apply_q(Matrix b) const -> Matrix {
+    assert(b.rows() == qr_.rows());
+    b.set_layout(Layout::RowMajor);
+    for (size_t p{t_.size() - 1}; ~p; p--) {
+        apply_panel(p, b, false);
+    }
+    return b;
+}
+
+auto QR::solve(const Matrix& b) const -> std::optional<Matrix> {
+    assert(rows() >= cols() && b.rows() == rows());
+    if (is_rank_deficient()) {
+        return std::nullopt;
+    }
+    const size_t n{cols()};
+    return solve_triangular(leading_block(qr_, n, n), leading_block(apply_qt(b), n, b.cols()), Triangle::Upper);
+}
+
+auto lstsq(const Matrix& a, const Matrix& b) -> std::optional<Matrix> {
+    assert(a.rows() >= a.cols() && a.rows() == b.rows());
+    const size_t m{a.rows()}, n{a.cols()}, width{n + b.cols()};
+    const size_t chunk{std::max(4 * width, TSQR_CHUNK_ELEMENTS / std::max<size_t>(width, 1))};
+    const size_t chunks{(m + chunk - 1) / chunk};
+    if (width > TSQR_MAX_COLS || chunks < 2) {
+        return QR{a}.solve(b);
+    }
+
+    // the R of each chunk of [A, B], stacked. The last chunk may contribute fewer rows, which stay zero.
+    auto stacked{Matrix::zeros(chunks * width, width)};
+    parallel_for(chunks, [&](size_t t) {
+        const size_t r0{t * chunk}, r1{std::min(r0 + chunk, m)};
+        auto part{Matrix::empty(r1 - r0, width)};
+        for (size_t i{r0}; i < r1; i++) {
+            for (size_t j{0}; j < n; j++) {
+                part[i - r0, j] = a[i, j];
+            }
+            for (size_t j{0}; j < b.cols(); j++) {
+                part[i - r0, n + j] = b[i, j];
+            }
+        }
+        stacked.set_block(t * width, 0, QR{std::move(part), TSQR_BLOCK_SIZE}.r());
+    });
+
+    // R of [A, B] is [R, Q^T * B; 0, *], so the solution needs no further products
+    const Matrix r{QR{std::move(stacked)}.r()};
+    if (!has_full_rank(r, n, m)) {
+        return std::nullopt;
+    }
+    auto qtb{Matrix::empty(n, b.cols())};
+    for (size_t i{0}; i < n; i++) {
+        for (size_t j{0}; j < b.cols(); j++) {
+            qtb[i, j] = r[i, n + j];
+        }
+    }
+    return solve_triangular(leading_block(r, n, n), qtb, Triangle::Upper);
+}
+
+} // namespace matoy::foundations
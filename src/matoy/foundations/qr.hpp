@@ -0,0 +1,71 @@
+#pragma once
+
+#include "matrix.hpp"
+#include <optional>
+#include <vector>
+
+namespace matoy::foundations {
+
+// Householder QR factorization of an m x n matrix: A = Q * R, with Q orthogonal and R upper triangular.
+// The reflectors are packed below the diagonal of R, LAPACK style, and Q is only formed on request.
+//
+// Columns are factorized in panels of `block_size`. The reflectors of a panel are combined into the compact WY
+// form I - V * T * V^T, so applying them to the trailing columns (or to a right-hand side) takes three matrix
+// products instead of one rank-1 update per column.
+class QR {
+  public:
+    using value_type = Matrix::value_type;
+
+    static constexpr size_t default_block_size = 32;
+
+    explicit QR(Matrix mat, size_t block_size = default_block_size);
+
+    auto rows() const -> size_t {
+        return qr_.rows();
+    }
+
+    auto cols() const -> size_t {
+        return qr_.cols();
+    }
+
+    // Whether a diagonal element of R is negligible next to the largest one, so that least-squares solutions
+    // are not unique.
+    auto is_rank_deficient() const -> bool;
+
+    // The upper triangular min(m, n) x n factor.
+    auto r() const -> Matrix;
+
+    // The first min(m, n) columns of Q, an orthonormal basis of the column space for full-rank A.
+    auto q() const -> Matrix;
+
+    // Q^T * B and Q * B for B with m rows.
+    auto apply_qt(Matrix b) const -> Matrix;
+
+    auto apply_q(Matrix b) const -> Matrix;
+
+    // The X minimizing ||A * X - B|| for m >= n, by back substitution on R * X = (Q^T * B)[0:n].
+    // Returns nothing if A is rank deficient.
+    auto solve(const Matrix& b) const -> std::optional<Matrix>;
+
+  private:
+    // The reflectors of panel p as an explicit matrix with a unit diagonal and zeros above it.
+    auto reflectors(size_t p) const -> Matrix;
+
+    // C = (I - V * T * V^T) * C, or with T^T if `transpose`, for the rows of C from the first row of panel p.
+    void apply_panel(size_t p, Matrix& c, bool transpose) const;
+
+  private:
+    Matrix qr_;
+    std::vector<value_type> tau_;
+    std::vector<Matrix> t_; // the T of each panel
+    size_t block_size_;
+};
+
+// Least-squares solution of A * X = B for m >= n. Returns nothing if A is rank deficient.
+//
+// Tall and skinny inputs are factorized as a tree (TSQR): chunks of rows, sized to stay in cache, are reduced
+// to their R factors in parallel, and the stacked R factors get a final small QR. B is carried along as extra
+// columns, so Q is never applied separately.
+auto lstsq(const Matrix& a, const Matrix& b) -> std::optional<Matrix>;
+
+} // namespace matoy::foundations
@@ -0,0 +1,363 @@
+#include "reduce.hpp"
+#include "avx2.hpp"
+#include "cpu.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace matoy::foundations {
+
+static constexpr auto EPS = std::numeric_limits<Matrix::value_type>::epsilon();
+
+// The leaves of the pairwise summation: elements summed in one pass of a kernel, and lines added into one row of
+// partial sums.
+static constexpr size_t PAIRWISE_BLOCK = 128;
+static constexpr size_t PAIRWISE_LINES = 32;
+
+// Elements per task when a reduction is split across threads. The split only depends on the shape, so the result
+// is the same for any number of threads.
+static constexpr size_t PARALLEL_CHUNK = 1 << 15;
+
+// Lines combined in parallel go through at most this many rows of partial results.
+static constexpr size_t MAX_PARTIALS = 64;
+
+namespace {
+
+// Each element is mapped, then combined with the running value, starting from the identity of the combination.
+// Min and max propagate NaN like the sums do, so the result doesn't depend on the kernel or the order.
+enum class Fold { Sum, SumAbs, SumSquares, Min, Max, MaxAbs };
+
+// How the partial results of a fold are combined with each other.
+template <Fold F>
+constexpr Fold merge_of = F == Fold::SumAbs || F == Fold::SumSquares ? Fold::Sum
+                          : F == Fold::MaxAbs                        ? Fold::Max
+                                                                     : F;
+
+template <Fold F>
+constexpr auto identity() -> double {
+    if constexpr (F == Fold::Min) {
+        return std::numeric_limits<double>::infinity();
+    } else if constexpr (F == Fold::Max) {
+        return -std::numeric_limits<double>::infinity();
+    } else {
+        return 0.0;
+    }
+}
+
+template <Fold F>
+auto map(double x) -> double {
+    if constexpr (F == Fold::SumAbs || F == Fold::MaxAbs) {
+        return std::abs(x);
+    } else if constexpr (F == Fold::SumSquares) {
+        return x * x;
+    } else {
+        return x;
+    }
+}
+
+template <Fold F>
+auto combine(double x, double y) -> double {
+    if constexpr (F == Fold::Min) {
+        return x < y || std::isnan(x) ? x : y;
+    } else if constexpr (F == Fold::Max || F == Fold::MaxAbs) {
+        return x > y || std::isnan(x) ? x : y;
+    } else {
+        return x + y;
+    }
+}
+
+struct Kernels {
+    // the fold of x[0..n), indexed by Fold
+    double (*fold[6])(const double*, size_t);
+    // acc[i] = combine(acc[i], map(x[i])) for i < n, indexed by Fold
+    void (*accumulate[6])(double*, const double*, size_t);
+};
+
+template <Fold F>
+auto fold_generic(const double* x, size_t n) -> double {
+    double acc{identity<F>()};
+    for (size_t i{0}; i < n; i++) {
+        acc = combine<F>(acc, map<F>(x[i]));
+    }
+    return acc;
+}
+
+template <Fold F>
+void accumulate_generic(double* acc, const double* x, size_t n) {
+    for (size_t i{0}; i < n; i++) {
+        acc[i] = combine<F>(acc[i], map<F>(x[i]));
+    }
+}
+
+#ifdef MATOY_X86_DISPATCH
+
+using V = avx2::Vec<double>;
+
+template <Fold F>
+[[gnu::target("avx2,fma"), gnu::always_inline]] inline auto map(V::reg x) -> V::reg {
+    if constexpr (F == Fold::SumAbs || F == Fold::MaxAbs) {
+        return V::abs(x);
+    } else if constexpr (F == Fold::SumSquares) {
+        return V::mul(x, x);
+    } else {
+        return x;
+    }
+}
+
+template <Fold F>
+[[gnu::target("avx2,fma"), gnu::always_inline]] inline auto combine(V::reg x, V::reg y) -> V::reg {
+    // vminpd and vmaxpd return y if either operand is NaN, so a NaN in x is put back
+    if constexpr (F == Fold::Min) {
+        return V::select(V::is_nan(x), x, V::min(x, y));
+    } else if constexpr (F == Fold::Max || F == Fold::MaxAbs) {
+        return V::select(V::is_nan(x), x, V::max(x, y));
+    } else {
+        return V::add(x, y);
+    }
+}
+
+// Two registers in independent chains, like the kernels in simd.cpp, then the lanes and the scalar tail.
+template <Fold F>
+[[gnu::target("avx2,fma")]] auto fold_avx2(const double* x, size_t n) -> double {
+    constexpr size_t w{V::lanes};
+    auto a0{V::set1(identity<F>())}, a1{a0};
+    size_t i{0};
+    for (; i + 2 * w <= n; i += 2 * w) {
+        a0 = combine<F>(a0, map<F>(V::load(x + i)));
+        a1 = combine<F>(a1, map<F>(V::load(x + i + w)));
+    }
+    double lanes[w];
+    V::store(lanes, combine<F>(a0, a1));
+    double acc{identity<F>()};
+    for (double y : lanes) {
+        acc = combine<F>(acc, y);
+    }
+    for (; i < n; i++) {
+        acc = combine<F>(acc, map<F>(x[i]));
+    }
+    return acc;
+}
+
+template <Fold F>
+[[gnu::target("avx2,fma")]] void accumulate_avx2(double* acc, const double* x, size_t n) {
+    constexpr size_t w{V::lanes};
+    size_t i{0};
+    for (; i + 2 * w <= n; i += 2 * w) {
+        V::store(acc + i, combine<F>(V::load(acc + i), map<F>(V::load(x + i))));
+        V::store(acc + i + w, combine<F>(V::load(acc + i + w), map<F>(V::load(x + i + w))));
+    }
+    for (; i < n; i++) {
+        acc[i] = combine<F>(acc[i], map<F>(x[i]));
+    }
+}
+
+#endif
+
+auto select_kernels() -> Kernels {
+#ifdef MATOY_X86_DISPATCH
+    if (cpu::has_avx2_fma()) {
+        return {{fold_avx2<Fold::Sum>, fold_avx2<Fold::SumAbs>, fold_avx2<Fold::SumSquares>, fold_avx2<Fold::Min>,
+                 fold_avx2<Fold::Max>, fold_avx2<Fold::MaxAbs>},
+                {accumulate_avx2<Fold::Sum>, accumulate_avx2<Fold::SumAbs>, accumulate_avx2<Fold::SumSquares>,
+                 accumulate_avx2<Fold::Min>, accumulate_avx2<Fold::Max>, accumulate_avx2<Fold::MaxAbs>}};
+    }
+#endif
+    return {{fold_generic<Fold::Sum>, fold_generic<Fold::SumAbs>, fold_generic<Fold::SumSquares>,
+             fold_generic<Fold::Min>, fold_generic<Fold::Max>, fold_generic<Fold::MaxAbs>},
+            {accumulate_generic<Fold::Sum>, accumulate_generic<Fold::SumAbs>, accumulate_generic<Fold::SumSquares>,
+             accumulate_generic<Fold::Min>, accumulate_generic<Fold::Max>, accumulate_generic<Fold::MaxAbs>}};
+}
+
+auto kernels() -> const Kernels& {
+    static const Kernels value{select_kernels()};
+    return value;
+}
+
+// The fold of x[0..n), halving down to blocks of PAIRWISE_BLOCK elements.
+template <Fold F>
+auto fold_pairwise(const double* x, size_t n) -> double {
+    if (n <= PAIRWISE_BLOCK) {
+        return kernels().fold[static_cast<size_t>(F)](x, n);
+    }
+    const size_t half{(n / 2 + PAIRWISE_BLOCK - 1) / PAIRWISE_BLOCK * PAIRWISE_BLOCK};
+    return combine<merge_of<F>>(fold_pairwise<F>(x, half), fold_pairwise<F>(x + half, n - half));
+}
+
+// Like fold_pairwise, with chunks of PARALLEL_CHUNK elements on the worker threads.
+template <Fold F>
+auto fold_parallel(const double* x, size_t n) -> double {
+    if (n <= PARALLEL_CHUNK) {
+        return fold_pairwise<F>(x, n);
+    }
+    const size_t chunks{(n + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK};
+    std::vector<double> partial(chunks);
+    parallel_for(chunks, [&](size_t t) {
+        const size_t k{t * PARALLEL_CHUNK};
+        partial[t] = fold_pairwise<F>(x + k, std::min(PARALLEL_CHUNK, n - k));
+    });
+    return fold_pairwise<merge_of<F>>(partial.data(), chunks);
+}
+
+// Combine acc[0..len) with the lines [l0, l1) of a buffer with leading dimension ld, elementwise. Sums halve the
+// lines down to PAIRWISE_LINES of them, min and max are exact in any order.
+template <Fold F>
+void accumulate_lines(const double* data, size_t ld, size_t l0, size_t l1, size_t len, double* acc) {
+    const auto kernel{kernels().accumulate[static_cast<size_t>(F)]};
+    if (merge_of<F> != Fold::Sum || l1 - l0 <= PAIRWISE_LINES) {
+        for (size_t l{l0}; l < l1; l++) {
+            kernel(acc, data + l * ld, len);
+        }
+        return;
+    }
+    const size_t mid{l0 + (l1 - l0) / 2};
+    accumulate_lines<F>(data, ld, l0, mid, len, acc);
+    std::vector<double> rest(len, identity<F>());
+    accumulate_lines<F>(data, ld, mid, l1, len, rest.data());
+    kernels().accumulate[static_cast<size_t>(Fold::Sum)](acc, rest.data(), len);
+}
+
+// out[0..len) = the elementwise fold of `lines` lines of `len` elements.
+template <Fold F>
+void fold_lines(const double* data, size_t ld, size_t lines, size_t len, double* out) {
+    std::fill(out, out + len, identity<F>());
+    const size_t group{std::max({PAIRWISE_LINES, std::bit_ceil((PARALLEL_CHUNK + len - 1) / std::max<size_t>(len, 1)),
+                                 std::bit_ceil((lines + MAX_PARTIALS - 1) / MAX_PARTIALS)})};
+    if (lines > group) {
+        // groups of lines into rows of partial results, which are then combined in turn
+        const size_t groups{(lines + group - 1) / group};
+        std::vector<double> partial(groups * len, identity<F>());
+        parallel_for(groups, [&](size_t t) {
+            accumulate_lines<F>(data, ld, t * group, std::min(lines, (t + 1) * group), len, partial.data() + t * len);
+        });
+        accumulate_lines<merge_of<F>>(partial.data(), len, 0, groups, len, out);
+        return;
+    }
+    // few long lines: split the elements instead, which leaves the order of the additions alone
+    const size_t tasks{(lines * len + PARALLEL_CHUNK - 1) / PARALLEL_CHUNK};
+    const size_t width{std::max<size_t>(64, (len + tasks - 1) / std::max<size_t>(tasks, 1))};
+    parallel_for((len + width - 1) / width, [&](size_t t) {
+        const size_t k{t * width};
+        accumulate_lines<F>(data + k, ld, 0, lines, std::min(width, len - k), out + k);
+    });
+}
+
+// out[l] = the fold of line l, for each of `lines` lines of `len` elements.
+template <Fold F>
+void fold_each_line(const double* data, size_t ld, size_t lines, size_t len, double* out) {
+    const size_t step{std::max<size_t>(1, PARALLEL_CHUNK / std::max<size_t>(len, 1))};
+    parallel_for((lines + step - 1) / step, [&](size_t t) {
+        for (size_t l{t * step}; l < std::min(lines, (t + 1) * step); l++) {
+            out[l] = fold_pairwise<F>(data + l * ld, len);
+        }
+    });
+}
+
+// A matrix as `lines` rows (row-major) or columns (column-major) of `len` elements, see Matrix::leading_dim().
+struct Lines {
+    const double* data;
+    size_t ld, lines, len;
+};
+
+auto lines_of(const Matrix& a) -> Lines {
+    const bool row_major{a.layout() == Layout::RowMajor};
+    return {a.data(), a.leading_dim(), row_major ? a.rows() : a.cols(), row_major ? a.cols() : a.rows()};
+}
+
+template <Fold F>
+auto fold_all(const Matrix& a) -> double {
+    const auto [data, ld, lines, len] = lines_of(a);
+    if (a.is_contiguous()) {
+        return fold_parallel<F>(data, lines * len);
+    }
+    std::vector<double> acc(len);
+    fold_lines<F>(data, ld, lines, len, acc.data());
+    return fold_pairwise<merge_of<F>>(acc.data(), len);
+}
+
+template <Fold F>
+auto fold_axis(const Matrix& a, Axis axis) -> Matrix {
+    const auto [data, ld, lines, len] = lines_of(a);
+    auto res{axis == Axis::Rows ? Matrix::empty(1, a.cols()) : Matrix::empty(a.rows(), 1)};
+    // collapsing the dimension along the lines folds each of them, the other one combines the lines elementwise
+    if ((axis == Axis::Rows) == (a.layout() == Layout::ColMajor)) {
+        fold_each_line<F>(data, ld, lines, len, res.data());
+    } else {
+        fold_lines<F>(data, ld, lines, len, res.data());
+    }
+    return res;
+}
+
+} // namespace
+
+auto sum(const Matrix& a) -> double {
+    return fold_all<Fold::Sum>(a);
+}
+
+auto sum(const Matrix& a, Axis axis) -> Matrix {
+    return fold_axis<Fold::Sum>(a, axis);
+}
+
+auto mean(const Matrix& a) -> double {
+    return sum(a) / static_cast<double>(a.size());
+}
+
+auto mean(const Matrix& a, Axis axis) -> Matrix {
+    auto res{sum(a, axis)};
+    res /= static_cast<double>(axis == Axis::Rows ? a.rows() : a.cols());
+    return res;
+}
+
+auto min(const Matrix& a) -> std::optional<double> {
+    if (a.size() == 0) {
+        return std::nullopt;
+    }
+    return fold_all<Fold::Min>(a);
+}
+
+auto min(const Matrix& a, Axis axis) -> std::optional<Matrix> {
+    if (a.size() == 0) {
+        return std::nullopt;
+    }
+    return fold_axis<Fold::Min>(a, axis);
+}
+
+auto max(const Matrix& a) -> std::optional<double> {
+    if (a.size() == 0) {
+        return std::nullopt;
+    }
+    return fold_all<Fold::Max>(a);
+}
+
+auto max(const Matrix& a, Axis axis) -> std::optional<Matrix> {
+    if (a.size() == 0) {
+        return std::nullopt;
+    }
+    return fold_axis<Fold::Max>(a, axis);
+}
+
+auto frobenius_norm(const Matrix& a) -> double {
+    const double squares{fold_all<Fold::SumSquares>(a)};
+    if (std::isnan(squares) ||
+        (squares < std::numeric_limits<double>::max() && squares >= std::numeric_limits<double>::min() / EPS)) {
+        return std::sqrt(squares);
+    }
+    // the squares overflowed, or are small enough to have lost digits: sum them again relative to the largest
+    const double scale{fold_all<Fold::MaxAbs>(a)};
+    if (scale == 0.0 || std::isinf(scale)) {
+        return scale;
+    }
+    return scale * std::sqrt(fold_all<Fold::SumSquares>(Matrix(a / scale)));
+}
+
+auto norm_1(const Matrix& a) -> double {
+    return fold_all<Fold::MaxAbs>(fold_axis<Fold::SumAbs>(a, Axis::Rows));
+}
+
+auto norm_inf(const Matrix& a) -> double {
+    return fold_all<Fold::MaxAbs>(fold_axis<Fold::SumAbs>(a, Axis::Cols));
+}
+
+} // namespace matoy::foundations
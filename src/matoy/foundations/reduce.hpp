@@ -0,0 +1,43 @@
+#pragma once
+
+#include "matrix.hpp"
+#include <optional>
+
+namespace matoy::foundations {
+
+// The dimension a reduction collapses: Axis::Rows combines the rows into a 1 x n row with one value per column,
+// Axis::Cols combines the columns into an m x 1 column with one value per row.
+enum class Axis { Rows, Cols };
+
+// Reductions over all elements of a matrix, or along one axis. They run SIMD kernels over the buffer in its own
+// layout and split large matrices across threads. Sums are pairwise over small blocks, so the rounding error grows
+// with log(n) instead of n, and the order of the additions only depends on the shape, not on the number of threads.
+
+auto sum(const Matrix& a) -> double;
+
+auto sum(const Matrix& a, Axis axis) -> Matrix;
+
+// NaN for an empty matrix.
+auto mean(const Matrix& a) -> double;
+
+auto mean(const Matrix& a, Axis axis) -> Matrix;
+
+// Returns nothing for an empty matrix. A NaN element makes the result NaN, as it does for sums.
+auto min(const Matrix& a) -> std::optional<double>;
+
+auto min(const Matrix& a, Axis axis) -> std::optional<Matrix>;
+
+auto max(const Matrix& a) -> std::optional<double>;
+
+auto max(const Matrix& a, Axis axis) -> std::optional<Matrix>;
+
+// The square root of the sum of squares, rescaled when the squares would overflow or underflow.
+auto frobenius_norm(const Matrix& a) -> double;
+
+// The largest sum of absolute values in a column.
+auto norm_1(const Matrix& a) -> double;
+
+// The largest sum of absolute values in a row.
+auto norm_inf(const Matrix& a) -> double;
+
+} // namespace matoy::foundations
@@ -0,0 +1,103 @@
+#include "refined_lu.hpp"
+#include "gemm.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace matoy::foundations {
+
+static constexpr auto EPS = std::numeric_limits<Matrix::value_type>::epsilon();
+
+// Elements beyond this overflow or lose all precision when rounded to float.
+static constexpr double FLOAT_MAX = std::numeric_limits<float>::max();
+
+// Up to this many right-hand sides, residuals are computed column by column.
+static constexpr size_t FEW_COLUMNS = 8;
+
+RefinedLU::RefinedLU(Matrix mat) : a_{std::move(mat)} {
+    assert(a_.is_square());
+    a_.set_layout(Layout::RowMajor);
+    const size_t n{a_.rows()};
+    const auto a{std::as_const(a_).view()};
+    bool fits{true};
+    for (size_t i{0}; i < n; i++) {
+        value_type row{0.0};
+        for (size_t j{0}; j < n; j++) {
+            row += std::abs(a[i, j]);
+            fits = fits && std::abs(a[i, j]) <= FLOAT_MAX;
+        }
+        norm_ = std::max(norm_, row);
+    }
+    if (fits) {
+        lu32_.emplace(FloatMatrix{a_});
+        if (!lu32_->is_singular()) {
+            return;
+        }
+        lu32_.reset();
+    }
+    lu_.emplace(a_);
+}
+
+// Whether every column of the residual r is below the rounding error of computing A * x in double, which is
+// what a backward stable double precision solve achieves.
+static auto converged(const Matrix& r, const Matrix& x, double norm) -> bool {
+    const double tol{norm * EPS * std::sqrt(static_cast<double>(x.rows()))};
+    for (size_t j{0}; j < x.cols(); j++) {
+        double r_max{0.0}, x_max{0.0};
+        for (size_t i{0}; i < x.rows(); i++) {
+            r_max = std::max(r_max, std::abs(r[i, j]));
+            x_max = std::max(x_max, std::abs(x[i, j]));
+        }
+        if (!(r_max <= x_max * tol)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// r = b - a * x. A few columns are matrix-vector products, which take dot products with the rows of a instead of
+// packing all of it for gemm.
+static void residual(const Matrix& a, const Matrix& x, const Matrix& b, Matrix& r) {
+    const size_t n{a.rows()};
+    if (x.cols() > FEW_COLUMNS) {
+        r.set_block(0, 0, b);
+        gemm(-1.0, a.view(), x.view(), 1.0, r.view());
+        return;
+    }
+    std::vector<double> xj(n);
+    for (size_t j{0}; j < x.cols(); j++) {
+        for (size_t i{0}; i < n; i++) {
+            xj[i] = x[i, j];
+        }
+        for (size_t i{0}; i < n; i++) {
+            r[i, j] = b[i, j] - simd::dot(&a[i, 0], xj.data(), n);
+        }
+    }
+}
+
+auto RefinedLU::solve(const Matrix& b) const -> std::optional<Matrix> {
+    assert(b.rows() == a_.rows());
+    if (lu_) {
+        return lu_->solve(b);
+    }
+
+    auto x32{lu32_->solve(FloatMatrix{b})};
+    Matrix x{*x32};
+    auto r{Matrix::empty(b.rows(), b.cols())};
+    for (size_t iter{0}; iter < max_iterations; iter++) {
+        residual(a_, x, b, r);
+        if (converged(r, x, norm_)) {
+            return x;
+        }
+        x32 = lu32_->solve(FloatMatrix{r});
+        x += Matrix{*x32};
+    }
+    // the refinement stagnated, so A is too badly conditioned for single precision
+    return LU{a_}.solve(b);
+}
+
+} // namespace matoy::foundations
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "lu.hpp"
+#include "matrix.hpp"
+#include <optional>
+
+namespace matoy::foundations {
+
+// Solves A * X = B to double accuracy from a single precision LU factorization.
+//
+// The factorization is the O(n^3) part and runs in float, at twice the throughput of double. Each solve then
+// refines the float solution: the residual R = B - A * X is computed in double, the correction is solved with the
+// float factors and added to X, until R is at the level of double rounding. This takes a few O(n^2) steps as long
+// as A is not too badly conditioned for float, roughly cond(A) < 1e6. Otherwise, and when A does not fit into the
+// range of float, it falls back to a double precision LU.
+class RefinedLU {
+  public:
+    using value_type = Matrix::value_type;
+
+    // Refinement steps allowed before falling back, as in LAPACK's dsgesv.
+    static constexpr size_t max_iterations = 30;
+
+    explicit RefinedLU(Matrix mat);
+
+    // Whether A could be factorized in single precision. If not, solves use the double precision factors.
+    auto is_single_precision() const -> bool {
+        return lu32_.has_value();
+    }
+
+    // Solve A * X = B for X. Returns nothing if A is singular.
+    auto solve(const Matrix& b) const -> std::optional<Matrix>;
+
+  private:
+    Matrix a_;
+    std::optional<FloatLU> lu32_;
+    std::optional<LU> lu_;
+    value_type norm_{0.0};
+};
+
+} // namespace matoy::foundations
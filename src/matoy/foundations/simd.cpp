@@ -0,0 +1,326 @@
+#include "simd.hpp"
+#include "avx2.hpp"
+#include "cpu.hpp"
+#include <cmath>
+#include <utility>
+
+namespace matoy::foundations::simd {
+
+namespace {
+
+template <class T>
+struct Kernels {
+    void (*add)(T*, const T*, size_t);
+    void (*sub)(T*, const T*, size_t);
+    void (*add_scalar)(T*, T, size_t);
+    void (*mul_scalar)(T*, T, size_t);
+    void (*div_scalar)(T*, T, size_t);
+    void (*negate)(T*, size_t);
+    void (*axpy)(T*, T, const T*, size_t);
+    void (*swap)(T*, T*, size_t);
+    T (*dot)(const T*, const T*, size_t);
+};
+
+template <class T>
+void add_generic(T* x, const T* y, size_t n) {
+    for (size_t i{0}; i < n; i++) {
+        x[i] += y[i];
+    }
+}
+
+template <class T>
+void sub_generic(T* x, const T* y, size_t n) {
+    for (size_t i{0}; i < n; i++) {
+        x[i] -= y[i];
+    }
+}
+
+template <class T>
+void add_scalar_generic(T* x, T s, size_t n) {
+    for (size_t i{0}; i < n; i++) {
+        x[i] += s;
+    }
+}
+
+template <class T>
+void mul_scalar_generic(T* x, T s, size_t n) {
+    for (size_t i{0}; i < n; i++) {
+        x[i] *= s;
+    }
+}
+
+template <class T>
+void div_scalar_generic(T* x, T s, size_t n) {
+    for (size_t i{0}; i < n; i++) {
+        x[i] /= s;
+    }
+}
+
+template <class T>
+void negate_generic(T* x, size_t n) {
+    for (size_t i{0}; i < n; i++) {
+        x[i] = -x[i];
+    }
+}
+
+template <class T>
+void axpy_generic(T* x, T a, const T* y, size_t n) {
+    for (size_t i{0}; i < n; i++) {
+        x[i] += a * y[i];
+    }
+}
+
+template <class T>
+void swap_generic(T* x, T* y, size_t n) {
+    for (size_t i{0}; i < n; i++) {
+        std::swap(x[i], y[i]);
+    }
+}
+
+template <class T>
+T dot_generic(const T* x, const T* y, size_t n) {
+    T sum{0};
+    for (size_t i{0}; i < n; i++) {
+        sum += x[i] * y[i];
+    }
+    return sum;
+}
+
+#ifdef MATOY_X86_DISPATCH
+
+// Each kernel handles two registers per iteration in independent chains, then finishes the tail
+// with scalar code. Loads and stores are unaligned, since rows start anywhere in the buffer.
+
+template <class T>
+[[gnu::target("avx2,fma")]] void add_avx2(T* x, const T* y, size_t n) {
+    using V = avx2::Vec<T>;
+    constexpr size_t w{V::lanes};
+    size_t i{0};
+    for (; i + 2 * w <= n; i += 2 * w) {
+        V::store(x + i, V::add(V::load(x + i), V::load(y + i)));
+        V::store(x + i + w, V::add(V::load(x + i + w), V::load(y + i + w)));
+    }
+    for (; i < n; i++) {
+        x[i] += y[i];
+    }
+}
+
+template <class T>
+[[gnu::target("avx2,fma")]] void sub_avx2(T* x, const T* y, size_t n) {
+    using V = avx2::Vec<T>;
+    constexpr size_t w{V::lanes};
+    size_t i{0};
+    for (; i + 2 * w <= n; i += 2 * w) {
+        V::store(x + i, V::sub(V::load(x + i), V::load(y + i)));
+        V::store(x + i + w, V::sub(V::load(x + i + w), V::load(y + i + w)));
+    }
+    for (; i < n; i++) {
+        x[i] -= y[i];
+    }
+}
+
+template <class T>
+[[gnu::target("avx2,fma")]] void add_scalar_avx2(T* x, T s, size_t n) {
+    using V = avx2::Vec<T>;
+    constexpr size_t w{V::lanes};
+    const auto v{V::set1(s)};
+    size_t i{0};
+    for (; i + 2 * w <= n; i += 2 * w) {
+        V::store(x + i, V::add(V::load(x + i), v));
+        V::store(x + i + w, V::add(V::load(x + i + w), v));
+    }
+    for (; i < n; i++) {
+        x[i] += s;
+    }
+}
+
+template <class T>
+[[gnu::target("avx2,fma")]] void mul_scalar_avx2(T* x, T s, size_t n) {
+    using V = avx2::Vec<T>;
+    constexpr size_t w{V::lanes};
+    const auto v{V::set1(s)};
+    size_t i{0};
+    for (; i + 2 * w <= n; i += 2 * w) {
+        V::store(x + i, V::mul(V::load(x + i), v));
+        V::store(x + i + w, V::mul(V::load(x + i + w), v));
+    }
+    for (; i < n; i++) {
+        x[i] *= s;
+    }
+}
+
+template <class T>
+[[gnu::target("avx2,fma")]] void div_scalar_avx2(T* x, T s, size_t n) {
+    using V = avx2::Vec<T>;
+    constexpr size_t w{V::lanes};
+    const auto v{V::set1(s)};
+    size_t i{0};
+    for (; i + 2 * w <= n; i += 2 * w) {
+        V::store(x + i, V::div(V::load(x + i), v));
+        V::store(x + i + w, V::div(V::load(x + i + w), v));
+    }
+    for (; i < n; i++) {
+        x[i] /= s;
+    }
+}
+
+template <class T>
+[[gnu::target("avx2,fma")]] void negate_avx2(T* x, size_t n) {
+    using V = avx2::Vec<T>;
+    constexpr size_t w{V::lanes};
+    // flip the sign bit, like the scalar negation does
+    const auto sign{V::set1(T{-0.0})};
+    size_t i{0};
+    for (; i + 2 * w <= n; i += 2 * w) {
+        V::store(x + i, V::bit_xor(V::load(x + i), sign));
+        V::store(x + i + w, V::bit_xor(V::load(x + i + w), sign));
+    }
+    for (; i < n; i++) {
+        x[i] = -x[i];
+    }
+}
+
+template <class T>
+[[gnu::target("avx2,fma")]] void axpy_avx2(T* x, T a, const T* y, size_t n) {
+    using V = avx2::Vec<T>;
+    constexpr size_t w{V::lanes};
+    const auto va{V::set1(a)};
+    size_t i{0};
+    for (; i + 2 * w <= n; i += 2 * w) {
+        V::store(x + i, V::fmadd(va, V::load(y + i), V::load(x + i)));
+        V::store(x + i + w, V::fmadd(va, V::load(y + i + w), V::load(x + i + w)));
+    }
+    for (; i < n; i++) {
+        x[i] = std::fma(a, y[i], x[i]);
+    }
+}
+
+template <class T>
+[[gnu::target("avx2,fma")]] void swap_avx2(T* x, T* y, size_t n) {
+    using V = avx2::Vec<T>;
+    constexpr size_t w{V::lanes};
+    size_t i{0};
+    for (; i + w <= n; i += w) {
+        const auto vx{V::load(x + i)};
+        V::store(x + i, V::load(y + i));
+        V::store(y + i, vx);
+    }
+    for (; i < n; i++) {
+        std::swap(x[i], y[i]);
+    }
+}
+
+template <class T>
+[[gnu::target("avx2,fma")]] T dot_avx2(const T* x, const T* y, size_t n) {
+    using V = avx2::Vec<T>;
+    constexpr size_t w{V::lanes};
+    auto s0{V::zero()}, s1{V::zero()};
+    size_t i{0};
+    for (; i + 2 * w <= n; i += 2 * w) {
+        s0 = V::fmadd(V::load(x + i), V::load(y + i), s0);
+        s1 = V::fmadd(V::load(x + i + w), V::load(y + i + w), s1);
+    }
+    T sum{V::sum(V::add(s0, s1))};
+    for (; i < n; i++) {
+        sum = std::fma(x[i], y[i], sum);
+    }
+    return sum;
+}
+
+#endif
+
+template <class T>
+auto select_kernels() -> Kernels<T> {
+#ifdef MATOY_X86_DISPATCH
+    if (cpu::has_avx2_fma()) {
+        return {add_avx2<T>,        sub_avx2<T>,    add_scalar_avx2<T>, mul_scalar_avx2<T>,
+                div_scalar_avx2<T>, negate_avx2<T>, axpy_avx2<T>,       swap_avx2<T>,
+                dot_avx2<T>};
+    }
+#endif
+    return {add_generic<T>,        sub_generic<T>,    add_scalar_generic<T>, mul_scalar_generic<T>,
+            div_scalar_generic<T>, negate_generic<T>, axpy_generic<T>,       swap_generic<T>,
+            dot_generic<T>};
+}
+
+template <class T>
+auto kernels() -> const Kernels<T>& {
+    static const Kernels<T> value{select_kernels<T>()};
+    return value;
+}
+
+} // namespace
+
+void add(double* x, const double* y, size_t n) {
+    kernels<double>().add(x, y, n);
+}
+
+void add(float* x, const float* y, size_t n) {
+    kernels<float>().add(x, y, n);
+}
+
+void sub(double* x, const double* y, size_t n) {
+    kernels<double>().sub(x, y, n);
+}
+
+void sub(float* x, const float* y, size_t n) {
+    kernels<float>().sub(x, y, n);
+}
+
+void add_scalar(double* x, double s, size_t n) {
+    kernels<double>().add_scalar(x, s, n);
+}
+
+void add_scalar(float* x, float s, size_t n) {
+    kernels<float>().add_scalar(x, s, n);
+}
+
+void mul_scalar(double* x, double s, size_t n) {
+    kernels<double>().mul_scalar(x, s, n);
+}
+
+void mul_scalar(float* x, float s, size_t n) {
+    kernels<float>().mul_scalar(x, s, n);
+}
+
+void div_scalar(double* x, double s, size_t n) {
+    kernels<double>().div_scalar(x, s, n);
+}
+
+void div_scalar(float* x, float s, size_t n) {
+    kernels<float>().div_scalar(x, s, n);
+}
+
+void negate(double* x, size_t n) {
+    kernels<double>().negate(x, n);
+}
+
+void negate(float* x, size_t n) {
+    kernels<float>().negate(x, n);
+}
+
+void axpy(double* x, double a, const double* y, size_t n) {
+    kernels<double>().axpy(x, a, y, n);
+}
+
+void axpy(float* x, float a, const float* y, size_t n) {
+    kernels<float>().axpy(x, a, y, n);
+}
+
+void swap(double* x, double* y, size_t n) {
+    kernels<double>().swap(x, y, n);
+}
+
+void swap(float* x, float* y, size_t n) {
+    kernels<float>().swap(x, y, n);
+}
+
+auto dot(const double* x, const double* y, size_t n) -> double {
+    return kernels<double>().dot(x, y, n);
+}
+
+auto dot(const float* x, const float* y, size_t n) -> float {
+    return kernels<float>().dot(x, y, n);
+}
+
+} // namespace matoy::foundations::simd
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+
+// Vectorized loops over contiguous arrays of doubles or floats. Both precisions share one implementation.
+// The implementation is chosen once at runtime: AVX2/FMA where the CPU supports it, portable loops otherwise.
+namespace matoy::foundations::simd {
+
+// x += y
+void add(double* x, const double* y, size_t n);
+void add(float* x, const float* y, size_t n);
+
+// x -= y
+void sub(double* x, const double* y, size_t n);
+void sub(float* x, const float* y, size_t n);
+
+// x += s
+void add_scalar(double* x, double s, size_t n);
+void add_scalar(float* x, float s, size_t n);
+
+// x *= s
+void mul_scalar(double* x, double s, size_t n);
+void mul_scalar(float* x, float s, size_t n);
+
+// x /= s
+void div_scalar(double* x, double s, size_t n);
+void div_scalar(float* x, float s, size_t n);
+
+// x = -x
+void negate(double* x, size_t n);
+void negate(float* x, size_t n);
+
+// x += a * y, fused where FMA is available.
+void axpy(double* x, double a, const double* y, size_t n);
+void axpy(float* x, float a, const float* y, size_t n);
+
+// Exchange the contents of x and y.
+void swap(double* x, double* y, size_t n);
+void swap(float* x, float* y, size_t n);
+
+// The sum of x[i] * y[i]. The vectorized version accumulates in several lanes, so the rounding differs from a
+// sequential loop.
+auto dot(const double* x, const double* y, size_t n) -> double;
+auto dot(const float* x, const float* y, size_t n) -> float;
+
+} // namespace matoy::foundations::simd
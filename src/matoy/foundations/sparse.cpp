@@ -0,0 +1,432 @@
+#include "sparse.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace matoy::foundations {
+
+SparseMatrix::SparseMatrix(size_t rows, size_t cols) : rows_{rows}, cols_{cols}, row_ptr_(rows + 1, 0) {
+    assert(cols <= std::numeric_limits<index_type>::max());
+}
+
+SparseMatrix::SparseMatrix(size_t rows, size_t cols, std::vector<size_t> row_ptr, std::vector<index_type> col_idx,
+                           std::vector<value_type> values)
+    : rows_{rows}, cols_{cols}, row_ptr_{std::move(row_ptr)}, col_idx_{std::move(col_idx)},
+      values_{std::move(values)} {
+    assert(cols <= std::numeric_limits<index_type>::max());
+    assert(row_ptr_.size() == rows + 1 && row_ptr_.front() == 0 && row_ptr_.back() == values_.size());
+    assert(col_idx_.size() == values_.size());
+    prune();
+}
+
+SparseMatrix::SparseMatrix(const Matrix& dense) : SparseMatrix(dense.rows(), dense.cols()) {
+    for (size_t i{0}; i < rows_; i++) {
+        for (size_t j{0}; j < cols_; j++) {
+            if (const value_type x{dense[i, j]}; x != 0.0) {
+                col_idx_.push_back(static_cast<index_type>(j));
+                values_.push_back(x);
+            }
+        }
+        row_ptr_[i + 1] = values_.size();
+    }
+}
+
+auto SparseMatrix::from_triplets(size_t rows, size_t cols, std::span<const Triplet> entries) -> Self {
+    std::vector<Triplet> sorted(entries.begin(), entries.end());
+    std::ranges::sort(sorted, {}, [](const Triplet& t) { return std::pair{t.row, t.col}; });
+
+    Self res(rows, cols);
+    for (size_t k{0}; k < sorted.size();) {
+        const size_t i{sorted[k].row}, j{sorted[k].col};
+        assert(i < rows && j < cols);
+        value_type sum{0.0};
+        for (; k < sorted.size() && sorted[k].row == i && sorted[k].col == j; k++) {
+            sum += sorted[k].value;
+        }
+        if (sum != 0.0) {
+            res.col_idx_.push_back(static_cast<index_type>(j));
+            res.values_.push_back(sum);
+            res.row_ptr_[i + 1]++;
+        }
+    }
+    std::partial_sum(res.row_ptr_.begin(), res.row_ptr_.end(), res.row_ptr_.begin());
+    return res;
+}
+
+auto SparseMatrix::identity(size_t n) -> Self {
+    Self res(n, n);
+    for (size_t i{0}; i < n; i++) {
+        res.col_idx_.push_back(static_cast<index_type>(i));
+        res.values_.push_back(1.0);
+        res.row_ptr_[i + 1] = i + 1;
+    }
+    return res;
+}
+
+auto SparseMatrix::to_dense() const -> Matrix {
+    auto res{Matrix::zeros(rows_, cols_)};
+    double* x{res.data()};
+    const size_t ld{res.leading_dim()};
+    for (size_t i{0}; i < rows_; i++) {
+        for (size_t k{row_ptr_[i]}; k < row_ptr_[i + 1]; k++) {
+            x[i * ld + col_idx_[k]] = values_[k];
+        }
+    }
+    return res;
+}
+
+auto SparseMatrix::transposed() const -> Self {
+    // counting sort by column; walking the rows in order leaves the new rows sorted
+    Self res(cols_, rows_);
+    res.col_idx_.resize(nnz());
+    res.values_.resize(nnz());
+    for (index_type j : col_idx_) {
+        res.row_ptr_[j + 1]++;
+    }
+    std::partial_sum(res.row_ptr_.begin(), res.row_ptr_.end(), res.row_ptr_.begin());
+    std::vector<size_t> next(res.row_ptr_.begin(), res.row_ptr_.end() - 1);
+    for (size_t i{0}; i < rows_; i++) {
+        for (size_t k{row_ptr_[i]}; k < row_ptr_[i + 1]; k++) {
+            const size_t dst{next[col_idx_[k]]++};
+            res.col_idx_[dst] = static_cast<index_type>(i);
+            res.values_[dst] = values_[k];
+        }
+    }
+    return res;
+}
+
+auto SparseMatrix::operator[](size_t i, size_t j) const -> value_type {
+    const auto first{col_idx_.begin() + row_ptr_[i]}, last{col_idx_.begin() + row_ptr_[i + 1]};
+    const auto it{std::lower_bound(first, last, j)};
+    return it != last && *it == j ? values_[it - col_idx_.begin()] : 0.0;
+}
+
+void SparseMatrix::prune() {
+    size_t out{0};
+    for (size_t i{0}; i < rows_; i++) {
+        const size_t begin{row_ptr_[i]};
+        row_ptr_[i] = out;
+        for (size_t k{begin}; k < row_ptr_[i + 1]; k++) {
+            if (values_[k] != 0.0) {
+                col_idx_[out] = col_idx_[k];
+                values_[out] = values_[k];
+                out++;
+            }
+        }
+    }
+    row_ptr_[rows_] = out;
+    col_idx_.resize(out);
+    values_.resize(out);
+}
+
+SparseMatrix SparseMatrix::operator+() const {
+    return *this;
+}
+
+SparseMatrix SparseMatrix::operator-() const& {
+    return -Self{*this};
+}
+
+SparseMatrix SparseMatrix::operator-() && {
+    simd::negate(values_.data(), values_.size());
+    return std::move(*this);
+}
+
+SparseMatrix& SparseMatrix::operator*=(value_type value) {
+    simd::mul_scalar(values_.data(), value, values_.size());
+    // a zero factor or underflow may leave zeros behind
+    prune();
+    return *this;
+}
+
+SparseMatrix& SparseMatrix::operator/=(value_type value) {
+    simd::div_scalar(values_.data(), value, values_.size());
+    prune();
+    return *this;
+}
+
+// Rows are cheap and independent in the sparse products, so they are only split across threads when there is
+// enough work to pay for it.
+static constexpr size_t PARALLEL_MIN_FLOPS = 1 << 16;
+
+// The number of rows in each range of for_row_ranges: all of them unless `flops` is large enough for threads.
+static size_t row_range_step(size_t rows, size_t flops) {
+    const size_t threads{num_threads()};
+    if (threads == 1 || rows < 2 || flops < PARALLEL_MIN_FLOPS) {
+        return std::max(rows, size_t{1});
+    }
+    // a few ranges per thread even out rows with different numbers of nonzeros
+    const size_t ranges{std::min(rows, threads * 4)};
+    return (rows + ranges - 1) / ranges;
+}
+
+// Call f(i0, i1) on ranges of rows covering [0, rows), in parallel if `flops` is large enough.
+template <class F>
+static void for_row_ranges(size_t rows, size_t flops, F f) {
+    const size_t step{row_range_step(rows, flops)};
+    if (step >= rows) {
+        f(0, rows);
+        return;
+    }
+    parallel_for((rows + step - 1) / step, [&](size_t t) { f(t * step, std::min(rows, (t + 1) * step)); });
+}
+
+// Merge two sparse matrices row by row, keeping the nonzero results of op(x, y).
+template <class Op>
+static SparseMatrix merge(const SparseMatrix& lhs, const SparseMatrix& rhs, Op op) {
+    assert(lhs.shape() == rhs.shape());
+    const auto lp{lhs.row_ptr()}, rp{rhs.row_ptr()};
+    const auto lc{lhs.col_idx()}, rc{rhs.col_idx()};
+    const auto lv{lhs.values()}, rv{rhs.values()};
+
+    std::vector<size_t> row_ptr(lhs.rows() + 1, 0);
+    std::vector<SparseMatrix::index_type> col_idx;
+    std::vector<double> values;
+    col_idx.reserve(std::max(lhs.nnz(), rhs.nnz()));
+    values.reserve(std::max(lhs.nnz(), rhs.nnz()));
+
+    auto push = [&](SparseMatrix::index_type j, double x) {
+        if (x != 0.0) {
+            col_idx.push_back(j);
+            values.push_back(x);
+        }
+    };
+    for (size_t i{0}; i < lhs.rows(); i++) {
+        size_t a{lp[i]}, b{rp[i]};
+        while (a < lp[i + 1] && b < rp[i + 1]) {
+            if (lc[a] < rc[b]) {
+                push(lc[a], op(lv[a], 0.0));
+                a++;
+            } else if (rc[b] < lc[a]) {
+                push(rc[b], op(0.0, rv[b]));
+                b++;
+            } else {
+                push(lc[a], op(lv[a], rv[b]));
+                a++;
+                b++;
+            }
+        }
+        for (; a < lp[i + 1]; a++) {
+            push(lc[a], op(lv[a], 0.0));
+        }
+        for (; b < rp[i + 1]; b++) {
+            push(rc[b], op(0.0, rv[b]));
+        }
+        row_ptr[i + 1] = values.size();
+    }
+    return {lhs.rows(), lhs.cols(), std::move(row_ptr), std::move(col_idx), std::move(values)};
+}
+
+// dense[i, j] += sign * sparse[i, j] for every stored element.
+static void scatter_add(Matrix& dense, const SparseMatrix& sparse, double sign) {
+    assert(dense.shape() == sparse.shape());
+    double* x{dense.data()};
+    const size_t rs{dense.row_stride()}, cs{dense.col_stride()};
+    const auto ptr{sparse.row_ptr()};
+    const auto col{sparse.col_idx()};
+    const auto val{sparse.values()};
+    for (size_t i{0}; i < sparse.rows(); i++) {
+        for (size_t k{ptr[i]}; k < ptr[i + 1]; k++) {
+            x[i * rs + col[k] * cs] += sign * val[k];
+        }
+    }
+}
+
+SparseMatrix operator+(const SparseMatrix& lhs, const SparseMatrix& rhs) {
+    return merge(lhs, rhs, std::plus<>{});
+}
+
+SparseMatrix operator-(const SparseMatrix& lhs, const SparseMatrix& rhs) {
+    return merge(lhs, rhs, std::minus<>{});
+}
+
+Matrix operator+(const SparseMatrix& lhs, Matrix rhs) {
+    scatter_add(rhs, lhs, 1.0);
+    return rhs;
+}
+
+Matrix operator+(Matrix lhs, const SparseMatrix& rhs) {
+    scatter_add(lhs, rhs, 1.0);
+    return lhs;
+}
+
+Matrix operator-(const SparseMatrix& lhs, Matrix rhs) {
+    rhs.negate();
+    scatter_add(rhs, lhs, 1.0);
+    return rhs;
+}
+
+Matrix operator-(Matrix lhs, const SparseMatrix& rhs) {
+    scatter_add(lhs, rhs, -1.0);
+    return lhs;
+}
+
+SparseMatrix operator*(SparseMatrix lhs, double rhs) {
+    lhs *= rhs;
+    return lhs;
+}
+
+SparseMatrix operator*(double lhs, SparseMatrix rhs) {
+    rhs *= lhs;
+    return rhs;
+}
+
+SparseMatrix operator/(SparseMatrix lhs, double rhs) {
+    lhs /= rhs;
+    return lhs;
+}
+
+SparseMatrix operator*(const SparseMatrix& lhs, const SparseMatrix& rhs) {
+    assert(lhs.cols() == rhs.rows());
+    const auto ap{lhs.row_ptr()}, bp{rhs.row_ptr()};
+    const auto ac{lhs.col_idx()}, bc{rhs.col_idx()};
+    const auto av{lhs.values()}, bv{rhs.values()};
+    const size_t m{lhs.rows()}, n{rhs.cols()};
+
+    size_t flops{0};
+    for (auto p : ac) {
+        flops += bp[p + 1] - bp[p];
+    }
+
+    // Each range of rows fills its own part of the product, the counts of its rows go to row_ptr[i + 1].
+    struct Part {
+        std::vector<SparseMatrix::index_type> col_idx;
+        std::vector<double> values;
+    };
+    const size_t step{row_range_step(m, flops)}, ranges{(m + step - 1) / step};
+    std::vector<Part> parts(ranges);
+    std::vector<size_t> row_ptr(m + 1, 0);
+    parallel_for(ranges, [&](size_t t) {
+        // Gustavson's algorithm: row i of the product accumulates the rows of rhs selected by row i of lhs.
+        // `acc` holds the partial row densely and `touched` lists its columns, so clearing costs only what was used.
+        std::vector<double> acc(n, 0.0);
+        std::vector<size_t> mark(n, std::numeric_limits<size_t>::max());
+        std::vector<SparseMatrix::index_type> touched;
+        auto& [col_idx, values] = parts[t];
+        for (size_t i{t * step}; i < std::min(m, (t + 1) * step); i++) {
+            touched.clear();
+            for (size_t ka{ap[i]}; ka < ap[i + 1]; ka++) {
+                const double a{av[ka]};
+                const size_t p{ac[ka]};
+                for (size_t kb{bp[p]}; kb < bp[p + 1]; kb++) {
+                    const auto j{bc[kb]};
+                    if (mark[j] != i) {
+                        mark[j] = i;
+                        acc[j] = 0.0;
+                        touched.push_back(j);
+                    }
+                    acc[j] += a * bv[kb];
+                }
+            }
+            std::ranges::sort(touched);
+            const size_t before{values.size()};
+            for (auto j : touched) {
+                if (acc[j] != 0.0) {
+                    col_idx.push_back(j);
+                    values.push_back(acc[j]);
+                }
+            }
+            row_ptr[i + 1] = values.size() - before;
+        }
+    });
+    std::inclusive_scan(row_ptr.begin(), row_ptr.end(), row_ptr.begin());
+    if (ranges == 1) {
+        return {m, n, std::move(row_ptr), std::move(parts[0].col_idx), std::move(parts[0].values)};
+    }
+
+    // the parts are copied to their offsets in parallel
+    std::vector<SparseMatrix::index_type> col_idx(row_ptr[m]);
+    std::vector<double> values(row_ptr[m]);
+    parallel_for(ranges, [&](size_t t) {
+        const size_t offset{row_ptr[t * step]};
+        std::ranges::copy(parts[t].col_idx, col_idx.begin() + static_cast<ptrdiff_t>(offset));
+        std::ranges::copy(parts[t].values, values.begin() + static_cast<ptrdiff_t>(offset));
+    });
+    return {m, n, std::move(row_ptr), std::move(col_idx), std::move(values)};
+}
+
+Matrix operator*(const SparseMatrix& lhs, const Matrix& rhs) {
+    assert(lhs.cols() == rhs.rows());
+    const size_t n{rhs.cols()};
+    auto res{Matrix::zeros(lhs.rows(), n)};
+    const auto ptr{lhs.row_ptr()};
+    const auto col{lhs.col_idx()};
+    const auto val{lhs.values()};
+    const double* b{rhs.data()};
+    const size_t brs{rhs.row_stride()}, bcs{rhs.col_stride()};
+    double* c{res.data()};
+    const size_t ldc{res.leading_dim()};
+
+    for_row_ranges(lhs.rows(), lhs.nnz() * n, [&](size_t i0, size_t i1) {
+        if (n == 1) {
+            // SpMV: a sparse dot product per row
+            for (size_t i{i0}; i < i1; i++) {
+                double sum{0.0};
+                for (size_t k{ptr[i]}; k < ptr[i + 1]; k++) {
+                    sum += val[k] * b[col[k] * brs];
+                }
+                c[i * ldc] = sum;
+            }
+        } else if (bcs == 1) {
+            // row i of the result is a combination of contiguous rows of rhs
+            for (size_t i{i0}; i < i1; i++) {
+                for (size_t k{ptr[i]}; k < ptr[i + 1]; k++) {
+                    simd::axpy(c + i * ldc, val[k], b + col[k] * brs, n);
+                }
+            }
+        } else {
+            for (size_t i{i0}; i < i1; i++) {
+                for (size_t j{0}; j < n; j++) {
+                    double sum{0.0};
+                    for (size_t k{ptr[i]}; k < ptr[i + 1]; k++) {
+                        sum += val[k] * b[col[k] * brs + j * bcs];
+                    }
+                    c[i * ldc + j] = sum;
+                }
+            }
+        }
+    });
+    return res;
+}
+
+Matrix operator*(const Matrix& lhs, const SparseMatrix& rhs) {
+    assert(lhs.cols() == rhs.rows());
+    auto res{Matrix::zeros(lhs.rows(), rhs.cols())};
+    const auto ptr{rhs.row_ptr()};
+    const auto col{rhs.col_idx()};
+    const auto val{rhs.values()};
+    const double* a{lhs.data()};
+    const size_t ars{lhs.row_stride()}, acs{lhs.col_stride()};
+    double* c{res.data()};
+    const size_t ldc{res.leading_dim()};
+
+    // row i of the result scatters row p of rhs scaled by lhs[i, p]
+    for_row_ranges(lhs.rows(), lhs.rows() * rhs.nnz(), [&](size_t i0, size_t i1) {
+        for (size_t i{i0}; i < i1; i++) {
+            double* ci{c + i * ldc};
+            for (size_t p{0}; p < lhs.cols(); p++) {
+                const double x{a[i * ars + p * acs]};
+                if (x == 0.0) {
+                    continue;
+                }
+                for (size_t k{ptr[p]}; k < ptr[p + 1]; k++) {
+                    ci[col[k]] += x * val[k];
+                }
+            }
+        }
+    });
+    return res;
+}
+
+bool operator==(const SparseMatrix& lhs, const SparseMatrix& rhs) {
+    // stored elements are never zero, so equal matrices have equal patterns
+    return lhs.shape() == rhs.shape() && std::ranges::equal(lhs.row_ptr(), rhs.row_ptr()) &&
+           std::ranges::equal(lhs.col_idx(), rhs.col_idx()) && std::ranges::equal(lhs.values(), rhs.values());
+}
+
+} // namespace matoy::foundations
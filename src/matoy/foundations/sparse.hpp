@@ -0,0 +1,186 @@
+#pragma once
+
+#include "approx.hpp"
+#include "matrix.hpp"
+#include <cstdint>
+#include <format>
+#include <span>
+#include <vector>
+
+namespace matoy::foundations {
+
+// A matrix in compressed sparse row (CSR) form.
+//
+// The nonzeros of row i are values()[k] at column col_idx()[k] for k in [row_ptr()[i], row_ptr()[i + 1]),
+// with columns strictly increasing within a row. Results of arithmetic never hold explicit zeros.
+class SparseMatrix {
+  public:
+    using value_type = double;
+    using index_type = uint32_t;
+    using Self = SparseMatrix;
+
+    struct Triplet {
+        size_t row;
+        size_t col;
+        value_type value;
+    };
+
+    // A zero matrix.
+    SparseMatrix(size_t rows, size_t cols);
+
+    SparseMatrix(size_t rows, size_t cols, std::vector<size_t> row_ptr, std::vector<index_type> col_idx,
+                 std::vector<value_type> values);
+
+    // Keep the nonzero elements of a dense matrix.
+    explicit SparseMatrix(const Matrix& dense);
+
+    // Build from (row, col, value) entries in any order. Duplicate entries are summed.
+    static Self from_triplets(size_t rows, size_t cols, std::span<const Triplet> entries);
+
+    static Self identity(size_t n);
+
+    auto to_dense() const -> Matrix;
+
+    auto rows() const -> size_t {
+        return rows_;
+    }
+
+    auto cols() const -> size_t {
+        return cols_;
+    }
+
+    auto shape() const -> std::pair<size_t, size_t> {
+        return {rows_, cols_};
+    }
+
+    auto is_square() const -> bool {
+        return rows_ == cols_;
+    }
+
+    // Number of stored elements.
+    auto nnz() const -> size_t {
+        return values_.size();
+    }
+
+    auto row_ptr() const -> std::span<const size_t> {
+        return row_ptr_;
+    }
+
+    auto col_idx() const -> std::span<const index_type> {
+        return col_idx_;
+    }
+
+    auto values() const -> std::span<const value_type> {
+        return values_;
+    }
+
+    Self transposed() const;
+
+    // Element (i, j), found by binary search in row i.
+    auto operator[](size_t i, size_t j) const -> value_type;
+
+#pragma region operators
+
+    Self operator+() const;
+
+    Self operator-() const&;
+
+    Self operator-() &&;
+
+    Self& operator*=(value_type value);
+
+    Self& operator/=(value_type value);
+
+#pragma endregion operators
+
+  private:
+    // Drop the stored elements that are exactly zero.
+    void prune();
+
+  private:
+    size_t rows_;
+    size_t cols_;
+    std::vector<size_t> row_ptr_;     // rows_ + 1 offsets into col_idx_ and values_
+    std::vector<index_type> col_idx_; // column of each stored element
+    std::vector<value_type> values_;
+};
+
+// Sparse elementwise sum and difference, merging the rows of both operands.
+SparseMatrix operator+(const SparseMatrix& lhs, const SparseMatrix& rhs);
+
+SparseMatrix operator-(const SparseMatrix& lhs, const SparseMatrix& rhs);
+
+// Mixing with a dense matrix gives a dense result, computed by scattering the nonzeros into it.
+Matrix operator+(const SparseMatrix& lhs, Matrix rhs);
+
+Matrix operator+(Matrix lhs, const SparseMatrix& rhs);
+
+Matrix operator-(const SparseMatrix& lhs, Matrix rhs);
+
+Matrix operator-(Matrix lhs, const SparseMatrix& rhs);
+
+SparseMatrix operator*(SparseMatrix lhs, double rhs);
+
+SparseMatrix operator*(double lhs, SparseMatrix rhs);
+
+SparseMatrix operator/(SparseMatrix lhs, double rhs);
+
+// Sparse x sparse product (SpGEMM), row by row with a dense accumulator.
+SparseMatrix operator*(const SparseMatrix& lhs, const SparseMatrix& rhs);
+
+// Sparse x dense product (SpMM). A single-column right-hand side is a sparse matrix-vector product (SpMV).
+Matrix operator*(const SparseMatrix& lhs, const Matrix& rhs);
+
+// Dense x sparse product, scattering the rows of rhs into each row of the result.
+Matrix operator*(const Matrix& lhs, const SparseMatrix& rhs);
+
+bool operator==(const SparseMatrix& lhs, const SparseMatrix& rhs);
+
+template <>
+inline auto approx(const SparseMatrix& x, const SparseMatrix& y, int ulp) -> bool {
+    if (x.shape() != y.shape()) {
+        return false;
+    }
+    // the patterns may differ where an element is tiny in one operand and absent in the other
+    for (size_t i{0}; i < x.rows(); i++) {
+        for (size_t k{x.row_ptr()[i]}; k < x.row_ptr()[i + 1]; k++) {
+            if (!approx(x.values()[k], y[i, x.col_idx()[k]], ulp)) {
+                return false;
+            }
+        }
+        for (size_t k{y.row_ptr()[i]}; k < y.row_ptr()[i + 1]; k++) {
+            if (!approx(x[i, y.col_idx()[k]], y.values()[k], ulp)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace matoy::foundations
+
+namespace matoy {
+using foundations::SparseMatrix;
+}
+
+// Sparse matrices print like the dense matrix they represent.
+template <>
+struct std::formatter<matoy::SparseMatrix> : std::formatter<char> {
+    auto format(const matoy::SparseMatrix& mat, format_context& ctx) const {
+        std::format_to(ctx.out(), "[");
+        for (size_t i = 0; i < mat.rows(); i++) {
+            if (i != 0) {
+                std::format_to(ctx.out(), "; ");
+            }
+            size_t k{mat.row_ptr()[i]};
+            for (size_t j = 0; j < mat.cols(); j++) {
+                if (j != 0) {
+                    std::format_to(ctx.out(), ", ");
+                }
+                const bool stored{k < mat.row_ptr()[i + 1] && mat.col_idx()[k] == j};
+                std::format_to(ctx.out(), "{}", stored ? mat.values()[k++] : 0.0);
+            }
+        }
+        return std::format_to(ctx.out(), "]");
+    }
+};
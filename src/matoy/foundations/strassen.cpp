@@ -0,0 +1,130 @@
+#include "strassen.hpp"
+#include "gemm.hpp"
+#include "matoy/utils/allocator.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <tuple>
+#include <vector>
+
+namespace matoy::foundations {
+
+namespace {
+
+// z = x + y or z = x - y, where z may be x or y.
+template <class T>
+void combine(strided_span<const T> x, strided_span<const T> y, bool subtract, strided_span<T> z) {
+    const size_t m{z.extent(0)}, n{z.extent(1)};
+    const bool rows{x.stride(1) == 1 && y.stride(1) == 1 && z.stride(1) == 1};
+    for (size_t i{0}; i < m && n > 0; i++) {
+        const T *xi{&x[i, 0]}, *yi{&y[i, 0]};
+        T* zi{&z[i, 0]};
+        if (rows && yi != zi) {
+            if (xi != zi) {
+                std::copy_n(xi, n, zi);
+            }
+            subtract ? simd::sub(zi, yi, n) : simd::add(zi, yi, n);
+            continue;
+        }
+        for (size_t j{0}; j < n; j++) {
+            z[i, j] = subtract ? x[i, j] - y[i, j] : x[i, j] + y[i, j];
+        }
+    }
+}
+
+template <class T>
+void strassen_impl(strided_span<const T> a, strided_span<const T> b, strided_span<T> c, size_t crossover) {
+    const size_t m{c.extent(0)}, n{c.extent(1)}, k{a.extent(1)};
+    assert(a.extent(0) == m && b.extent(0) == k && b.extent(1) == n);
+    if (std::min({m, n, k}) < std::max<size_t>(crossover, 2)) {
+        gemm(T{1}, a, b, T{0}, c);
+        return;
+    }
+
+    const size_t m2{m / 2}, n2{n / 2}, k2{k / 2};
+    const auto a11{subview(a, {0, m2}, {0, k2})}, a12{subview(a, {0, m2}, {k2, k2})};
+    const auto a21{subview(a, {m2, m2}, {0, k2})}, a22{subview(a, {m2, m2}, {k2, k2})};
+    const auto b11{subview(b, {0, k2}, {0, n2})}, b12{subview(b, {0, k2}, {n2, n2})};
+    const auto b21{subview(b, {k2, k2}, {0, n2})}, b22{subview(b, {k2, k2}, {n2, n2})};
+    const auto c11{subview(c, {0, m2}, {0, n2})}, c12{subview(c, {0, m2}, {n2, n2})};
+    const auto c21{subview(c, {m2, m2}, {0, n2})}, c22{subview(c, {m2, m2}, {n2, n2})};
+
+    // scratch for the sums S1..S4 of a, T1..T4 of b, and the three products that don't fit in c
+    std::vector<T, utils::default_init_allocator<T, utils::aligned_allocator<T>>> scratch(
+        4 * m2 * k2 + 4 * k2 * n2 + 3 * m2 * n2);
+    T* next{scratch.data()};
+    const auto take = [&next](size_t rows, size_t cols) {
+        const auto res{strided(next, rows, cols, cols, 1)};
+        next += rows * cols;
+        return res;
+    };
+    const auto s1{take(m2, k2)}, s2{take(m2, k2)}, s3{take(m2, k2)}, s4{take(m2, k2)};
+    const auto t1{take(k2, n2)}, t2{take(k2, n2)}, t3{take(k2, n2)}, t4{take(k2, n2)};
+    const auto p1{take(m2, n2)}, p6{take(m2, n2)}, p7{take(m2, n2)};
+
+    combine<T>(a21, a22, false, s1);
+    combine<T>(s1, a11, true, s2);
+    combine<T>(a11, a21, true, s3);
+    combine<T>(a12, s2, true, s4);
+    combine<T>(b12, b11, true, t1);
+    combine<T>(b22, t1, true, t2);
+    combine<T>(b22, b12, true, t3);
+    combine<T>(t2, b21, true, t4);
+
+    // P2 to P5 go straight into the quadrants of c
+    using Product = std::tuple<strided_span<const T>, strided_span<const T>, strided_span<T>>;
+    const std::array<Product, 7> products{{{a11, b11, p1},
+                                          {a12, b21, c11},
+                                          {s4, b22, c12},
+                                          {a22, t4, c21},
+                                          {s1, t1, c22},
+                                          {s2, t2, p6},
+                                          {s3, t3, p7}}};
+    // one after the other, since a nested parallel_for would run the gemm at the leaves on a single thread each
+    for (const auto& [x, y, z] : products) {
+        strassen_impl(x, y, z, crossover);
+    }
+
+    // c11 = P1 + P2, U2 = P1 + P6, U3 = U2 + P7, U4 = U2 + P5,
+    // c12 = U4 + P3, c22 = U3 + P5, c21 = U3 - P4
+    combine<T>(c11, p1, false, c11);
+    combine<T>(p6, p1, false, p6);
+    combine<T>(p7, p6, false, p7);
+    combine<T>(p6, c22, false, p6);
+    combine<T>(c12, p6, false, c12);
+    combine<T>(c22, p7, false, c22);
+    combine<T>(p7, c21, true, c21);
+
+    // the odd inner index adds a rank-1 update, an odd row or column is computed whole
+    if (k % 2 != 0) {
+        gemm(T{1}, subview(a, {0, 2 * m2}, {k - 1, 1}), subview(b, {k - 1, 1}, {0, 2 * n2}), T{1},
+             subview(c, {0, 2 * m2}, {0, 2 * n2}));
+    }
+    if (m % 2 != 0) {
+        gemm(T{1}, subview(a, {m - 1, 1}, {0, k}), b, T{0}, subview(c, {m - 1, 1}, {0, n}));
+    }
+    if (n % 2 != 0) {
+        gemm(T{1}, subview(a, {0, 2 * m2}, {0, k}), subview(b, {0, k}, {n - 1, 1}), T{0},
+             subview(c, {0, 2 * m2}, {n - 1, 1}));
+    }
+}
+
+} // namespace
+
+void strassen(strided_span<const double> a, strided_span<const double> b, strided_span<double> c, size_t crossover) {
+    strassen_impl(a, b, c, crossover);
+}
+
+void strassen(strided_span<const float> a, strided_span<const float> b, strided_span<float> c, size_t crossover) {
+    strassen_impl(a, b, c, crossover);
+}
+
+auto strassen(const Matrix& a, const Matrix& b, size_t crossover) -> Matrix {
+    assert(a.cols() == b.rows());
+    auto res{Matrix::empty(a.rows(), b.cols())};
+    strassen(a.view(), b.view(), res.view(), crossover);
+    return res;
+}
+
+} // namespace matoy::foundations
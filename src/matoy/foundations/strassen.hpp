@@ -0,0 +1,29 @@
+#pragma once
+
+#include "matrix.hpp"
+#include "strided.hpp"
+
+namespace matoy::foundations {
+
+// The recursion hands over to `gemm` once a dimension is smaller than this, chosen with bench_strassen at the default
+// number of threads: a level of recursion saves a few percent on 2048 x 2048 products, two levels beat one by about 10%
+// on 4096 x 4096 ones, and recursing below 2048 costs more in additions and scratch buffers than it saves.
+inline constexpr size_t STRASSEN_CROSSOVER = 2048;
+
+// c = a * b by the Strassen-Winograd recursion, which multiplies the halves of a and b with 7 products and 15
+// additions instead of 8 products, down to `crossover`. The seven products of a level run one after the other, so
+// that each `gemm` at the leaves uses all the threads, and an odd row, column or inner dimension is peeled off and
+// multiplied by `gemm`.
+//
+// This is opt-in because it trades accuracy for speed: its error is only bounded in norm, relative to
+// ||a|| * ||b||, and the bound grows by a factor of up to 18 with each level, so elements much smaller than that
+// product lose relative accuracy. bench_strassen reports the measured error next to the timings. Each level also
+// allocates scratch space of about the size of a and b plus three quarters of the size of c.
+void strassen(strided_span<const double> a, strided_span<const double> b, strided_span<double> c,
+              size_t crossover = STRASSEN_CROSSOVER);
+void strassen(strided_span<const float> a, strided_span<const float> b, strided_span<float> c,
+              size_t crossover = STRASSEN_CROSSOVER);
+
+auto strassen(const Matrix& a, const Matrix& b, size_t crossover = STRASSEN_CROSSOVER) -> Matrix;
+
+} // namespace matoy::foundations
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <mdspan>
+
+namespace matoy::foundations {
+
+template <class T>
+using strided_span = std::mdspan<T, std::dextents<size_t, 2>, std::layout_stride>;
+
+// View the rows x cols block starting at p, whose element (i, j) is p[i * rs + j * cs].
+template <class T>
+auto strided(T* p, size_t rows, size_t cols, size_t rs, size_t cs) -> strided_span<T> {
+    using mapping = std::layout_stride::mapping<std::dextents<size_t, 2>>;
+    return {p, mapping{std::dextents<size_t, 2>{rows, cols}, std::array<size_t, 2>{rs, cs}}};
+}
+
+// The `count` indices start, start + step, start + 2 * step, ... along one dimension.
+struct Slice {
+    size_t start;
+    size_t count;
+    size_t step{1};
+};
+
+// The elements of `v` at the given rows and columns, as a view of the same memory.
+template <class T>
+auto subview(strided_span<T> v, Slice rows, Slice cols) -> strided_span<T> {
+    return strided(v.data_handle() + rows.start * v.stride(0) + cols.start * v.stride(1), rows.count, cols.count,
+                   v.stride(0) * rows.step, v.stride(1) * cols.step);
+}
+
+} // namespace matoy::foundations
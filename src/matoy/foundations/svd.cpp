@@ -0,0 +1,137 @@
+#include "svd.hpp"
+#include "parallel.hpp"
+#include "qr.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <optional>
+
+namespace matoy::foundations {
+
+static constexpr auto EPS = std::numeric_limits<Matrix::value_type>::epsilon();
+
+// Sweeps allowed before giving up. Convergence is quadratic, so well under ten are typical.
+static constexpr size_t MAX_SWEEPS = 30;
+
+// Rotate (x, y) to (c * x - s * y, s * x + c * y).
+static void rotate(double* x, double* y, double c, double s, size_t n) {
+    for (size_t i{0}; i < n; i++) {
+        const double xi{x[i]}, yi{y[i]};
+        x[i] = c * xi - s * yi;
+        y[i] = s * xi + c * yi;
+    }
+}
+
+SVD::SVD(Matrix mat, bool compute_uv)
+    : u_{Matrix::zeros(0, 0)}, v_{Matrix::zeros(0, 0)}, rows_{mat.rows()}, cols_{mat.cols()} {
+    // the SVD of A^T swaps U and V, so only tall matrices are handled below
+    const bool wide{mat.rows() < mat.cols()};
+    if (wide) {
+        mat.transpose();
+    }
+    std::optional<Matrix> q;
+    if (mat.rows() >= 2 * mat.cols() && mat.cols() > 0) {
+        const QR qr{std::move(mat)};
+        if (compute_uv) {
+            q = qr.q();
+        }
+        mat = qr.r();
+    }
+
+    // the columns of A are the rows of ut, so rotations and dot products work on contiguous memory
+    const size_t m{mat.rows()}, n{mat.cols()};
+    Matrix ut{mat.transposed()};
+    ut.set_layout(Layout::RowMajor);
+    Matrix vt{compute_uv ? Matrix::identity(n) : Matrix::zeros(0, 0)};
+    std::vector<value_type> norm2(n);
+    const value_type tol{std::sqrt(static_cast<value_type>(m)) * EPS};
+
+    // Round-robin ordering: with the first entry fixed and the others rotating through the ring, each round pairs
+    // the ring up front to back, and `players - 1` rounds pair everyone with everyone. An odd count gets a dummy.
+    const size_t players{n + n % 2}, pairs{players / 2};
+    std::vector<size_t> ring(players);
+    std::iota(ring.begin(), ring.end(), 0);
+    const size_t tasks{std::max<size_t>(1, std::min(pairs, num_threads()))};
+
+    converged_ = false;
+    for (size_t sweep{0}; sweep < MAX_SWEEPS && !converged_; sweep++) {
+        for (size_t j{0}; j < n; j++) {
+            norm2[j] = simd::dot(&ut[j, 0], &ut[j, 0], m);
+        }
+        std::atomic<size_t> rotations{0};
+        for (size_t round{0}; round + 1 < players; round++) {
+            parallel_for(tasks, [&](size_t t) {
+                for (size_t k{t}; k < pairs; k += tasks) {
+                    const size_t p{ring[k]}, r{ring[players - 1 - k]};
+                    if (p >= n || r >= n) {
+                        continue;
+                    }
+                    const value_type alpha{norm2[p]}, beta{norm2[r]};
+                    const value_type gamma{simd::dot(&ut[p, 0], &ut[r, 0], m)};
+                    if (!(std::abs(gamma) > tol * std::sqrt(alpha * beta))) {
+                        continue;
+                    }
+                    // the smaller root t = tan(theta) of t^2 + 2 * zeta * t - 1 = 0 makes both columns orthogonal
+                    const value_type zeta{(beta - alpha) / (2.0 * gamma)};
+                    const value_type tangent{std::copysign(1.0, zeta) /
+                                             (std::abs(zeta) + std::sqrt(1.0 + zeta * zeta))};
+                    const value_type c{1.0 / std::sqrt(1.0 + tangent * tangent)}, s{c * tangent};
+                    rotate(&ut[p, 0], &ut[r, 0], c, s, m);
+                    if (compute_uv) {
+                        rotate(&vt[p, 0], &vt[r, 0], c, s, n);
+                    }
+                    norm2[p] = alpha - tangent * gamma;
+                    norm2[r] = beta + tangent * gamma;
+                    rotations.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+            std::rotate(ring.begin() + 1, ring.end() - 1, ring.end());
+        }
+        converged_ = rotations.load() == 0;
+    }
+
+    std::vector<value_type> sigma(n);
+    for (size_t j{0}; j < n; j++) {
+        sigma[j] = std::sqrt(simd::dot(&ut[j, 0], &ut[j, 0], m));
+    }
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::stable_sort(order, std::greater{}, [&sigma](size_t j) { return sigma[j]; });
+    values_.resize(n);
+    for (size_t j{0}; j < n; j++) {
+        values_[j] = sigma[order[j]];
+    }
+    if (!compute_uv) {
+        return;
+    }
+
+    // U = A * V * diag(sigma)^-1, which is what the rotated columns hold before scaling
+    auto u{Matrix::zeros(n, m)}, v{Matrix::empty(n, n)};
+    for (size_t j{0}; j < n; j++) {
+        if (values_[j] > 0.0) {
+            simd::axpy(&u[j, 0], 1.0 / values_[j], &ut[order[j], 0], m);
+        }
+        std::copy_n(&vt[order[j], 0], n, &v[j, 0]);
+    }
+    u.transpose();
+    v.transpose();
+    if (q) {
+        u = *q * u;
+    }
+    u_ = wide ? std::move(v) : std::move(u);
+    v_ = wide ? std::move(u) : std::move(v);
+}
+
+auto SVD::rank() const -> size_t {
+    if (values_.empty()) {
+        return 0;
+    }
+    const value_type tol{static_cast<value_type>(std::max(rows_, cols_)) * EPS * values_.front()};
+    return static_cast<size_t>(std::ranges::count_if(values_, [tol](value_type s) { return s > tol; }));
+}
+
+} // namespace matoy::foundations
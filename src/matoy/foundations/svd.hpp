@@ -0,0 +1,54 @@
+#pragma once
+
+#include "matrix.hpp"
+#include <vector>
+
+namespace matoy::foundations {
+
+// Singular value decomposition of an m x n matrix: A = U * diag(values) * V^T, with k = min(m, n) singular values,
+// m x k U and n x k V, both with orthonormal columns.
+//
+// One-sided Jacobi: pairs of columns are rotated until all columns are orthogonal, at which point their norms are
+// the singular values. Each sweep visits every pair in rounds of disjoint pairs, which run in parallel. It is
+// slower than bidiagonalization but accurate to high relative precision, also for tiny singular values.
+// Much taller than wide inputs are reduced to the R of a QR factorization first.
+class SVD {
+  public:
+    using value_type = Matrix::value_type;
+
+    // Without `compute_uv` only the singular values are found, skipping the updates of V.
+    explicit SVD(Matrix mat, bool compute_uv = true);
+
+    // Whether the columns became orthogonal within the sweep limit. The results are approximate otherwise.
+    auto converged() const -> bool {
+        return converged_;
+    }
+
+    // The singular values in descending order.
+    auto values() const -> const std::vector<value_type>& {
+        return values_;
+    }
+
+    // The singular vectors as columns, in the order of `values()`. Empty unless they were requested.
+    // Columns of U belonging to zero singular values are left zero.
+    auto u() const -> const Matrix& {
+        return u_;
+    }
+
+    auto v() const -> const Matrix& {
+        return v_;
+    }
+
+    // The number of singular values above the default tolerance, max(m, n) * eps * the largest one.
+    auto rank() const -> size_t;
+
+  private:
+    std::vector<value_type> values_;
+    Matrix u_;
+    Matrix v_;
+    size_t rows_;
+    size_t cols_;
+    bool converged_{true};
+};
+
+} // namespace matoy::foundations
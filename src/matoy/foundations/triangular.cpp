@@ -0,0 +1,84 @@
+#include "triangular.hpp"
+#include "gemm.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace matoy::foundations {
+
+static constexpr auto EPS = std::numeric_limits<Matrix::value_type>::epsilon();
+
+// Rows substituted directly before the rest is updated with a matrix product.
+static constexpr size_t TRSM_BLOCK = 64;
+
+auto is_triangular(const Matrix& mat, Triangle tri) -> bool {
+    assert(mat.is_square());
+    const size_t n{mat.rows()};
+    for (size_t i{0}; i < n; i++) {
+        const size_t j0{tri == Triangle::Lower ? i + 1 : 0}, j1{tri == Triangle::Lower ? n : i};
+        for (size_t j{j0}; j < j1; j++) {
+            if (mat[i, j] != 0.0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+auto is_symmetric(const Matrix& mat) -> bool {
+    assert(mat.is_square());
+    for (size_t i{0}; i < mat.rows(); i++) {
+        for (size_t j{0}; j < i; j++) {
+            if (mat[i, j] != mat[j, i]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+auto solve_triangular(const Matrix& t, const Matrix& b, Triangle tri) -> std::optional<Matrix> {
+    assert(t.is_square() && t.rows() == b.rows());
+    const size_t n{t.rows()}, m{b.cols()};
+    for (size_t i{0}; i < n; i++) {
+        if (std::abs(t[i, i]) < EPS) {
+            return std::nullopt;
+        }
+    }
+
+    Matrix x{b};
+    x.set_layout(Layout::RowMajor);
+    double* xp{x.data()};
+    const size_t ldx{x.leading_dim()};
+    const double* tp{t.data()};
+    const size_t trs{t.row_stride()}, tcs{t.col_stride()};
+
+    const bool lower{tri == Triangle::Lower};
+    for (size_t done{0}; done < n; done += TRSM_BLOCK) {
+        // blocks are taken from the top of lower triangles and from the bottom of upper ones
+        const size_t len{std::min(TRSM_BLOCK, n - done)};
+        const size_t i0{lower ? done : n - done - len}, i1{i0 + len};
+
+        // X[i0:i1] -= T[i0:i1, s0:s1] * X[s0:s1], where [s0, s1) are the rows solved so far
+        const size_t s0{lower ? 0 : i1}, s1{lower ? i0 : n};
+        if (s1 > s0 && m > 0) {
+            gemm(-1.0, strided(tp + i0 * trs + s0 * tcs, len, s1 - s0, trs, tcs),
+                 strided<const double>(xp + s0 * ldx, s1 - s0, m, ldx, 1), 1.0, strided(xp + i0 * ldx, len, m, ldx, 1));
+        }
+
+        for (size_t k{0}; k < len; k++) {
+            const size_t i{lower ? i0 + k : i1 - 1 - k};
+            const size_t p0{lower ? i0 : i + 1}, p1{lower ? i : i1};
+            for (size_t p{p0}; p < p1; p++) {
+                if (t[i, p] != 0.0) {
+                    x.add_row_multiple(i, p, -t[i, p]);
+                }
+            }
+            x.multiply_row(i, 1.0 / t[i, i]);
+        }
+    }
+    return x;
+}
+
+} // namespace matoy::foundations
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "matrix.hpp"
+#include <cstdint>
+#include <optional>
+
+namespace matoy::foundations {
+
+enum class Triangle : uint8_t {
+    Lower, // zero above the diagonal
+    Upper, // zero below the diagonal
+};
+
+// Whether every element of a square matrix outside the given triangle is zero.
+// The scan stops at the first nonzero, so a general matrix is usually rejected after a few elements.
+auto is_triangular(const Matrix& mat, Triangle tri) -> bool;
+
+// Whether a square matrix equals its transpose, stopping at the first mismatch.
+auto is_symmetric(const Matrix& mat) -> bool;
+
+// Solve T * X = B by forward (lower) or back (upper) substitution, reading only the given triangle of `t`.
+// Rows are substituted in blocks. The contribution of the solved blocks to the next one is a single matrix
+// product, so most of the work runs in `gemm`.
+// Returns nothing if the diagonal has a numerically zero element.
+auto solve_triangular(const Matrix& t, const Matrix& b, Triangle tri) -> std::optional<Matrix>;
+
+} // namespace matoy::foundations
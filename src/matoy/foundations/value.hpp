@@ -1,6 +1,9 @@
 #pragma once
 
+#include "matoy/foundations/band.hpp"
+#include "matoy/foundations/batched.hpp"
 #include "matoy/foundations/matrix.hpp"
+#include "matoy/foundations/sparse.hpp"
 #include <format>
 #include <variant>
 
@@ -21,7 +24,24 @@ using bool_t = bool;
 
 } // namespace values
 
-using Value = std::variant<values::none_t, values::int_t, values::float_t, values::bool_t, Matrix>;
+using Value = std::variant<values::none_t, values::int_t, values::float_t, values::bool_t, Matrix, SparseMatrix, BandMatrix,
+                           BatchedMatrix>;
+
+// A band that covers the whole matrix has no structure left to exploit, so it is stored densely instead.
+inline auto simplify(BandMatrix band) -> Value {
+    return band.is_full() ? Value{band.to_dense()} : Value{std::move(band)};
+}
+
+// Sparse and band matrices are stored densely in place, for operations that only have a dense kernel. The dense
+// matrix, or null if the value isn't a matrix.
+inline auto densify(Value& value) -> Matrix* {
+    if (auto p = std::get_if<SparseMatrix>(&value)) {
+        value = p->to_dense();
+    } else if (auto p = std::get_if<BandMatrix>(&value)) {
+        value = p->to_dense();
+    }
+    return std::get_if<Matrix>(&value);
+}
 
 } // namespace matoy::foundations
 
@@ -2,6 +2,7 @@
 #include "matoy/syntax/chars.hpp"
 #include "matoy/syntax/kind.hpp"
 #include "matoy/utils/ranges.hpp"
+#include <ranges>
 
 namespace matoy::syntax {
 
@@ -55,10 +56,12 @@ auto Matrix::extent() const -> size_t {
     return len;
 }
 
-auto Matrix::shape() const -> std::pair<size_t, size_t> {
-    size_t rows{extent()};
-    size_t cols{n.cast_first_match<MatrixRow>()->extent()};
-    return {rows, cols};
+auto MatrixRow::items() const -> std::vector<Expr> {
+    return n.cast_all_matches<Expr>();
+}
+
+auto Matrix::rows() const -> std::vector<MatrixRow> {
+    return n.cast_all_matches<MatrixRow>();
 }
 
 auto Matrix::items() const -> std::vector<Expr> {
@@ -119,6 +122,49 @@ auto FuncCall::args() const -> Args {
     return n.cast_last_match<Args>().value();
 }
 
+// The expression between the colons number k - 1 and k of a range.
+static auto part(const SyntaxNode& range, size_t k) -> std::optional<Expr> {
+    size_t colons{0};
+    for (auto& ch : range.as_inner()->children) {
+        if (ch.token() == Token::Colon) {
+            colons++;
+        } else if (colons == k) {
+            if (auto expr = ch.cast<Expr>()) {
+                return expr;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+auto Range::start() const -> std::optional<Expr> {
+    return part(n, 0);
+}
+
+auto Range::stop() const -> std::optional<Expr> {
+    return part(n, 1);
+}
+
+auto Range::step() const -> std::optional<Expr> {
+    return part(n, 2);
+}
+
+auto Index::target() const -> Expr {
+    return n.cast_first_match<Expr>().value();
+}
+
+auto Index::subscripts() const -> std::vector<std::variant<Expr, Range>> {
+    std::vector<std::variant<Expr, Range>> res;
+    for (auto& ch : n.as_inner()->children | std::views::drop(1)) {
+        if (auto range = ch.cast<Range>()) {
+            res.emplace_back(*range);
+        } else if (auto expr = ch.cast<Expr>()) {
+            res.emplace_back(*expr);
+        }
+    }
+    return res;
+}
+
 auto Conditional::condition() const -> Expr {
     return n.cast_first_match<Expr>().value();
 }
@@ -181,6 +227,8 @@ IMPL_TYPED(Binary)
 IMPL_TYPED(FieldAccess)
 IMPL_TYPED(FuncCall)
 IMPL_TYPED(Args)
+IMPL_TYPED(Index)
+IMPL_TYPED(Range)
 
 IMPL_TYPED(Conditional)
 IMPL_TYPED(WhileLoop)
@@ -213,6 +261,7 @@ auto from_untyped<ast::Expr>(const SyntaxNode& node) -> std::optional<ast::Expr>
         case SyntaxKind::Binary:        return ast::Binary{node};
         case SyntaxKind::FieldAccess:   return ast::FieldAccess{node};
         case SyntaxKind::FuncCall:      return ast::FuncCall{node};
+        case SyntaxKind::Index:         return ast::Index{node};
         case SyntaxKind::Conditional:   return ast::Conditional{node};
         case SyntaxKind::WhileLoop:     return ast::WhileLoop{node};
         case SyntaxKind::ForLoop:       return ast::ForLoop{node};
@@ -6,6 +6,7 @@
 #include <optional>
 #include <string_view>
 #include <utility>
+#include <variant>
 
 namespace matoy::syntax {
 
@@ -51,12 +52,15 @@ struct Parenthesized : AstNode {
 
 struct MatrixRow : AstNode {
     auto extent() const -> size_t;
+
+    auto items() const -> std::vector<Expr>;
 };
 
+// The items of a matrix literal are scalars or blocks, so its shape is only known once they are evaluated.
 struct Matrix : AstNode {
     auto extent() const -> size_t;
 
-    auto shape() const -> std::pair<size_t, size_t>;
+    auto rows() const -> std::vector<MatrixRow>;
 
     auto items() const -> std::vector<Expr>;
 };
@@ -77,6 +81,22 @@ struct FuncCall : AstNode {
     auto args() const -> Args;
 };
 
+// `start:stop:step` in a subscript, where every part is optional: `:` alone spans the whole dimension.
+struct Range : AstNode {
+    auto start() const -> std::optional<Expr>;
+
+    auto stop() const -> std::optional<Expr>;
+
+    auto step() const -> std::optional<Expr>;
+};
+
+// `A[i, j]`, where each subscript is a single index or a range.
+struct Index : AstNode {
+    auto target() const -> Expr;
+
+    auto subscripts() const -> std::vector<std::variant<Expr, Range>>;
+};
+
 struct Unary : AstNode {
     auto op() const -> UnOp;
 
@@ -139,6 +159,8 @@ IMPL_TYPED(Binary)
 IMPL_TYPED(FieldAccess)
 IMPL_TYPED(FuncCall)
 IMPL_TYPED(Args)
+IMPL_TYPED(Index)
+IMPL_TYPED(Range)
 
 IMPL_TYPED(Conditional)
 IMPL_TYPED(WhileLoop)
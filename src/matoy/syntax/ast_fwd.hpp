@@ -19,6 +19,7 @@ struct Unary;
 struct Binary;
 struct FieldAccess;
 struct FuncCall;
+struct Index;
 
 struct Conditional;
 struct WhileLoop;
@@ -28,6 +29,6 @@ struct LoopContinue;
 struct FuncReturn;
 
 using Expr = std::variant<CodeBlock, Ident, None, Int, Float, Bool, Parenthesized, Matrix, Unary, Binary, FieldAccess,
-                          FuncCall, Conditional, WhileLoop, ForLoop, LoopBreak, LoopContinue, FuncReturn>;
+                          FuncCall, Index, Conditional, WhileLoop, ForLoop, LoopBreak, LoopContinue, FuncReturn>;
 
 } // namespace matoy::syntax::ast
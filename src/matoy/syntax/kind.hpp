@@ -20,6 +20,8 @@ enum class SyntaxKind : int8_t {
     FieldAccess,
     FuncCall,
     Args,
+    Index,
+    Range,
 
     Conditional,
     WhileLoop,
@@ -43,6 +45,8 @@ inline auto get_name(SyntaxKind self) -> std::string_view {
     case SyntaxKind::FieldAccess:   return "field access";
     case SyntaxKind::FuncCall:      return "function call";
     case SyntaxKind::Args:          return "call arguments";
+    case SyntaxKind::Index:         return "index expression";
+    case SyntaxKind::Range:         return "range";
     case SyntaxKind::Conditional:   return "`if` expression";
     case SyntaxKind::WhileLoop:     return "while-loop expression";
     case SyntaxKind::ForLoop:       return "for-loop expression";
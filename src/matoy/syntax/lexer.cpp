@@ -119,6 +119,12 @@ struct Lexer::Impl {
             if (l.s.at(is_digit)) {
                 return number(l, start, c);
             }
+            if (l.s.eat_if('*')) {
+                return Token::DotStar;
+            }
+            if (l.s.eat_if('/')) {
+                return Token::DotSlash;
+            }
             return Token::Dot;
         case '"': return string(l);
         case '+':
@@ -141,6 +147,8 @@ struct Lexer::Impl {
                 return Token::SlashEq;
             }
             return Token::Slash;
+        case '\\': return Token::Backslash;
+        case '^':  return Token::Caret;
         case '!':
             if (l.s.eat_if('=')) {
                 return Token::ExclEq;
@@ -222,7 +230,9 @@ struct Lexer::Impl {
 
         // Next is the fraction part
         bool is_float = false;
-        if (l.s.eat_if('.')) {
+        // `2./a` divides 2 elementwise instead of reading `2.`
+        const bool elementwise_op{l.s.peek() == '.' && (l.s.peek(1) == '*' || l.s.peek(1) == '/')};
+        if (!elementwise_op && l.s.eat_if('.')) {
             is_float = true;
             l.s.eat_while(is_digit);
         }
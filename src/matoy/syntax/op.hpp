@@ -14,10 +14,14 @@ enum class UnOp {
 };
 
 enum class BinOp {
-    Add, // +
-    Sub, // -
-    Mul, // *
-    Div, // /
+    Add,     // +
+    Sub,     // -
+    Mul,     // *
+    Div,     // /
+    ElemMul, // .*
+    ElemDiv, // ./
+    LeftDiv, // \ (left division)
+    Pow,     // ^
 
     Eq,  // ==
     Neq, // !=
@@ -50,26 +54,30 @@ inline auto unop_from_token(Token token) -> std::optional<UnOp> {
 
 inline auto binop_from_token(Token token) -> std::optional<BinOp> {
     switch (token) {
-    case Token::Plus:    return BinOp::Add;
-    case Token::PlusEq:  return BinOp::AddAssign;
-    case Token::Minus:   return BinOp::Sub;
-    case Token::MinusEq: return BinOp::SubAssign;
-    case Token::Star:    return BinOp::Mul;
-    case Token::StarEq:  return BinOp::MulAssign;
-    case Token::Slash:   return BinOp::Div;
-    case Token::SlashEq: return BinOp::DivAssign;
-    case Token::ExclEq:  return BinOp::Neq;
-    case Token::Eq:      return BinOp::Assign;
-    case Token::EqEq:    return BinOp::Eq;
-    case Token::Lt:      return BinOp::Lt;
-    case Token::LtEq:    return BinOp::Leq;
-    case Token::Gt:      return BinOp::Gt;
-    case Token::GtEq:    return BinOp::Geq;
-    case Token::ColonEq: return BinOp::DeclAssign;
-    case Token::TildeEq: return BinOp::Approx;
-    case Token::And:     return BinOp::And;
-    case Token::Or:      return BinOp::Or;
-    default:             return std::nullopt;
+    case Token::Plus:      return BinOp::Add;
+    case Token::PlusEq:    return BinOp::AddAssign;
+    case Token::Minus:     return BinOp::Sub;
+    case Token::MinusEq:   return BinOp::SubAssign;
+    case Token::Star:      return BinOp::Mul;
+    case Token::StarEq:    return BinOp::MulAssign;
+    case Token::Slash:     return BinOp::Div;
+    case Token::SlashEq:   return BinOp::DivAssign;
+    case Token::DotStar:   return BinOp::ElemMul;
+    case Token::DotSlash:  return BinOp::ElemDiv;
+    case Token::Backslash: return BinOp::LeftDiv;
+    case Token::Caret:     return BinOp::Pow;
+    case Token::ExclEq:    return BinOp::Neq;
+    case Token::Eq:        return BinOp::Assign;
+    case Token::EqEq:      return BinOp::Eq;
+    case Token::Lt:        return BinOp::Lt;
+    case Token::LtEq:      return BinOp::Leq;
+    case Token::Gt:        return BinOp::Gt;
+    case Token::GtEq:      return BinOp::Geq;
+    case Token::ColonEq:   return BinOp::DeclAssign;
+    case Token::TildeEq:   return BinOp::Approx;
+    case Token::And:       return BinOp::And;
+    case Token::Or:        return BinOp::Or;
+    default:               return std::nullopt;
     }
 }
 
@@ -81,10 +89,15 @@ inline auto precedence(UnOp op) -> int {
     }
 }
 
+// Powers bind tighter than unary operators, so -a^2 is -(a^2).
 inline auto precedence(BinOp op) -> int {
     switch (op) {
+    case BinOp::Pow:        return 8;
     case BinOp::Mul:
-    case BinOp::Div:        return 6;
+    case BinOp::Div:
+    case BinOp::ElemMul:
+    case BinOp::ElemDiv:
+    case BinOp::LeftDiv:    return 6;
     case BinOp::Add:
     case BinOp::Sub:        return 5;
     case BinOp::Eq:
@@ -111,6 +124,9 @@ inline auto assoc(BinOp op) -> Assoc {
     case BinOp::Sub:
     case BinOp::Mul:
     case BinOp::Div:
+    case BinOp::ElemMul:
+    case BinOp::ElemDiv:
+    case BinOp::LeftDiv:
     case BinOp::Eq:
     case BinOp::Neq:
     case BinOp::Lt:
@@ -120,6 +136,7 @@ inline auto assoc(BinOp op) -> Assoc {
     case BinOp::Approx:
     case BinOp::And:
     case BinOp::Or:         return Assoc::Left;
+    case BinOp::Pow:
     case BinOp::Assign:
     case BinOp::DeclAssign:
     case BinOp::AddAssign:
@@ -49,12 +49,18 @@ struct Parser::Impl {
         }
 
         while (true) {
-            if (p.directly_at(Token::LParen) || p.directly_at(Token::LBracket)) {
+            if (p.directly_at(Token::LParen)) {
                 args(p);
                 p.reduce(m, SyntaxKind::FuncCall);
                 continue;
             }
 
+            if (p.directly_at(Token::LBracket)) {
+                subscripts(p);
+                p.reduce(m, SyntaxKind::Index);
+                continue;
+            }
+
             auto at_field_or_method = p.directly_at(Token::Dot) && Lexer{p.lexer}.next_token() == Token::Ident;
             if (atomic && !at_field_or_method) {
                 break;
@@ -156,8 +162,48 @@ struct Parser::Impl {
         p.reduce(m, SyntaxKind::Args);
     }
 
+    // Parses the subscripts of an index expression: `[i, j]`, `[:, 1:3]` or `[0:n:2, j]`.
+    static auto subscripts(Parser& p) -> void {
+        auto m = p.marker();
+        p.assert_cur(Token::LBracket);
+
+        while (!is_terminator(p.current)) {
+            if (!p.at(sets::expr) && !p.at(Token::Colon)) {
+                p.unexpected();
+                continue;
+            }
+
+            subscript(p);
+
+            if (!is_terminator(p.current)) {
+                p.expect(Token::Comma);
+            }
+        }
+
+        p.expect_closing_delimiter(m, Token::RBracket);
+    }
+
+    // Parses a single index, or a range `start:stop` or `start:stop:step` with optional parts.
+    static auto subscript(Parser& p) -> void {
+        auto m = p.marker();
+        if (!p.at(Token::Colon)) {
+            code_expr(p);
+            if (!p.at(Token::Colon)) {
+                return;
+            }
+        }
+        for (int part{0}; part < 2 && p.eat_if(Token::Colon); part++) {
+            if (p.at(sets::expr)) {
+                code_expr(p);
+            }
+        }
+        p.reduce(m, SyntaxKind::Range);
+    }
+
     /**
-     * @brief Parse a matrix: `[1, 2; 3, 4]`
+     * @brief Parse a matrix: `[1, 2; 3, 4]`, or with blocks `[A, b; c, d]`
+     *
+     * The items may be matrices themselves, so the shape is checked when the matrix is evaluated.
      */
     static auto matrix(Parser& p) -> void {
         auto m = p.marker();
@@ -165,34 +211,17 @@ struct Parser::Impl {
 
         p.assert_cur(Token::LBracket);
 
-        size_t rows{}, cols{}, cur_col{};
-
         while (!is_terminator(p.current)) {
             code_expr(p);
             switch (p.current) {
-            case Token::Comma:
-                p.eat();
-                cur_col++;
-                if (rows == 0) {
-                    cols++;
-                }
-                break;
+            case Token::Comma: p.eat(); break;
             case Token::Semicolon:
                 p.eat();
-                cur_col++;
-                if (rows++ == 0) {
-                    cols = cur_col;
-                } else if (cur_col != cols) {
-                    // check shape
-                    p.expected("the same column size");
-                }
                 // finishes a row
                 p.reduce(m1, SyntaxKind::MatrixRow);
                 m1 = p.marker();
-                cur_col = 0;
                 break;
             case Token::RBracket:
-                rows++;
                 p.reduce(m1, SyntaxKind::MatrixRow);
                 m1 = p.marker();
                 break;
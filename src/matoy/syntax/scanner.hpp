@@ -26,11 +26,11 @@ class Scanner {
         return str_.substr(0, start);
     }
 
-    std::optional<char> peek() const {
-        if (cursor_ == str_.length()) {
+    std::optional<char> peek(size_t offset = 0) const {
+        if (cursor_ + offset >= str_.length()) {
             return std::nullopt;
         } else {
-            return str_[cursor_];
+            return str_[cursor_ + offset];
         }
     }
 
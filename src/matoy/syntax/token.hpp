@@ -19,25 +19,29 @@ enum class Token : int8_t {
     Colon,     // :
     Semicolon, // ;
 
-    Plus,    // +
-    PlusEq,  // +=
-    Minus,   // -
-    MinusEq, // -=
-    Star,    // *
-    StarEq,  // *=
-    Slash,   // /
-    SlashEq, // /=
-    Excl,    // !
-    ExclEq,  // !=
-    Eq,      // =
-    EqEq,    // ==
-    Lt,      // <
-    LtEq,    // <=
-    Gt,      //  >
-    GtEq,    // >=
-    ColonEq, // :=
-    Tilde,   // ~
-    TildeEq, // ~=
+    Plus,      // +
+    PlusEq,    // +=
+    Minus,     // -
+    MinusEq,   // -=
+    Star,      // *
+    StarEq,    // *=
+    Slash,     // /
+    SlashEq,   // /=
+    DotStar,   // .* (elementwise multiplication)
+    DotSlash,  // ./ (elementwise division)
+    Backslash, // \ (left division)
+    Caret,     // ^
+    Excl,      // !
+    ExclEq,    // !=
+    Eq,        // =
+    EqEq,      // ==
+    Lt,        // <
+    LtEq,      // <=
+    Gt,        //  >
+    GtEq,      // >=
+    ColonEq,   // :=
+    Tilde,     // ~
+    TildeEq,   // ~=
 
     LParen,   // (
     RParen,   // )
@@ -100,25 +104,29 @@ inline auto get_name(Token self) -> std::string_view {
     case Token::Colon:     return "colon";
     case Token::Semicolon: return "semicolon";
 
-    case Token::Plus:    return "plus";
-    case Token::PlusEq:  return "add-assign operator";
-    case Token::Minus:   return "minus";
-    case Token::MinusEq: return "subtract-assign operator";
-    case Token::Star:    return "star";
-    case Token::StarEq:  return "multiply-assign operator";
-    case Token::Slash:   return "slash";
-    case Token::SlashEq: return "divide-assign operator";
-    case Token::Excl:    return "not";
-    case Token::ExclEq:  return "inequality operator";
-    case Token::Eq:      return "equals sign";
-    case Token::EqEq:    return "equality operator";
-    case Token::Lt:      return "less-than operator";
-    case Token::LtEq:    return "less-than or equal operator";
-    case Token::Gt:      return "greater-than operator";
-    case Token::GtEq:    return "greater-than or equal operator";
-    case Token::ColonEq: return "declaration-assign operator";
-    case Token::Tilde:   return "tilde";
-    case Token::TildeEq: return "approximate equality operator";
+    case Token::Plus:      return "plus";
+    case Token::PlusEq:    return "add-assign operator";
+    case Token::Minus:     return "minus";
+    case Token::MinusEq:   return "subtract-assign operator";
+    case Token::Star:      return "star";
+    case Token::StarEq:    return "multiply-assign operator";
+    case Token::Slash:     return "slash";
+    case Token::SlashEq:   return "divide-assign operator";
+    case Token::DotStar:   return "elementwise multiplication operator";
+    case Token::DotSlash:  return "elementwise division operator";
+    case Token::Backslash: return "backslash";
+    case Token::Caret:     return "caret";
+    case Token::Excl:      return "not";
+    case Token::ExclEq:    return "inequality operator";
+    case Token::Eq:        return "equals sign";
+    case Token::EqEq:      return "equality operator";
+    case Token::Lt:        return "less-than operator";
+    case Token::LtEq:      return "less-than or equal operator";
+    case Token::Gt:        return "greater-than operator";
+    case Token::GtEq:      return "greater-than or equal operator";
+    case Token::ColonEq:   return "declaration-assign operator";
+    case Token::Tilde:     return "tilde";
+    case Token::TildeEq:   return "approximate equality operator";
 
     case Token::LParen:   return "opening paren";
     case Token::RParen:   return "closing paren";
@@ -55,10 +55,11 @@ inline constexpr TokenSet primary{atomic_primary};
 inline constexpr TokenSet unary_op{Token::Plus, Token::Minus, Token::Not};
 
 /// Syntax kinds that are binary operators.
-inline constexpr TokenSet binary_op{Token::Plus,    Token::Minus,   Token::Star,    Token::Slash,  Token::PlusEq,
-                                    Token::MinusEq, Token::StarEq,  Token::SlashEq, Token::ExclEq, Token::Eq,
-                                    Token::EqEq,    Token::Lt,      Token::LtEq,    Token::Gt,     Token::GtEq,
-                                    Token::ColonEq, Token::TildeEq, Token::And,     Token::Or,     Token::In};
+inline constexpr TokenSet binary_op{Token::Plus,      Token::Minus,   Token::Star,    Token::Slash,  Token::PlusEq,
+                                    Token::MinusEq,   Token::StarEq,  Token::SlashEq, Token::ExclEq, Token::Eq,
+                                    Token::EqEq,      Token::Lt,      Token::LtEq,    Token::Gt,     Token::GtEq,
+                                    Token::ColonEq,   Token::TildeEq, Token::And,     Token::Or,     Token::In,
+                                    Token::Backslash, Token::Caret,   Token::DotStar, Token::DotSlash};
 
 /// Syntax kinds that can start an atomic code expression.
 inline constexpr TokenSet atomic_expr{atomic_primary};
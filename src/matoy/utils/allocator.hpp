@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace matoy::utils {
+
+// An allocator that default-initializes elements instead of value-initializing them,
+// so that growing a vector of trivial types leaves the new elements uninitialized.
+template <class T, class A = std::allocator<T>>
+class default_init_allocator : public A {
+    using traits = std::allocator_traits<A>;
+
+  public:
+    template <class U>
+    struct rebind {
+        using other = default_init_allocator<U, typename traits::template rebind_alloc<U>>;
+    };
+
+    using A::A;
+
+    template <class U>
+    void construct(U* ptr) noexcept(std::is_nothrow_default_constructible_v<U>) {
+        ::new (static_cast<void*>(ptr)) U;
+    }
+
+    template <class U, class... Args>
+    void construct(U* ptr, Args&&... args) {
+        traits::construct(static_cast<A&>(*this), ptr, std::forward<Args>(args)...);
+    }
+};
+
+// An allocator whose blocks start on an `Align`-byte boundary, so that SIMD loads from the start of a block
+// never split a cache line. Blocks of at least `huge_page_size` bytes are aligned to that size instead and,
+// on Linux, advised to be backed by transparent huge pages, which saves TLB misses when streaming through them.
+template <class T, size_t Align = 64>
+class aligned_allocator {
+  public:
+    using value_type = T;
+
+    static constexpr size_t huge_page_size = size_t{2} << 20;
+
+    template <class U>
+    struct rebind {
+        using other = aligned_allocator<U, Align>;
+    };
+
+    aligned_allocator() noexcept = default;
+
+    template <class U>
+    aligned_allocator(const aligned_allocator<U, Align>&) noexcept {}
+
+    auto allocate(size_t n) -> T* {
+        const size_t bytes{n * sizeof(T)};
+        void* ptr{::operator new(bytes, alignment(bytes))};
+#ifdef __linux__
+        if (bytes >= huge_page_size) {
+            ::madvise(ptr, bytes, MADV_HUGEPAGE); // only a hint, failure is harmless
+        }
+#endif
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        ::operator delete(ptr, alignment(n * sizeof(T)));
+    }
+
+    template <class U>
+    auto operator==(const aligned_allocator<U, Align>&) const noexcept -> bool {
+        return true;
+    }
+
+  private:
+    static auto alignment(size_t bytes) -> std::align_val_t {
+        return std::align_val_t{bytes >= huge_page_size ? huge_page_size : std::max(Align, alignof(T))};
+    }
+};
+
+} // namespace matoy::utils
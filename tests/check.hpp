@@ -0,0 +1,71 @@
+#pragma once
+
+#include "matoy/foundations/matrix.hpp"
+#include <algorithm>
+#include <cmath>
+#include <print>
+#include <random>
+
+// Helpers shared by the tests. A test reports each check with `expect` and returns `failures == 0 ? 0 : 1`.
+namespace matoy::tests {
+
+using foundations::BasicMatrix;
+using foundations::Matrix;
+
+inline int failures{0};
+
+inline void expect(const char* what, bool ok) {
+    std::println("{}: {}", what, ok ? "ok" : "FAILED");
+    failures += !ok;
+}
+
+// Elements drawn uniformly from [-1, 1], row by row.
+inline Matrix random_matrix(size_t rows, size_t cols, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> dist{-1.0, 1.0};
+    auto res{Matrix::empty(rows, cols)};
+    for (size_t i{0}; i < rows; i++) {
+        for (size_t j{0}; j < cols; j++) {
+            res[i, j] = dist(rng);
+        }
+    }
+    return res;
+}
+
+// start, start + 1, ... row by row, so that every element tells where it came from.
+inline Matrix sequence(size_t rows, size_t cols, double start = 0.0) {
+    auto res{Matrix::empty(rows, cols)};
+    for (size_t i{0}; i < rows; i++) {
+        for (size_t j{0}; j < cols; j++) {
+            res[i, j] = start + static_cast<double>(i * cols + j);
+        }
+    }
+    return res;
+}
+
+// Same shape, and every element within `tol` relative to the expected one, or absolute below 1.
+inline bool close(const Matrix& a, const Matrix& expected, double tol = 1e-10) {
+    if (a.shape() != expected.shape()) {
+        return false;
+    }
+    for (size_t i{0}; i < a.rows(); i++) {
+        for (size_t j{0}; j < a.cols(); j++) {
+            if (std::abs(a[i, j] - expected[i, j]) > tol * (1.0 + std::abs(expected[i, j]))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <class T>
+double max_abs(const BasicMatrix<T>& m) {
+    double res{0.0};
+    for (size_t i{0}; i < m.rows(); i++) {
+        for (size_t j{0}; j < m.cols(); j++) {
+            res = std::max(res, std::abs(static_cast<double>(m[i, j])));
+        }
+    }
+    return res;
+}
+
+} // namespace matoy::tests
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "check.hpp"
+#include "matoy/eval/eval.hpp"
+#include "matoy/eval/vm.hpp"
+#include <optional>
+#include <string_view>
+
+// Tests of the language, which run statements through the interpreter the way the console does.
+namespace matoy::tests {
+
+using foundations::Value;
+
+// One interpreter session: variables defined by a statement stay visible to the next ones.
+class Script {
+  public:
+    auto run(std::string_view source) -> diag::SourceResult<Value> {
+        return eval::eval_string(source, vm_);
+    }
+
+    // The matrix that `source` evaluates to, or nothing if it fails or gives another kind of value.
+    auto matrix(std::string_view source) -> std::optional<Matrix> {
+        auto res = run(source);
+        if (!res || !std::holds_alternative<Matrix>(*res)) {
+            return std::nullopt;
+        }
+        return std::get<Matrix>(std::move(*res));
+    }
+
+    // The number that `source` evaluates to, or nothing if it fails or gives another kind of value.
+    auto scalar(std::string_view source) -> std::optional<double> {
+        const auto res = run(source);
+        if (res && std::holds_alternative<foundations::values::int_t>(*res)) {
+            return static_cast<double>(std::get<foundations::values::int_t>(*res));
+        }
+        if (res && std::holds_alternative<foundations::values::float_t>(*res)) {
+            return std::get<foundations::values::float_t>(*res);
+        }
+        return std::nullopt;
+    }
+
+    // The truth value that `source` evaluates to, or nothing if it fails or gives another kind of value.
+    auto boolean(std::string_view source) -> std::optional<bool> {
+        const auto res = run(source);
+        if (res && std::holds_alternative<foundations::values::bool_t>(*res)) {
+            return std::get<foundations::values::bool_t>(*res);
+        }
+        return std::nullopt;
+    }
+
+    // Whether `source` fails with an error whose message or hints contain `message`.
+    auto fails_with(std::string_view source, std::string_view message) -> bool {
+        const auto res = run(source);
+        if (res) {
+            return false;
+        }
+        for (const auto& diagnostic : res.error()) {
+            if (diagnostic.message.contains(message)) {
+                return true;
+            }
+            for (const auto& hint : diagnostic.hints) {
+                if (hint.contains(message)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+  private:
+    eval::Vm vm_;
+};
+
+} // namespace matoy::tests
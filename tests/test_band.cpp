@@ -0,0 +1,106 @@
+#include "matoy/foundations/band.hpp"
+#include "matoy/foundations/lu.hpp"
+#include "script.hpp"
+#include <cmath>
+#include <print>
+#include <random>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+BandMatrix random_band(size_t n, size_t lower, size_t upper, std::mt19937_64& rng, double diag_shift = 0.0) {
+    std::uniform_real_distribution<double> dist{-1.0, 1.0};
+    auto res{Matrix::zeros(n, n)};
+    for (size_t i{0}; i < n; i++) {
+        for (size_t j{0}; j < n; j++) {
+            if (j + lower >= i && j <= i + upper) {
+                res[i, j] = dist(rng) + (i == j ? diag_shift : 0.0);
+            }
+        }
+    }
+    return BandMatrix::from_dense(res, lower, upper);
+}
+
+// Check solve and det of a band against the dense LU path.
+bool check_solve(const BandMatrix& a, const Matrix& b) {
+    const Matrix dense{a.to_dense()};
+    const LU lu{dense};
+    const auto x{a.solve(b)};
+    return x && close(dense * *x, b) && std::abs(a.det() - lu.det()) <= 1e-10 * (1.0 + std::abs(lu.det()));
+}
+
+int main() {
+    std::mt19937_64 rng{13};
+    const size_t n{60};
+    const Matrix b{random_matrix(n, 3, rng)}, d{random_matrix(n, n, rng)};
+
+    const auto diag{random_band(n, 0, 0, rng, 2.0)};
+    const auto lower{random_band(n, 3, 0, rng, 4.0)}, upper{random_band(n, 0, 5, rng, 4.0)};
+    const auto tri_dominant{random_band(n, 1, 1, rng, 3.0)}, tri{random_band(n, 1, 1, rng)};
+    const auto wide{random_band(n, 4, 2, rng)};
+
+    expect("dense round trip", BandMatrix{wide.to_dense()} == wide && BandMatrix{wide.to_dense()}.lower() == 4);
+    expect("identity", BandMatrix::identity(n) * d == d && d * BandMatrix::identity(n) == d);
+    expect("band x dense", close(wide * d, wide.to_dense() * d) && close(d * wide, d * wide.to_dense()));
+    expect("band x column-major", close(wide * d.transposed(), wide.to_dense() * d.transposed()));
+    expect("band x band", close((wide * lower).to_dense(), wide.to_dense() * lower.to_dense()) &&
+                              (diag * diag).is_diagonal() && (lower * lower).is_lower_triangular());
+    expect("transposed", wide.transposed().to_dense() == wide.to_dense().transposed());
+    expect("band + band", (lower + upper).to_dense() == Matrix(lower.to_dense() + upper.to_dense()) &&
+                              (wide - wide).to_dense() == Matrix::zeros(n, n));
+    expect("band + dense", wide + d == Matrix(wide.to_dense() + d) && wide - d == Matrix(wide.to_dense() - d) &&
+                               d - wide == Matrix(d - wide.to_dense()));
+    expect("scalar", (2.0 * wide / 4.0).to_dense() == Matrix(wide.to_dense() * 2.0 / 4.0));
+
+    expect("diagonal solve", check_solve(diag, b));
+    expect("lower solve", check_solve(lower, b));
+    expect("upper solve", check_solve(upper, b));
+    expect("thomas", check_solve(tri_dominant, b));
+    expect("tridiagonal with pivoting", check_solve(tri, b));
+    expect("banded LU", check_solve(wide, b) && check_solve(wide.transposed(), b));
+
+    // inverses keep the shape where it is preserved
+    const auto diag_inv{diag.inverse()}, lower_inv{lower.inverse()}, wide_inv{wide.inverse()};
+    expect("inverse", diag_inv && diag_inv->is_diagonal() && lower_inv && lower_inv->is_lower_triangular() &&
+                          wide_inv && wide_inv->is_full() &&
+                          close((lower * *lower_inv).to_dense(), Matrix::identity(n)) &&
+                          close(wide.to_dense() * wide_inv->to_dense(), Matrix::identity(n)));
+
+    // singular bands are reported, not divided by zero
+    auto singular{BandMatrix::identity(4)};
+    singular[2, 2] = 0.0;
+    expect("singular", !singular.solve(Matrix::identity(4)) && singular.det() == 0.0 && !singular.inverse());
+
+    // the interpreter reports operands whose shapes don't fit
+    Script script;
+    script.run("B := band([1, 2, 3, 4; 5, 6, 7, 8; 9, 10, 11, 12; 13, 14, 15, 16], 1, 1)");
+    expect("shape errors",
+           script.fails_with("B + [1, 2, 3; 4, 5, 6; 7, 8, 9]", "cannot add matrices of shapes 4x4 and 3x3") &&
+               script.fails_with("eye(3) - eye(4)", "cannot subtract matrices of shapes 3x3 and 4x4") &&
+               script.fails_with("[1, 2, 3] - eye(3)", "shapes 1x3 and 3x3") &&
+               script.fails_with("eye(3) * [1, 2]", "cannot multiply matrices of shapes 3x3 and 1x2") &&
+               script.fails_with("[1, 2] * eye(3)", "shapes 1x2 and 3x3") &&
+               script.fails_with("diag([1, 2]) * eye(3)", "shapes 2x2 and 3x3") &&
+               script.matrix("eye(2) + [1, 2; 3, 4]") == Matrix{{2, 2}, {3, 5}});
+
+    // bands are matrices like any other outside their own kernels
+    script.run("A := [4, 2, 0; 2, 5, 3; 0, 3, 6]");
+    expect("comparisons", script.boolean("eye(2) == [1, 0; 0, 1]") == true &&
+                              script.boolean("[1, 0; 0, 2] == diag([1, 2])") == true &&
+                              script.boolean("tril(A) == A") == false && script.boolean("eye(2) == eye(3)") == false &&
+                              script.boolean("eye(2) ~= [1, 0; 0, 1]") == true);
+    script.run("L := chol(A)");
+    script.run("L[1, 0] = 0");
+    expect("indexing", script.scalar("tril(A)[1, 0]") == 2.0 && script.scalar("triu(A)[1, 0]") == 0.0 &&
+                           script.matrix("eye(3)[0:2, 1]") == Matrix{{0}, {1}} && script.scalar("L[1, 0]") == 0.0 &&
+                           script.scalar("L[0, 0]") == 2.0);
+    expect("builtins", script.matrix("sum(eye(3), 1)") == Matrix{{1, 1, 1}} &&
+                           script.scalar("norm(tril(A), 1)") == 8.0 &&
+                           script.boolean("eig(eye(3)) ~= [1; 1; 1]") == true &&
+                           script.boolean("lstsq(eye(2), [1; 2]) ~= [1; 2]") == true);
+    expect("fields", script.scalar("tril(A).sum") == 20.0 && script.scalar("eye(4).max") == 1.0 &&
+                         script.fails_with("eye(2).foo", "does not contain field"));
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+#include "matoy/foundations/batched.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include "script.hpp"
+#include <cmath>
+#include <format>
+#include <print>
+#include <random>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+BatchedMatrix random_batch(size_t count, size_t rows, size_t cols, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> dist{-1.0, 1.0};
+    BatchedMatrix res(count, rows, cols);
+    for (size_t k{0}; k < count; k++) {
+        for (size_t i{0}; i < rows; i++) {
+            for (size_t j{0}; j < cols; j++) {
+                res[k, i, j] = dist(rng);
+            }
+        }
+    }
+    return res;
+}
+
+// Compare each matrix of a batched result with the one computed per matrix.
+template <class F>
+bool matches(const BatchedMatrix& batch, F per_matrix, double tol = 1e-10) {
+    for (size_t k{0}; k < batch.count(); k++) {
+        if (!close(batch.matrix(k), per_matrix(k), tol)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    std::mt19937_64 rng{19};
+
+    // counts around the lane block exercise the padding lanes
+    for (size_t count : {1, 5, 8, 13, 1000}) {
+        for (size_t n : {1, 2, 3, 4, 6}) {
+            const auto a{random_batch(count, n, n, rng)}, b{random_batch(count, n, n, rng)};
+            const auto m{random_batch(1, n, n, rng).matrix(0)};
+            const auto name{std::format("{} x {}x{}", count, n, n)};
+
+            const bool ops{matches(a + b, [&](size_t k) { return Matrix(a.matrix(k) + b.matrix(k)); }) &&
+                           matches(a - m, [&](size_t k) { return Matrix(a.matrix(k) - m); }) &&
+                           matches(m - a, [&](size_t k) { return Matrix(m - a.matrix(k)); }) &&
+                           matches(2.0 * a / 4.0, [&](size_t k) { return Matrix(a.matrix(k) * 0.5); }) &&
+                           matches(-a, [&](size_t k) { return Matrix(-a.matrix(k)); })};
+            expect(std::format("{} elementwise", name).c_str(), ops);
+
+            const bool products{matches(a * b, [&](size_t k) { return a.matrix(k) * b.matrix(k); }) &&
+                                matches(a * m, [&](size_t k) { return a.matrix(k) * m; }) &&
+                                matches(m * a, [&](size_t k) { return m * a.matrix(k); })};
+            expect(std::format("{} products", name).c_str(), products);
+
+            const auto dets{a.det()};
+            bool det_ok{dets.rows() == count && dets.cols() == 1};
+            for (size_t k{0}; det_ok && k < count; k++) {
+                const double expected{det(a.matrix(k))};
+                det_ok = std::abs(dets[k, 0] - expected) <= 1e-12 * (1.0 + std::abs(expected));
+            }
+            const auto inv{a.inverse()};
+            expect(std::format("{} det and inverse", name).c_str(),
+                   det_ok && inv && matches(*inv, [&](size_t k) { return *inverse(a.matrix(k)); }, 1e-8));
+        }
+    }
+
+    // non-square products and transposes
+    const auto tall{random_batch(11, 4, 2, rng)}, wide{random_batch(11, 2, 3, rng)};
+    expect("rectangular", matches(tall * wide, [&](size_t k) { return tall.matrix(k) * wide.matrix(k); }) &&
+                              matches(tall.transposed(), [&](size_t k) { return tall.matrix(k).transposed(); }));
+
+    // stacking round-trips, and the layout puts one element of all matrices together
+    const Matrix stacked{{1, 2}, {3, 4}, {5, 6}, {7, 8}};
+    const auto batch{BatchedMatrix::from_stacked(stacked, 2)};
+    expect("stacked", batch.count() == 2 && batch.matrix(1) == Matrix{{5, 6}, {7, 8}} &&
+                          batch.to_stacked() == stacked && batch.lanes(0, 1)[1] == 6.0 &&
+                          BatchedMatrix::repeat(stacked, 3).matrix(2) == stacked);
+    expect("format", std::format("{}", batch) == "{[1, 2; 3, 4], [5, 6; 7, 8]}");
+
+    // one singular matrix makes the inverse fail, and its determinant is exactly zero
+    for (size_t n : {2, 3, 4, 5}) {
+        auto singular{BatchedMatrix::repeat(Matrix::identity(n), 9)};
+        for (size_t j{0}; j < n; j++) {
+            singular[6, 1, j] = singular[6, 0, j];
+        }
+        const auto dets{singular.det()};
+        expect(std::format("singular {}x{}", n, n).c_str(),
+               !singular.inverse() && dets[6, 0] == 0.0 && dets[5, 0] == 1.0);
+    }
+
+    // the interpreter reports operands whose counts or shapes don't fit
+    Script script;
+    script.run("X := batch([1, 2; 3, 4; 5, 6; 7, 8], 2)");
+    expect("shape errors",
+           script.fails_with("X + batch([1, 2; 3, 4; 5, 6; 7, 8; 9, 10; 11, 12], 2)",
+                             "cannot add batches of 2 and 3 matrices") &&
+               script.fails_with("X - batch([1, 2, 3; 4, 5, 6; 7, 8, 9; 10, 11, 12], 2)",
+                                 "cannot subtract matrices of shapes 2x2 and 2x3") &&
+               script.fails_with("X + [1, 2, 3]", "cannot add matrices of shapes 2x2 and 1x3") &&
+               script.fails_with("[1; 2] - X", "shapes 2x1 and 2x2") &&
+               script.fails_with("X * batch([1; 2; 3; 4; 5; 6], 3)",
+                                 "cannot multiply matrices of shapes 2x2 and 3x1") &&
+               script.fails_with("X * [1, 2]", "shapes 2x2 and 1x2") &&
+               script.fails_with("[1, 2, 3] * X", "shapes 1x3 and 2x2") &&
+               script.run("X * [1; 1]").has_value());
+
+    return failures == 0 ? 0 : 1;
+}
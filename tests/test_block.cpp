@@ -0,0 +1,44 @@
+#include "check.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include <print>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+int main() {
+    // [A, B; C, D] matches the pairwise concatenations, with blocks in both layouts and with padding
+    for (size_t n : {2, 3, 40}) {
+        const auto a{sequence(n, n + 1, 0.0)}, b{sequence(n, 2, 1000.0)}, c{sequence(3, 2, 2000.0)};
+        auto d{sequence(3, n + 1, 3000.0)};
+        d.set_layout(Layout::ColMajor);
+        auto padded_c{c};
+        padded_c.set_leading_dim(Matrix::padded_leading_dim(c.cols()));
+        const auto expected{concat_v(concat_h(a, b), concat_h(c, d))};
+
+        const std::vector<std::vector<Matrix>> rows{{a, b}, {padded_c, d}};
+        const auto res{block_matrix(rows)};
+        expect(std::format("{}x{} blocks", n, n).c_str(),
+               res && *res == expected && res->shape() == std::pair{n + 3, n + 3});
+
+        // rows with different numbers of blocks, and a block spanning a whole row
+        const std::vector<std::vector<Matrix>> uneven{{concat_h(a, b)},
+                                                      {c, sequence(3, n, 0.0), Matrix{{1.0}, {2.0}, {3.0}}}};
+        const auto mixed{block_matrix(uneven)};
+        expect(std::format("{}x{} uneven rows", n, n).c_str(),
+               mixed && (*mixed)[n, 1] == c[0, 1] && (*mixed)[n + 2, n + 2] == 3.0 &&
+                   (*mixed)[n - 1, n + 2] == b[n - 1, 1]);
+    }
+
+    // a single block is returned without copying its buffer
+    const auto big{sequence(20, 20, 0.0)};
+    const auto same{block_matrix(std::vector<std::vector<Matrix>>{{big}})};
+    expect("single block", same && same->data() == big.data());
+
+    const auto a{sequence(2, 2, 0.0)};
+    expect("mismatched rows", !block_matrix(std::vector<std::vector<Matrix>>{{a, sequence(3, 1, 0.0)}}));
+    expect("mismatched columns", !block_matrix(std::vector<std::vector<Matrix>>{{a}, {sequence(1, 3, 0.0)}}));
+    expect("empty", block_matrix(std::vector<std::vector<Matrix>>{})->size() == 0);
+
+    return failures == 0 ? 0 : 1;
+}
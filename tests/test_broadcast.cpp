@@ -0,0 +1,86 @@
+#include "check.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include <print>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+// The expanded operand, built the slow way.
+Matrix tile(const Matrix& vec, size_t rows, size_t cols) {
+    auto res{Matrix::empty(rows, cols)};
+    for (size_t i{0}; i < rows; i++) {
+        for (size_t j{0}; j < cols; j++) {
+            res[i, j] = vec[vec.rows() == 1 ? 0 : i, vec.cols() == 1 ? 0 : j];
+        }
+    }
+    return res;
+}
+
+int main() {
+    using Shape = std::pair<size_t, size_t>;
+    expect("shapes", broadcast_shape({3, 4}, {3, 4}) == Shape{3, 4} && broadcast_shape({3, 4}, {1, 4}) == Shape{3, 4} &&
+                         broadcast_shape({3, 1}, {3, 4}) == Shape{3, 4} &&
+                         broadcast_shape({3, 1}, {1, 4}) == Shape{3, 4} &&
+                         broadcast_shape({1, 1}, {3, 4}) == Shape{3, 4} && !broadcast_shape({3, 4}, {4, 3}) &&
+                         !broadcast_shape({3, 4}, {2, 1}));
+
+    // sizes on both sides of the inline capacity, and operands in both layouts
+    for (size_t n : {3, 37}) {
+        const size_t m{n + 2};
+        const auto a{sequence(n, m, 1.0)}, row{sequence(1, m, 1.0)}, col{sequence(n, 1, 1.0)};
+        const auto a_col_major{[&] {
+            Matrix x{a};
+            x.set_layout(Layout::ColMajor);
+            return x;
+        }()};
+        bool ok{true};
+        for (const Matrix* lhs : {&a, &a_col_major}) {
+            for (const Matrix* vec : {&row, &col}) {
+                const auto full{tile(*vec, n, m)};
+                ok = ok && broadcast_add(*lhs, *vec) == Matrix(*lhs + full) &&
+                     broadcast_sub(*vec, *lhs) == Matrix(full - *lhs) && *broadcast_mul(*lhs, *vec) == [&] {
+                         auto res{Matrix::empty(n, m)};
+                         for (size_t i{0}; i < n; i++) {
+                             for (size_t j{0}; j < m; j++) {
+                                 res[i, j] = (*lhs)[i, j] * full[i, j];
+                             }
+                         }
+                         return res;
+                     }();
+                const auto quotient{*broadcast_div(*vec, *lhs)};
+                for (size_t i{0}; i < n; i++) {
+                    for (size_t j{0}; j < m; j++) {
+                        ok = ok && quotient[i, j] == full[i, j] / (*lhs)[i, j];
+                    }
+                }
+            }
+        }
+        expect(std::format("{}x{} vectors", n, m).c_str(), ok);
+
+        // a row against a column spans both, and a 1 x 1 operand acts like a scalar
+        const auto outer{*broadcast_mul(col, row)};
+        expect(std::format("{}x{} outer", n, m).c_str(),
+               outer.shape() == Shape{n, m} && outer == col * row &&
+                   broadcast_sub(a, Matrix{{1.0}}) == Matrix(a - 1.0) &&
+                   broadcast_add(a, a_col_major) == Matrix(a * 2.0));
+
+        // the transposed view of a row is a column-major column
+        expect(std::format("{}x{} transposed vector", n, m).c_str(),
+               broadcast_add(a.transposed(), col.transposed()) ==
+                   Matrix(a.transposed() + tile(col.transposed(), m, n)));
+    }
+
+    // a full-shape left operand is updated in place, other operands are left alone
+    auto a{sequence(20, 30, 1.0)};
+    const double* buffer{a.data()};
+    const auto row{sequence(1, 30, 1.0)};
+    auto scaled{*broadcast_mul(std::move(a), row)};
+    expect("in place", scaled.data() == buffer && row == sequence(1, 30, 1.0) && scaled[1, 2] == 33.0 * 3.0);
+
+    expect("incompatible",
+           !broadcast_add(sequence(2, 3, 1.0), sequence(3, 2, 1.0)) &&
+               !broadcast_mul(sequence(2, 3, 1.0), sequence(1, 2, 1.0)));
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+#include "check.hpp"
+#include "matoy/foundations/cholesky.hpp"
+#include "matoy/foundations/lu.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include "matoy/foundations/triangular.hpp"
+#include <cmath>
+#include <print>
+#include <random>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+// M * M^T / n + I is symmetric, well conditioned and has a determinant far from overflowing.
+Matrix random_spd(size_t n, std::mt19937_64& rng) {
+    const Matrix m{random_matrix(n, n, rng)};
+    Matrix res{m * m.transposed() / static_cast<double>(n)};
+    for (size_t i{0}; i < n; i++) {
+        for (size_t j{0}; j < i; j++) {
+            res[i, j] = res[j, i]; // exactly symmetric regardless of the summation order
+        }
+        res[i, i] += 1.0;
+    }
+    return res;
+}
+
+// A triangular matrix with a dominant diagonal.
+Matrix random_triangular(size_t n, Triangle tri, std::mt19937_64& rng) {
+    Matrix res{random_matrix(n, n, rng)};
+    for (size_t i{0}; i < n; i++) {
+        for (size_t j{0}; j < n; j++) {
+            if (tri == Triangle::Lower ? j > i : j < i) {
+                res[i, j] = 0.0;
+            }
+        }
+        res[i, i] += 4.0;
+    }
+    return res;
+}
+
+int main() {
+    std::mt19937_64 rng{14};
+    const size_t n{150};
+    const Matrix a{random_spd(n, rng)}, b{random_matrix(n, 3, rng)};
+
+    const Cholesky chol{a}, unblocked{a, n};
+    const Matrix& l{chol.factor()};
+    expect("factor", chol.is_positive_definite() && is_triangular(l, Triangle::Lower) &&
+                         close(l * l.transposed(), a) && close(unblocked.factor(), l));
+    const LU lu{a};
+    expect("det", std::abs(chol.det() - lu.det()) <= 1e-10 * std::abs(lu.det()));
+    expect("solve", close(*chol.solve(b), *lu.solve(b)) && close(*chol.inverse(), *lu.inverse()));
+
+    // indefinite and singular matrices are detected instead of producing NaNs
+    Matrix indefinite{a};
+    indefinite[100, 100] = -1.0;
+    expect("not positive definite", !Cholesky{indefinite}.is_positive_definite() &&
+                                        !Cholesky{Matrix::zeros(5, 5)}.solve(Matrix::identity(5)));
+
+    const Matrix lower{random_triangular(n, Triangle::Lower, rng)}, upper{random_triangular(n, Triangle::Upper, rng)};
+    expect("is triangular", is_triangular(lower, Triangle::Lower) && !is_triangular(lower, Triangle::Upper) &&
+                                is_triangular(upper, Triangle::Upper) && is_symmetric(a) && !is_symmetric(lower));
+    expect("triangular solve", close(lower * *solve_triangular(lower, b, Triangle::Lower), b) &&
+                                   close(upper * *solve_triangular(upper, b, Triangle::Upper), b) &&
+                                   close(upper * *solve_triangular(upper, b.transposed().transposed(),
+                                                                   Triangle::Upper), b));
+    Matrix singular{lower};
+    singular[70, 70] = 0.0;
+    expect("singular triangular", !solve_triangular(singular, b, Triangle::Lower) && !inverse(singular) &&
+                                      det(singular) == 0.0);
+
+    // the routed solvers agree with LU on every kind of matrix
+    const Matrix general{random_matrix(n, n, rng)};
+    for (const Matrix* m : std::initializer_list<const Matrix*>{&a, &lower, &upper, &indefinite, &general}) {
+        const LU ref{*m};
+        expect("routed", close(*solve(*m, b), *ref.solve(b)) && close(*inverse(*m), *ref.inverse()) &&
+                             std::abs(det(*m) - ref.det()) <= 1e-9 * std::abs(ref.det()));
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+#include "check.hpp"
+#include "matoy/foundations/matrix.hpp"
+#include <format>
+#include <limits>
+#include <vector>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+void expect_copies(const char* what, size_t before, size_t expected) {
+    const size_t copies{Matrix::buffer_copies() - before};
+    expect(std::format("{} ({} buffer copies, expected {})", what, copies, expected).c_str(), copies == expected);
+}
+
+int main() {
+    const auto a = Matrix::zeros(1000, 1000, 1.0);
+
+    // Reading a variable copies its value. Before copy-on-write each of these copies was a full buffer copy,
+    // so this loop cost 10 x 8 MB of memcpy.
+    size_t before{Matrix::buffer_copies()};
+    std::vector<Matrix> reads;
+    for (int i{0}; i < 10; i++) {
+        reads.push_back(a);
+    }
+    expect_copies("10 copies", before, 0);
+
+    // reading through a const reference never unshares
+    before = Matrix::buffer_copies();
+    double sum{0.0};
+    for (const Matrix& m : reads) {
+        sum += m[0, 0] + m.view()[999, 999];
+    }
+    expect_copies("reads", before, 0);
+    expect("read values", sum == 20.0);
+
+    // the first write to a copy unshares it, once
+    before = Matrix::buffer_copies();
+    reads[0][0, 0] = 2.0;
+    reads[0][1, 1] = 3.0;
+    reads[0] *= 2.0;
+    expect_copies("writes to one copy", before, 1);
+    expect("original unchanged", a[0, 0] == 1.0 && reads[1][0, 0] == 1.0 && reads[0][0, 0] == 4.0);
+
+    // a matrix that owns its buffer is written in place
+    before = Matrix::buffer_copies();
+    auto b = Matrix::zeros(100, 100);
+    b += a.transposed().transposed() == a ? 1.0 : 0.0;
+    b.swap_row(0, 1);
+    b.negate();
+    expect_copies("writes to a sole owner", before, 0);
+
+    // transposing shares the buffer too; compare pointers through const access, which doesn't unshare
+    before = Matrix::buffer_copies();
+    const auto t = a.transposed();
+    const bool shared = t.is_shared() && t.data() == a.data();
+    expect_copies("transposed", before, 0);
+    expect("transposed shares the buffer", shared);
+
+    // sharing a buffer doesn't make NaN elements compare equal
+    const auto nan{Matrix::zeros(4, 5, std::numeric_limits<double>::quiet_NaN())};
+    const auto nan_copy{nan};
+    expect("shared NaN", nan_copy.data() == nan.data() && !(nan == nan_copy));
+
+    return failures == 0 ? 0 : 1;
+}
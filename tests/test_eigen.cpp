@@ -0,0 +1,87 @@
+#include "check.hpp"
+#include "matoy/foundations/eigen.hpp"
+#include "matoy/foundations/parallel.hpp"
+#include "matoy/foundations/svd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <print>
+#include <random>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+Matrix random_symmetric(size_t n, std::mt19937_64& rng) {
+    Matrix res{random_matrix(n, n, rng)};
+    for (size_t i{0}; i < n; i++) {
+        for (size_t j{0}; j < i; j++) {
+            res[i, j] = res[j, i];
+        }
+    }
+    return res;
+}
+
+Matrix diagonal(const std::vector<double>& values) {
+    auto res{Matrix::zeros(values.size(), values.size())};
+    for (size_t i{0}; i < values.size(); i++) {
+        res[i, i] = values[i];
+    }
+    return res;
+}
+
+bool orthonormal(const Matrix& q) {
+    return close(q.transposed() * q, Matrix::identity(q.cols()));
+}
+
+// Check A = V * diag(values) * V^T with orthogonal V and ascending eigenvalues.
+bool check_eigen(const Matrix& a) {
+    const SymmetricEigen eig{a}, values_only{a, false};
+    const Matrix& v{eig.vectors()};
+    return eig.converged() && std::ranges::is_sorted(eig.values()) && orthonormal(v) &&
+           close(v * diagonal(eig.values()) * v.transposed(), a) &&
+           close(Matrix(a.rows(), 1, values_only.values()), Matrix(a.rows(), 1, eig.values()));
+}
+
+// Check A = U * diag(values) * V^T with orthonormal U and V and descending singular values.
+bool check_svd(const Matrix& a) {
+    const SVD svd{a}, values_only{a, false};
+    const size_t k{std::min(a.rows(), a.cols())};
+    return svd.converged() && std::ranges::is_sorted(svd.values(), std::greater{}) && orthonormal(svd.u()) &&
+           orthonormal(svd.v()) && svd.u().shape() == std::pair{a.rows(), k} &&
+           close(svd.u() * diagonal(svd.values()) * svd.v().transposed(), a) &&
+           close(Matrix(k, 1, values_only.values()), Matrix(k, 1, svd.values()));
+}
+
+int main() {
+    std::mt19937_64 rng{16};
+
+    expect("eigen", check_eigen(random_symmetric(120, rng)) && check_eigen(random_symmetric(7, rng)) &&
+                        check_eigen(Matrix{{2.0}}));
+    // repeated eigenvalues and a matrix that is already tridiagonal
+    expect("eigen degenerate", check_eigen(Matrix::identity(5)) &&
+                                   check_eigen(Matrix{{2, -1, 0}, {-1, 2, -1}, {0, -1, 2}}) &&
+                                   check_eigen(Matrix::zeros(70, 70, 1.0)));
+    const SymmetricEigen known{Matrix{{2, 1}, {1, 2}}};
+    expect("eigen values", std::abs(known.values()[0] - 1.0) < 1e-14 && std::abs(known.values()[1] - 3.0) < 1e-14);
+
+    expect("svd", check_svd(random_matrix(90, 60, rng)) && check_svd(random_matrix(60, 90, rng)) &&
+                      check_svd(random_matrix(75, 75, rng)));
+    expect("svd tall", check_svd(random_matrix(300, 20, rng)) && check_svd(random_matrix(20, 300, rng)));
+
+    // singular values of a symmetric matrix are the absolute eigenvalues
+    const Matrix s{random_symmetric(50, rng)};
+    auto abs_eigenvalues{SymmetricEigen{s, false}.values()};
+    std::ranges::transform(abs_eigenvalues, abs_eigenvalues.begin(), [](double x) { return std::abs(x); });
+    std::ranges::sort(abs_eigenvalues, std::greater{});
+    expect("svd vs eigen", close(Matrix(50, 1, abs_eigenvalues), Matrix(50, 1, SVD{s, false}.values())));
+
+    const Matrix low_rank{random_matrix(40, 3, rng) * random_matrix(3, 30, rng)};
+    expect("rank", SVD{low_rank}.rank() == 3 && SVD{Matrix::zeros(4, 4)}.rank() == 0);
+
+    // parallel sweeps and chunked eigenvector updates give the same decomposition
+    set_num_threads(4);
+    expect("parallel", check_eigen(random_symmetric(150, rng)) && check_svd(random_matrix(80, 70, rng)));
+    set_num_threads(0);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+#include "matoy/foundations/fixed_matrix.hpp"
+#include "matoy/foundations/lu.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <print>
+#include <random>
+
+using namespace matoy;
+using namespace matoy::foundations;
+
+// everything below is evaluated by the compiler
+constexpr FixedMatrix rot{{0.0, -1.0}, {1.0, 0.0}};
+static_assert(rot * rot == -FixedMatrix<2>::identity());
+static_assert(rot.transposed() * rot == FixedMatrix<2>::identity());
+static_assert(rot.det() == 1.0);
+static_assert(*rot.inverse() == rot.transposed());
+static_assert(FixedMatrix{{1, 2, 3}, {4, 5, 6}, {7, 8, 9}}.det() == 0.0);
+static_assert(!FixedMatrix{{1, 2, 3}, {4, 5, 6}, {7, 8, 9}}.inverse());
+static_assert(FixedMatrix{{2, 0, 0, 0}, {0, 3, 0, 0}, {0, 0, 4, 0}, {1, 0, 0, 5}}.det() == 120.0);
+
+template <size_t N>
+int check_against_lu(std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> dist{-1.0, 1.0};
+    int failures{0};
+    for (int rep{0}; rep < 100; rep++) {
+        FixedMatrix<N> a;
+        for (size_t i{0}; i < N; i++) {
+            for (size_t j{0}; j < N; j++) {
+                a[i, j] = dist(rng);
+            }
+        }
+        const Matrix m{a};
+        const LU lu{m};
+        const double scale{std::abs(lu.det()) + 1.0};
+        const bool ok_det = std::abs(a.det() - lu.det()) < 64 * std::numeric_limits<double>::epsilon() * scale;
+        const auto inv = a.inverse();
+        bool ok_inv{inv.has_value()};
+        if (inv) {
+            // |A * A^-1 - I| is bounded by a multiple of eps * |A| * |A^-1|
+            double norm_a{0.0}, norm_inv{0.0};
+            for (size_t k{0}; k < N * N; k++) {
+                norm_a = std::max(norm_a, std::abs(a.data()[k]));
+                norm_inv = std::max(norm_inv, std::abs(inv->data()[k]));
+            }
+            const auto residual = a * *inv - FixedMatrix<N>::identity();
+            for (size_t k{0}; k < N * N; k++) {
+                ok_inv &= std::abs(residual.data()[k]) <
+                          64 * N * std::numeric_limits<double>::epsilon() * norm_a * norm_inv;
+            }
+        }
+        failures += !ok_det + !ok_inv;
+    }
+    std::println("{}x{}: {}", N, N, failures == 0 ? "ok" : "FAILED");
+    return failures;
+}
+
+int main() {
+    std::mt19937_64 rng{5};
+    int failures{0};
+    failures += check_against_lu<1>(rng);
+    failures += check_against_lu<2>(rng);
+    failures += check_against_lu<3>(rng);
+    failures += check_against_lu<4>(rng);
+
+    // small dynamic matrices are stored inline and routed to the closed forms
+    const Matrix m{{4, 7}, {2, 6}};
+    const bool ok_inline = !m.is_shared() && Matrix::zeros(5, 5).size() > Matrix::inline_capacity;
+    const bool ok_inverse = approx(*inverse(m), Matrix{{0.6, -0.7}, {-0.2, 0.4}}) && det(m) == 10.0;
+    std::println("dynamic: {}", ok_inline && ok_inverse ? "ok" : "FAILED");
+    failures += !ok_inline + !ok_inverse;
+
+    // singularity doesn't depend on whether a matrix takes the closed forms or LU: a badly scaled diagonal with a
+    // determinant of 1 is invertible, and a tiny multiple of the identity is singular by the pivot test
+    for (size_t n : {3, 4, 5}) {
+        auto scaled{Matrix::identity(n)};
+        scaled[0, 0] = 1e-6;
+        scaled[n - 1, n - 1] = 1e6;
+        const auto inv{inverse(scaled)};
+        const Matrix tiny{Matrix::identity(n) * 1e-20};
+        const bool ok_scaled = std::abs(det(scaled) - 1.0) < 1e-12 && inv && std::abs((*inv)[0, 0] - 1e6) < 1e-4 &&
+                               !inverse(tiny) && det(tiny) > 0.0;
+        std::println("badly scaled {}x{}: {}", n, n, ok_scaled ? "ok" : "FAILED");
+        failures += !ok_scaled;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+#include "check.hpp"
+#include "matoy/foundations/matrix.hpp"
+#include "matoy/foundations/parallel.hpp"
+#include <cmath>
+#include <limits>
+#include <print>
+#include <random>
+#include <vector>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+// Error bound of a k-term dot product: k * eps * sum |a_ip| |b_pj| <= k * eps * k for entries in [-1, 1].
+bool close_to_reference(const Matrix& a, const Matrix& b, const Matrix& c) {
+    const double k = static_cast<double>(a.cols());
+    const double tol = k * k * std::numeric_limits<double>::epsilon();
+    for (size_t i{0}; i < c.rows(); i++) {
+        for (size_t j{0}; j < c.cols(); j++) {
+            double ref{0.0};
+            for (size_t p{0}; p < a.cols(); p++) {
+                ref += a[i, p] * b[p, j];
+            }
+            if (std::abs(ref - c[i, j]) > tol) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main() {
+    std::mt19937_64 rng{7};
+    int failures{0};
+
+    struct Shape {
+        size_t m, k, n;
+    };
+    for (auto [m, k, n] : {Shape{1, 1, 1}, Shape{3, 5, 2}, Shape{37, 41, 43}, Shape{200, 300, 170},
+                           Shape{257, 129, 513}, Shape{5, 600, 7}}) {
+        auto a = random_matrix(m, k, rng);
+        auto b = random_matrix(k, n, rng);
+
+        set_num_threads(1);
+        auto serial = a * b;
+        set_num_threads(4);
+        auto parallel = a * b;
+
+        // a transposed operand is read through its strides, and packs into the same panels as a row-major copy
+        auto bt = random_matrix(n, k, rng).transposed();
+        auto bt_copy = bt;
+        bt_copy.set_layout(Layout::RowMajor);
+
+        bool ok_ref = close_to_reference(a, b, serial);
+        bool ok_par = serial == parallel;
+        bool ok_trans = close_to_reference(a, bt, a * bt) && a * bt == a * bt_copy;
+        std::println("{}x{}x{}: reference {}, parallel {}, transposed {}", m, k, n, ok_ref ? "ok" : "FAILED",
+                     ok_par ? "ok" : "FAILED", ok_trans ? "ok" : "FAILED");
+        failures += !ok_ref + !ok_par + !ok_trans;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,54 @@
+#include "script.hpp"
+#include <print>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+int main() {
+    Script script;
+    script.run("A := [1, 2, 3; 4, 5, 6; 7, 8, 9; 10, 11, 12]");
+    script.run("v := [1, 2, 3, 4, 5]");
+
+    // a bound or step left out of a range takes the whole dimension with step 1
+    expect("element", script.scalar("A[2, 1]") == 8.0);
+    expect("ranges", script.matrix("A[:, 1]") == Matrix{{2}, {5}, {8}, {11}} &&
+                         script.matrix("A[0:4:2, 2]") == Matrix{{3}, {9}} &&
+                         script.matrix("A[1:3, 1:]") == Matrix{{5, 6}, {8, 9}} &&
+                         script.matrix("A[::2, :2]") == Matrix{{1, 2}, {7, 8}});
+
+    // a row or a column takes a single subscript, other matrices two
+    expect("vectors", script.matrix("v[::2]") == Matrix{{1, 3, 5}} && script.scalar("v[4]") == 5.0 &&
+                          script.matrix("A[:, 0][1:3]") == Matrix{{4}, {7}});
+    expect("subscript count", script.fails_with("A[1]", "expected 2 subscripts for a 4x3 matrix, found 1") &&
+                                  script.fails_with("A[1, 2, 0]", "found 3") &&
+                                  script.fails_with("A[0, 0][0]", "cannot index"));
+
+    expect("out of bounds", script.fails_with("A[4, 0]", "index 4 is out of bounds for 4 rows") &&
+                                script.fails_with("A[0, -1]", "index -1 is out of bounds for 3 columns") &&
+                                script.fails_with("A[0:5, 0]", "range 0:5 is out of bounds for 4 rows") &&
+                                script.fails_with("A[3:1, 0]", "range 3:1 is out of bounds") &&
+                                script.fails_with("v[5]", "index 5 is out of bounds for 5 elements"));
+    expect("steps", script.fails_with("A[::0, 0]", "the step of a range must be positive, found 0") &&
+                        script.fails_with("A[0, ::-1]", "found -1") &&
+                        script.matrix("A[0:2:9223372036854775807, 0]") == Matrix{{1}} &&
+                        script.matrix("v[1::9223372036854775807]") == Matrix{{2}});
+
+    // assignments write into the variable, and copies of it keep the old elements
+    script.run("B := A");
+    script.run("A[1, 2] = 0");
+    script.run("A[1:3, 0] += [100; 200]");
+    script.run("A[3, :] *= 2");
+    script.run("A[::3, 1] = -1");
+    expect("assignment", script.matrix("A") == Matrix{{1, -1, 3}, {104, 5, 0}, {207, 8, 9}, {20, -1, 24}} &&
+                             script.matrix("B") == Matrix{{1, 2, 3}, {4, 5, 6}, {7, 8, 9}, {10, 11, 12}});
+    expect("assignment value", script.matrix("A[0, :] = [7, 8, 9]") == Matrix{{7, 8, 9}} &&
+                                   script.scalar("v[0] += 10") == 11.0);
+
+    expect("assignment errors", script.fails_with("A[0, :] = [1, 2]", "cannot assign a 1x2 matrix to 1 rows") &&
+                                    script.fails_with("A[0, 0] = none", "cannot assign none") &&
+                                    script.fails_with("A[9, 0] = 1", "out of bounds") &&
+                                    script.matrix("A[0, :]") == Matrix{{7, 8, 9}});
+
+    return failures == 0 ? 0 : 1;
+}
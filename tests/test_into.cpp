@@ -0,0 +1,73 @@
+#include "check.hpp"
+#include "matoy/foundations/matrix.hpp"
+#include <print>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+int main() {
+    const auto a{sequence(30, 40, 0.0)}, b{sequence(30, 40, 100.0)}, c{sequence(40, 20, -50.0)};
+    const Matrix expected{a * 2.0 + b};
+
+    // an expiring operand lends its buffer to the result
+    auto x{a};
+    x.unshare();
+    const double* buffer{std::as_const(x).data()};
+    const Matrix scaled{std::move(x) * 2.0 + b};
+    expect("rvalue lhs", scaled.data() == buffer && scaled == expected);
+
+    auto y{b};
+    y.unshare();
+    buffer = std::as_const(y).data();
+    const Matrix sum{a * 2.0 + std::move(y)};
+    expect("rvalue rhs", sum.data() == buffer && sum == expected);
+
+    // a column-major operand keeps its layout, and the others are read in tiles
+    auto z{a};
+    z.set_layout(Layout::ColMajor);
+    buffer = std::as_const(z).data();
+    const Matrix mixed{-(std::move(z) * 2.0 + b)};
+    expect("rvalue layout", mixed.data() == buffer && mixed.layout() == Layout::ColMajor &&
+                                mixed == Matrix(-(a * 2.0 + b)));
+
+    // a shared operand, or one that is only broadcast, is left alone
+    auto shared{a};
+    const Matrix from_shared{std::move(shared) * 2.0 + b};
+    auto row{sequence(1, 40, 0.0)};
+    buffer = std::as_const(row).data();
+    const Matrix from_row{b + broadcast(std::move(row), 30, 40)};
+    expect("not reused", from_shared.data() != a.data() && from_shared == expected && a == sequence(30, 40, 0.0) &&
+                             from_row.data() != buffer && from_row[29, 39] == b[29, 39] + 39.0);
+
+    // products and sums into an existing matrix keep its buffer
+    auto out{Matrix::empty(30, 20)};
+    buffer = std::as_const(out).data();
+    multiply_into(out, a, c);
+    const bool product_ok{out.data() == buffer && out == a * c};
+    auto total{Matrix::empty(30, 40)};
+    buffer = std::as_const(total).data();
+    add_into(total, a, b);
+    auto b_col_major{b};
+    b_col_major.set_layout(Layout::ColMajor);
+    auto mixed_total{Matrix::empty(30, 40)};
+    add_into(mixed_total, a, b_col_major);
+    expect("into", product_ok && total.data() == buffer && total == Matrix(a + b) && mixed_total == total);
+
+    // the destination may be an operand, and a wrong shape or a shared buffer is replaced
+    auto acc{a};
+    add_into(acc, acc, b);
+    add_into(acc, a, acc);
+    auto square{sequence(20, 20, 1.0)};
+    const auto square_before{square};
+    multiply_into(square, square, square);
+    auto wrong{Matrix::empty(2, 2)};
+    multiply_into(wrong, a, c);
+    auto copy{a * c};
+    const auto shared_copy{copy};
+    multiply_into(copy, c.transposed(), a.transposed());
+    expect("aliasing", acc == Matrix(a * 2.0 + b) && square == square_before * square_before && wrong == a * c &&
+                           shared_copy == a * c && copy == c.transposed() * a.transposed());
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,32 @@
+#include "script.hpp"
+#include <print>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+int main() {
+    Script script;
+    script.run("A := [1, 2; 3, 4]");
+
+    expect("scalars", script.matrix("[1, 2, 3; 4, 5, 6]") == Matrix{{1, 2, 3}, {4, 5, 6}});
+    expect("blocks", script.matrix("[A, [5; 6]; 7, 8, 9]") == Matrix{{1, 2, 5}, {3, 4, 6}, {7, 8, 9}} &&
+                         script.matrix("[A.T; A]") == Matrix{{1, 3}, {2, 4}, {1, 2}, {3, 4}});
+
+    // the items of a row have the same height, and the rows the same width
+    expect("mismatched heights", script.fails_with("[A, 1]", "expected 2 rows like the rest of the row, found 1") &&
+                                     script.fails_with("[1, A]", "expected 1 rows like the rest of the row, found 2"));
+    expect("mismatched widths",
+           script.fails_with("[1, 2; 3]", "expected 2 columns like the first row, found 1") &&
+               script.fails_with("[A; 1, 2, 3]", "expected 2 columns like the first row, found 3"));
+    expect("other items", script.fails_with("[1, none]", "the item can't fit into a matrix"));
+
+    const auto empty{script.matrix("[]")};
+    expect("empty", empty && empty->size() == 0);
+
+    // sparse and banded items are copied in densely
+    const auto mixed{script.matrix("[sparse([0, 2; 0, 0]), [5; 6]; band([4, 1, 0; 1, 4, 1; 0, 1, 4], 1, 1)]")};
+    expect("densified", mixed == Matrix{{0, 2, 5}, {0, 0, 6}, {4, 1, 0}, {1, 4, 1}, {0, 1, 4}});
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,41 @@
+#include "check.hpp"
+#include "matoy/foundations/lu.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include <cmath>
+#include <limits>
+#include <print>
+#include <random>
+#include <vector>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+int main() {
+    std::mt19937_64 rng{3};
+    int failures{0};
+
+    for (size_t n : {1, 2, 5, 63, 64, 65, 200, 301}) {
+        auto a = random_matrix(n, n, rng);
+        auto b = random_matrix(n, 3, rng);
+
+        // every block size must produce the same factorization up to rounding
+        LU blocked{a, 16};
+        LU unblocked{a, n};
+        double det_err = std::abs(blocked.det() - unblocked.det()) / std::abs(unblocked.det());
+
+        auto x = blocked.solve(b).value();
+        double residual = max_abs(Matrix(a * x - b)) / (max_abs(a) * max_abs(x) * n);
+
+        bool ok = blocked.pivots() == unblocked.pivots() && det_err < 1e-10 &&
+                  residual < 10 * std::numeric_limits<double>::epsilon();
+        std::println("n = {}: det error {}, residual {} {}", n, det_err, residual, ok ? "ok" : "FAILED");
+        failures += !ok;
+    }
+
+    bool singular_ok = !inverse(Matrix{{1, 2}, {2, 4}}) && det(Matrix{{1, 2}, {2, 4}}) == 0.0;
+    std::println("singular: {}", singular_ok ? "ok" : "FAILED");
+    failures += !singular_ok;
+
+    return failures == 0 ? 0 : 1;
+}
@@ -11,4 +11,13 @@ int main() {
     std::println("{}", *inverse(mat));
     std::println("{}", mat * *inverse(mat));
     std::println("{}", *inverse(mat) * mat);
+    std::println("{}", det(mat));
+    std::println("{}", *solve(mat, Matrix{{5}, {11}}));
+
+    Matrix rect{{1, 2, 3}, {4, 5, 6}};
+    std::println("{}", rect.transposed());
+    mat.transpose();
+    std::println("{}", mat);
+    std::println("{}", mat + mat.transposed());
+    std::println("{}", concat_h(rect.transposed(), rect.transposed()));
 }
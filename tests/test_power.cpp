@@ -0,0 +1,77 @@
+#include "check.hpp"
+#include "matoy/foundations/band.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include <cmath>
+#include <print>
+#include <random>
+#include <vector>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+double max_rel_diff(const Matrix& a, const Matrix& b) {
+    double diff{0.0}, scale{1e-300};
+    for (size_t i{0}; i < a.rows(); i++) {
+        for (size_t j{0}; j < a.cols(); j++) {
+            diff = std::max(diff, std::abs(a[i, j] - b[i, j]));
+            scale = std::max(scale, std::abs(b[i, j]));
+        }
+    }
+    return diff / scale;
+}
+
+int main() {
+    std::mt19937_64 rng{17};
+
+    // squaring agrees with repeated multiplication for every bit pattern up to 2^6
+    for (size_t n : {3, 5, 40}) {
+        const Matrix a{random_matrix(n, n, rng) / static_cast<double>(n)};
+        Matrix naive{Matrix::identity(n)};
+        bool ok{true};
+        for (int64_t k{1}; k <= 64; k++) {
+            naive = naive * a;
+            ok = ok && max_rel_diff(*power(a, k), naive) < 1e-10;
+        }
+        std::println("n = {}", n);
+        expect("  power matches repeated products", ok);
+        expect("  power 0 is the identity", *power(a, 0) == Matrix::identity(n));
+        expect("  power 1 is the matrix", *power(a, 1) == a);
+        expect("  negative power inverts", max_rel_diff(*power(a, -3) * *power(a, 3), Matrix::identity(n)) < 1e-8);
+        Matrix copy{a};
+        copy.unshare();
+        (void)power(a, 5);
+        expect("  the input is left untouched", a == copy);
+    }
+
+    // diagonal matrices take the closed form
+    auto d{Matrix::zeros(3, 3)};
+    d[0, 0] = 2.0;
+    d[1, 1] = -3.0;
+    d[2, 2] = 0.5;
+    const Matrix d5{*power(d, 5)};
+    expect("diagonal power", d5[0, 0] == 32.0 && d5[1, 1] == -243.0 && d5[2, 2] == 0.03125 && d5[0, 1] == 0.0);
+    const Matrix dinv{*power(d, -1)};
+    expect("diagonal inverse", dinv[0, 0] == 0.5 && dinv[2, 2] == 2.0);
+    expect("identity power", *power(Matrix::identity(4), 1000) == Matrix::identity(4));
+    expect("identity negative power", *power(Matrix::identity(4), -7) == Matrix::identity(4));
+
+    // singular matrices have no negative powers
+    auto s{Matrix::zeros(2, 2, 1.0)};
+    expect("singular negative power", !power(s, -2));
+    expect("singular positive power", max_rel_diff(*power(s, 3), Matrix::zeros(2, 2, 4.0)) == 0.0);
+    d[1, 1] = 0.0;
+    expect("singular diagonal negative power", !power(d, -1));
+    const Matrix tiny{Matrix::identity(2) * 1e-20};
+    const std::vector<double> tiny_diag{1e-20, 1e-20};
+    const auto tiny_band{BandMatrix::diagonal(tiny_diag).power(-1)};
+    expect("tiny diagonal negative power", std::abs((*power(tiny, -1))[1, 1] / 1e20 - 1.0) < 1e-15 && tiny_band &&
+                                               std::abs(tiny_band->to_dense()[1, 1] / 1e20 - 1.0) < 1e-15);
+
+    // banded matrices keep their structure
+    const std::vector<double> diag{2.0, 3.0};
+    auto tp{BandMatrix::diagonal(diag).power(3)};
+    expect("band diagonal power", tp && tp->is_diagonal() && tp->to_dense()[1, 1] == 27.0);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+#include "check.hpp"
+#include "matoy/foundations/gemm.hpp"
+#include "matoy/foundations/lu.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include "matoy/foundations/refined_lu.hpp"
+#include "matoy/foundations/simd.hpp"
+#include <cmath>
+#include <print>
+#include <random>
+#include <vector>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+double max_diff(const Matrix& a, const Matrix& b) {
+    return max_abs(Matrix{a - b});
+}
+
+// max |A * x - b| / (|A| * |x| * n), which is a small multiple of eps for a backward stable solve
+double backward_error(const Matrix& a, const Matrix& x, const Matrix& b) {
+    return max_abs(Matrix{a * x - b}) / (max_abs(a) * max_abs(x) * static_cast<double>(a.rows()));
+}
+
+int main() {
+    std::mt19937_64 rng{18};
+
+    // conversions keep the shape and layout, and round each element
+    const Matrix a{random_matrix(5, 7, rng).transposed()};
+    const FloatMatrix a32{a};
+    expect("conversion keeps the layout", a32.layout() == Layout::ColMajor && a32.shape() == a.shape());
+    expect("conversion rounds", a32[3, 2] == static_cast<float>(a[3, 2]) && Matrix{a32}[3, 2] == a32[3, 2]);
+
+    // the float kernels agree with the double ones up to float rounding
+    std::vector<float> x(37), y(37);
+    for (size_t i{0}; i < x.size(); i++) {
+        x[i] = static_cast<float>(i) * 0.5f;
+        y[i] = 1.0f - static_cast<float>(i);
+    }
+    float expected{0.0f};
+    for (size_t i{0}; i < x.size(); i++) {
+        expected += x[i] * y[i];
+    }
+    expect("float dot", std::abs(simd::dot(x.data(), y.data(), x.size()) - expected) < 1e-3f);
+    simd::axpy(x.data(), 2.0f, y.data(), x.size());
+    expect("float axpy", x[36] == 18.0f + 2.0f * -35.0f && x[1] == 0.5f);
+
+    for (size_t n : {3, 40, 300}) {
+        const Matrix p{random_matrix(n, n + 1, rng)}, q{random_matrix(n + 1, n, rng)};
+        const Matrix pq{p * q};
+        const Matrix pq32{FloatMatrix{p} * FloatMatrix{q}};
+        std::println("n = {}", n);
+        expect("  float product", max_diff(pq, pq32) < 1e-5 * static_cast<double>(n));
+
+        auto c32{FloatMatrix::zeros(n, n, 1.0f)};
+        gemm(2.0f, FloatMatrix{p}.view(), FloatMatrix{q}.view(), -1.0f, c32.view());
+        expect("  float gemm with alpha and beta",
+               max_diff(Matrix{c32}, 2.0 * pq - 1.0) < 1e-5 * static_cast<double>(n));
+
+        const Matrix m{random_matrix(n, n, rng)}, b{random_matrix(n, 2, rng)};
+        const FloatLU lu32{FloatMatrix{m}};
+        const Matrix x32{*lu32.solve(FloatMatrix{b})};
+        expect("  float LU solves to float accuracy", backward_error(m, x32, b) < 1e-6);
+        if (n < 100) { // larger determinants leave the range of float
+            expect("  float LU determinant", std::abs(lu32.det() / LU{m}.det() - 1.0) < 1e-3);
+        }
+
+        const RefinedLU refined{m};
+        const Matrix x{*refined.solve(b)};
+        expect("  factorized in single precision", refined.is_single_precision());
+        expect("  refinement reaches double accuracy", backward_error(m, x, b) < 1e-15);
+        expect("  agrees with LU", max_diff(x, *LU{m}.solve(b)) < 1e-10 * max_abs(x));
+        expect("  routed solve", backward_error(m, *solve(m, b), b) < 1e-15);
+    }
+
+    // a Hilbert matrix is too badly conditioned for float, so the refinement gives up and LU takes over
+    const size_t n{12};
+    auto hilbert{Matrix::empty(n, n)};
+    for (size_t i{0}; i < n; i++) {
+        for (size_t j{0}; j < n; j++) {
+            hilbert[i, j] = 1.0 / static_cast<double>(i + j + 1);
+        }
+    }
+    const Matrix ones{Matrix::zeros(n, 1, 1.0)};
+    const auto refined{RefinedLU{hilbert}.solve(ones)};
+    expect("ill-conditioned falls back", refined && max_diff(*refined, *LU{hilbert}.solve(ones)) == 0.0);
+
+    // elements beyond the range of float are factorized in double right away
+    Matrix huge{random_matrix(20, 20, rng) * 1e300};
+    const RefinedLU huge_lu{huge};
+    const Matrix rhs{random_matrix(20, 1, rng)};
+    expect("out of float range", !huge_lu.is_single_precision() &&
+                                     backward_error(huge, *huge_lu.solve(rhs), rhs) < 1e-15);
+
+    auto singular{Matrix::zeros(300, 300, 1.0)};
+    expect("singular", !RefinedLU{singular}.solve(Matrix::zeros(300, 1, 1.0)));
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+#include "check.hpp"
+#include "matoy/foundations/parallel.hpp"
+#include "matoy/foundations/qr.hpp"
+#include "matoy/foundations/triangular.hpp"
+#include <cmath>
+#include <print>
+#include <random>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+// Check A = Q * R with orthonormal columns of Q and an upper triangular R.
+bool check_factors(const Matrix& a, const QR& qr) {
+    const Matrix q{qr.q()}, r{qr.r()};
+    bool upper{true};
+    for (size_t i{0}; i < r.rows(); i++) {
+        for (size_t j{0}; j < std::min(i, r.cols()); j++) {
+            upper = upper && r[i, j] == 0.0;
+        }
+    }
+    return upper && close(q * r, a) && close(q.transposed() * q, Matrix::identity(q.cols()));
+}
+
+// The least-squares residual is orthogonal to the columns of A: A^T * (A * X - B) = 0.
+bool check_lstsq(const Matrix& a, const Matrix& b, const std::optional<Matrix>& x) {
+    return x && close(a.transposed() * Matrix(a * *x - b), Matrix::zeros(a.cols(), b.cols()), 1e-9);
+}
+
+int main() {
+    std::mt19937_64 rng{15};
+    const Matrix tall{random_matrix(200, 70, rng)}, wide{random_matrix(40, 90, rng)};
+    const Matrix square{random_matrix(100, 100, rng)};
+    const Matrix b{random_matrix(200, 3, rng)};
+
+    const QR qr_tall{tall}, unblocked{tall, 70};
+    expect("tall factors", check_factors(tall, qr_tall) && close(unblocked.r(), qr_tall.r()));
+    expect("wide factors", check_factors(wide, QR{wide}));
+    expect("square factors",
+           check_factors(square, QR{square}) && check_factors(square.transposed(), QR{square.transposed()}));
+    expect("apply q", close(qr_tall.apply_q(qr_tall.apply_qt(b)), b));
+
+    expect("least squares", check_lstsq(tall, b, qr_tall.solve(b)) && close(*lstsq(tall, b), *qr_tall.solve(b)));
+    const Matrix sb{random_matrix(100, 2, rng)};
+    expect("square solve", close(square * *QR{square}.solve(sb), sb));
+
+    // a repeated column leaves the solution undetermined
+    Matrix deficient{tall};
+    for (size_t i{0}; i < deficient.rows(); i++) {
+        deficient[i, 5] = deficient[i, 9];
+    }
+    expect("rank deficient", QR{deficient}.is_rank_deficient() && !lstsq(deficient, b) && !qr_tall.is_rank_deficient());
+
+    // tall and skinny inputs take the TSQR path, in parallel
+    set_num_threads(4);
+    const Matrix skinny{random_matrix(20000, 8, rng)}, y{random_matrix(20000, 2, rng)};
+    const auto x{lstsq(skinny, y)};
+    expect("tsqr", check_lstsq(skinny, y, x) && close(*x, *QR{skinny}.solve(y)));
+    Matrix skinny_deficient{skinny};
+    for (size_t i{0}; i < skinny.rows(); i++) {
+        skinny_deficient[i, 7] = 2.0 * skinny[i, 0];
+    }
+    expect("tsqr rank deficient", !lstsq(skinny_deficient, y));
+    set_num_threads(0);
+
+    return failures == 0 ? 0 : 1;
+}
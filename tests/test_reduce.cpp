@@ -0,0 +1,126 @@
+#include "check.hpp"
+#include "matoy/foundations/parallel.hpp"
+#include "matoy/foundations/reduce.hpp"
+#include <cmath>
+#include <format>
+#include <print>
+#include <random>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+bool close(double x, long double expected, double tol = 1e-13) {
+    return std::abs(static_cast<long double>(x) - expected) <= tol * (1.0L + std::abs(expected));
+}
+
+// Reference reductions of rows [i0, i1) and columns [j0, j1) in long double.
+template <class F>
+long double reference(const Matrix& a, size_t i0, size_t i1, size_t j0, size_t j1, long double init, F f) {
+    long double acc{init};
+    for (size_t i{i0}; i < i1; i++) {
+        for (size_t j{j0}; j < j1; j++) {
+            acc = f(acc, static_cast<long double>(a[i, j]));
+        }
+    }
+    return acc;
+}
+
+// Check every reduction of one matrix against the references.
+bool check(const Matrix& a) {
+    const size_t m{a.rows()}, n{a.cols()};
+    const auto add = [](long double x, long double y) { return x + y; };
+    const auto add_abs = [](long double x, long double y) { return x + std::abs(y); };
+    const auto add_square = [](long double x, long double y) { return x + y * y; };
+    const auto lower = [](long double x, long double y) { return std::min(x, y); };
+    const auto upper = [](long double x, long double y) { return std::max(x, y); };
+
+    bool ok{close(sum(a), reference(a, 0, m, 0, n, 0.0L, add)) &&
+            close(mean(a), reference(a, 0, m, 0, n, 0.0L, add) / static_cast<long double>(m * n)) &&
+            *min(a) == static_cast<double>(reference(a, 0, m, 0, n, INFINITY, lower)) &&
+            *max(a) == static_cast<double>(reference(a, 0, m, 0, n, -INFINITY, upper)) &&
+            close(frobenius_norm(a), std::sqrt(reference(a, 0, m, 0, n, 0.0L, add_square)))};
+
+    const auto col_sums{sum(a, Axis::Rows)}, col_means{mean(a, Axis::Rows)}, row_sums{sum(a, Axis::Cols)};
+    const auto col_min{*min(a, Axis::Rows)}, row_max{*max(a, Axis::Cols)};
+    ok = ok && col_sums.shape() == std::pair{size_t{1}, n} && row_sums.shape() == std::pair{m, size_t{1}};
+    long double norm_1_expected{0.0L}, norm_inf_expected{0.0L};
+    for (size_t j{0}; ok && j < n; j++) {
+        const long double s{reference(a, 0, m, j, j + 1, 0.0L, add)};
+        ok = close(col_sums[0, j], s) && close(col_means[0, j], s / static_cast<long double>(m)) &&
+             col_min[0, j] == static_cast<double>(reference(a, 0, m, j, j + 1, INFINITY, lower));
+        norm_1_expected = std::max(norm_1_expected, reference(a, 0, m, j, j + 1, 0.0L, add_abs));
+    }
+    for (size_t i{0}; ok && i < m; i++) {
+        ok = close(row_sums[i, 0], reference(a, i, i + 1, 0, n, 0.0L, add)) &&
+             row_max[i, 0] == static_cast<double>(reference(a, i, i + 1, 0, n, -INFINITY, upper));
+        norm_inf_expected = std::max(norm_inf_expected, reference(a, i, i + 1, 0, n, 0.0L, add_abs));
+    }
+    return ok && close(norm_1(a), norm_1_expected) && close(norm_inf(a), norm_inf_expected);
+}
+
+int main() {
+    std::mt19937_64 rng{21};
+
+    // shapes around the SIMD width, the pairwise blocks and the parallel chunks, in both layouts and with padding
+    for (auto [m, n] : {std::pair<size_t, size_t>{1, 1}, {1, 7}, {9, 1}, {5, 3}, {33, 17}, {130, 129},
+                        {3, 40000}, {40000, 3}, {700, 500}}) {
+        const auto a{random_matrix(m, n, rng)};
+        Matrix col_major{a}, padded{a};
+        col_major.set_layout(Layout::ColMajor);
+        padded.set_leading_dim(Matrix::padded_leading_dim(n));
+        expect(std::format("{}x{}", m, n).c_str(), check(a) && check(col_major) && check(padded));
+    }
+
+    // the rounding error of a long sum stays far below that of a sequential loop
+    const size_t count{1 << 22};
+    auto tenths{Matrix::zeros(count, 1, 0.1)};
+    double sequential{0.0};
+    for (size_t k{0}; k < count; k++) {
+        sequential += tenths[k, 0];
+    }
+    const long double exact{static_cast<long double>(0.1) * count};
+    const double pairwise_error{std::abs(static_cast<double>(sum(tenths) - exact))};
+    expect("pairwise", pairwise_error < 1e-3 * std::abs(static_cast<double>(sequential - exact)) &&
+                           pairwise_error < 1e-12 * static_cast<double>(exact));
+
+    // the order of the additions doesn't depend on the number of threads
+    const auto big{random_matrix(3000, 700, rng)};
+    set_num_threads(4);
+    const double total{sum(big)};
+    const auto rows{sum(big, Axis::Cols)}, cols{sum(big, Axis::Rows)};
+    set_num_threads(1);
+    const bool same{sum(big) == total && sum(big, Axis::Cols) == rows && sum(big, Axis::Rows) == cols};
+    set_num_threads(0);
+    expect("threads", same);
+
+    // norms of tiny and huge elements are rescaled
+    const Matrix tiny{{3e-300, 4e-300}}, huge{{3e300, 4e300}};
+    expect("norm range", close(frobenius_norm(tiny), 5e-300L) && close(frobenius_norm(huge), 5e300L) &&
+                             frobenius_norm(Matrix::zeros(2, 2)) == 0.0);
+
+    // a NaN makes min and max NaN wherever it sits, also past the first registers of the SIMD kernels, and only in
+    // its own line along an axis
+    bool nan_ok{true};
+    for (size_t n : {9, 24, 1000}) {
+        for (size_t at : {size_t{0}, size_t{8}, n / 2, n - 1}) {
+            auto a{Matrix::zeros(2, n, 9.0)};
+            a[1, 0] = 1.0;
+            a[1, at] = NAN;
+            const auto col_min{*min(a, Axis::Rows)}, row_max{*max(a, Axis::Cols)};
+            Matrix col_major{a};
+            col_major.set_layout(Layout::ColMajor);
+            nan_ok = nan_ok && std::isnan(*min(a)) && std::isnan(*max(a)) && std::isnan(*min(col_major)) &&
+                     std::isnan(col_min[0, at]) && col_min[0, at == 0 ? 1 : 0] == (at == 0 ? 9.0 : 1.0) &&
+                     row_max[0, 0] == 9.0 && std::isnan(row_max[1, 0]) &&
+                     std::isnan((*max(col_major, Axis::Cols))[1, 0]) && std::isnan(norm_1(a));
+        }
+    }
+    expect("nan", nan_ok);
+
+    const auto empty{Matrix::zeros(0, 3)};
+    expect("empty", sum(empty) == 0.0 && std::isnan(mean(empty)) && !min(empty) && !max(empty, Axis::Cols) &&
+                        sum(empty, Axis::Rows) == Matrix::zeros(1, 3) && norm_1(empty) == 0.0);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+#include "matoy/foundations/matrix.hpp"
+#include "matoy/foundations/simd.hpp"
+#include <cmath>
+#include <limits>
+#include <print>
+#include <random>
+#include <vector>
+
+using namespace matoy;
+using namespace matoy::foundations;
+
+int main() {
+    std::mt19937_64 rng{11};
+    std::uniform_real_distribution<double> dist{-1.0, 1.0};
+    int failures{0};
+
+    // every length up to a few vectors, at every offset from an aligned start, to cover heads and tails
+    for (size_t n{0}; n < 40; n++) {
+        for (size_t offset{0}; offset < 4; offset++) {
+            std::vector<double> xs(n + offset), ys(n + offset);
+            for (size_t i{0}; i < xs.size(); i++) {
+                xs[i] = dist(rng);
+                ys[i] = dist(rng);
+            }
+            const double s{dist(rng)};
+            double *x{xs.data() + offset}, *y{ys.data() + offset};
+
+            // |x| and |s * y| are at most 1, so a fused result is within a few ulps of 1 of the unfused one
+            constexpr double tol{4 * std::numeric_limits<double>::epsilon()};
+            auto check = [&](const char* name, auto kernel, auto reference, bool exact) {
+                std::vector<double> a(x, x + n), b(y, y + n), ra(a), rb(b);
+                kernel(a.data(), b.data());
+                for (size_t i{0}; i < n; i++) {
+                    reference(ra[i], rb[i]);
+                }
+                for (size_t i{0}; i < n; i++) {
+                    if (exact ? a[i] != ra[i] || b[i] != rb[i] : std::abs(a[i] - ra[i]) > tol) {
+                        std::println("{}: mismatch at n = {}, offset = {}, i = {}", name, n, offset, i);
+                        failures++;
+                        return;
+                    }
+                }
+            };
+
+            check("add", [&](double* a, double* b) { simd::add(a, b, n); }, [](double& a, double b) { a += b; },
+                  true);
+            check("sub", [&](double* a, double* b) { simd::sub(a, b, n); }, [](double& a, double b) { a -= b; },
+                  true);
+            check("add_scalar", [&](double* a, double*) { simd::add_scalar(a, s, n); },
+                  [&](double& a, double) { a += s; }, true);
+            check("mul_scalar", [&](double* a, double*) { simd::mul_scalar(a, s, n); },
+                  [&](double& a, double) { a *= s; }, true);
+            check("div_scalar", [&](double* a, double*) { simd::div_scalar(a, s, n); },
+                  [&](double& a, double) { a /= s; }, true);
+            check("negate", [&](double* a, double*) { simd::negate(a, n); }, [](double& a, double) { a = -a; }, true);
+            check("swap", [&](double* a, double* b) { simd::swap(a, b, n); },
+                  [](double& a, double& b) { std::swap(a, b); }, true);
+            check("axpy", [&](double* a, double* b) { simd::axpy(a, s, b, n); },
+                  [&](double& a, double b) { a += s * b; }, false);
+
+            // the lanes are summed in a different order, which moves the result by at most n ulps of sum |x * y|
+            double dot{0.0}, bound{0.0};
+            for (size_t i{0}; i < n; i++) {
+                dot += x[i] * y[i];
+                bound += std::abs(x[i] * y[i]);
+            }
+            if (std::abs(simd::dot(x, y, n) - dot) > (n + 1) * std::numeric_limits<double>::epsilon() * bound) {
+                std::println("dot: mismatch at n = {}, offset = {}", n, offset);
+                failures++;
+            }
+        }
+    }
+
+    // row operations go through the same kernels for row-major matrices and fall back to strides otherwise
+    Matrix m{{1, 2, 3}, {4, 5, 6}, {7, 8, 9}};
+    auto t{m};
+    t.set_layout(Layout::ColMajor);
+    const bool col_major = t.layout() == Layout::ColMajor;
+    for (auto* mat : {&m, &t}) {
+        mat->swap_row(0, 2);
+        mat->add_row_multiple(1, 0, 2.0);
+        mat->multiply_row(2, -1.0);
+        mat->negate();
+    }
+    const bool ok_rows = col_major && m == Matrix{{-7, -8, -9}, {-18, -21, -24}, {1, 2, 3}} && m == t;
+    std::println("row operations: {}", ok_rows ? "ok" : "FAILED");
+    failures += !ok_rows;
+
+    std::println("{}", failures == 0 ? "all kernels ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
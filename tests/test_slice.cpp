@@ -0,0 +1,101 @@
+#include "check.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include "matoy/foundations/reduce.hpp"
+#include <print>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+// Elements that differ in every row and column, and aren't all integers.
+Matrix irregular(size_t rows, size_t cols) {
+    auto res{Matrix::empty(rows, cols)};
+    for (size_t i{0}; i < rows; i++) {
+        for (size_t j{0}; j < cols; j++) {
+            res[i, j] = static_cast<double>(i * cols + j) + 1.0 / static_cast<double>(i + j + 1);
+        }
+    }
+    return res;
+}
+
+// A compact copy of the elements in the same layout, built the slow way.
+Matrix reference(const Matrix& a, Slice rows, Slice cols) {
+    auto res{Matrix::empty(rows.count, cols.count)};
+    for (size_t i{0}; i < rows.count; i++) {
+        for (size_t j{0}; j < cols.count; j++) {
+            res[i, j] = a[rows.start + i * rows.step, cols.start + j * cols.step];
+        }
+    }
+    res.set_layout(a.layout());
+    return res;
+}
+
+int main() {
+    for (auto layout : {Layout::RowMajor, Layout::ColMajor}) {
+        const char* name{layout == Layout::RowMajor ? "row-major" : "column-major"};
+        const auto a{[layout] {
+            auto res{irregular(60, 70)};
+            res.set_layout(layout);
+            return res;
+        }()};
+
+        // a block points into the parent's buffer
+        const size_t copies{Matrix::buffer_copies()};
+        const auto v{a.block(5, 7, 30, 30)};
+        const size_t offset{layout == Layout::RowMajor ? 5 * a.leading_dim() + 7 : 7 * a.leading_dim() + 5};
+        expect(std::format("{} block", name).c_str(),
+               v.data() == std::as_const(a).data() + offset && v.leading_dim() == a.leading_dim() &&
+                   v == reference(a, {5, 30}, {7, 30}) && Matrix::buffer_copies() == copies);
+
+        // kernels take blocks like padded matrices, and only the solver copies its operand to factor it
+        const auto w{a.block(20, 1, 30, 40)};
+        const auto v_copy{reference(a, {5, 30}, {7, 30})}, w_copy{reference(a, {20, 30}, {1, 40})};
+        const auto rhs{a.block(0, 0, 30, 2)};
+        expect(std::format("{} kernels", name).c_str(),
+               approx(v * w, v_copy * w_copy) && sum(v) == sum(v_copy) && norm_1(w) == norm_1(w_copy) &&
+                   approx(*solve(v, rhs), *solve(v_copy, reference(a, {0, 30}, {0, 2}))) &&
+                   Matrix(v + w.block(0, 0, 30, 30)) == Matrix(v_copy + w_copy.block(0, 0, 30, 30)) &&
+                   v.transposed() == v_copy.transposed() && Matrix::buffer_copies() == copies + 2);
+        const size_t before_write{Matrix::buffer_copies()};
+
+        // writing to a block copies only what it spans, and leaves the parent alone
+        auto written{a.block(10, 10, 3, 4)};
+        written[0, 0] = -1.0;
+        expect(std::format("{} copy on write", name).c_str(),
+               a[10, 10] != -1.0 && written[0, 0] == -1.0 && written[2, 3] == a[12, 13] && written.is_contiguous() &&
+                   Matrix::buffer_copies() == before_write + 1);
+        auto column{a.block(0, 3, a.rows(), 1)};
+        column[0, 0] = -1.0;
+        expect(std::format("{} narrow copy", name).c_str(),
+               column.buffer().size() == a.rows() && column[a.rows() - 1, 0] == a[a.rows() - 1, 3]);
+        written.set_layout(layout == Layout::RowMajor ? Layout::ColMajor : Layout::RowMajor);
+        written *= 2.0;
+        expect(std::format("{} block layouts", name).c_str(), written[2, 3] == 2.0 * a[12, 13]);
+
+        // stepped slices are copied, unit slices shared
+        const auto stepped{a.slice({1, 20, 3}, {2, 10, 7})}, unit{a.slice({4, 3}, {5, 6})}, same{a.block(4, 5, 3, 6)};
+        expect(std::format("{} steps", name).c_str(),
+               stepped == reference(a, {1, 20, 3}, {2, 10, 7}) && stepped.layout() == layout &&
+                   unit.data() == same.data());
+
+        // slices are overwritten in place
+        auto b{a};
+        b.unshare();
+        const double* buffer{std::as_const(b).data()};
+        const Matrix values{-irregular(20, 10)};
+        b.set_slice({1, 20, 3}, {2, 10, 7}, values);
+        b.set_slice({2, 2}, {0, 3}, Matrix::zeros(2, 3, 9.0));
+        const bool ok{std::as_const(b).data() == buffer && b[2, 2] == 9.0 && b[3, 0] == 9.0 &&
+                      b[1, 2] == values[0, 0] && b[1, 9] == values[0, 1] && b[58, 65] == values[19, 9] &&
+                      b[0, 3] == a[0, 3] && b[4, 3] == a[4, 3] && b[59, 69] == a[59, 69]};
+        expect(std::format("{} set slice", name).c_str(), ok);
+    }
+
+    // inline matrices are copied, empty blocks are fine
+    const Matrix small{{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}};
+    const auto corner{small.block(1, 1, 1, 2)};
+    expect("inline", corner == Matrix{{5.0, 6.0}} && small.block(0, 3, 2, 0).size() == 0 &&
+                         irregular(20, 20).block(20, 0, 0, 20).size() == 0);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+#include "matoy/foundations/parallel.hpp"
+#include "matoy/foundations/sparse.hpp"
+#include "script.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <print>
+#include <random>
+#include <vector>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+// A dense matrix with about `density` of its elements nonzero.
+Matrix random_sparse(size_t rows, size_t cols, double density, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> dist{-1.0, 1.0};
+    std::bernoulli_distribution keep{density};
+    auto res{Matrix::zeros(rows, cols)};
+    for (size_t i{0}; i < rows; i++) {
+        for (size_t j{0}; j < cols; j++) {
+            if (keep(rng)) {
+                res[i, j] = dist(rng);
+            }
+        }
+    }
+    return res;
+}
+
+int main() {
+    std::mt19937_64 rng{12};
+    // the products are summed in a different order than gemm
+    constexpr double tol{1e-12};
+    const Matrix a{random_sparse(70, 50, 0.05, rng)}, b{random_sparse(70, 50, 0.05, rng)};
+    const Matrix c{random_sparse(50, 40, 0.05, rng)}, x{random_sparse(50, 1, 1.0, rng)};
+    const SparseMatrix sa{a}, sb{b}, sc{c};
+
+    expect("dense round trip", sa.to_dense() == a && sa.nnz() < a.size() / 10);
+    expect("element access", sa[3, 4] == a[3, 4] && sa[69, 49] == a[69, 49]);
+    expect("transposed", sa.transposed().to_dense() == a.transposed());
+    expect("spmv", close(sa * x, a * x, tol) && close(sa * x.transposed().transposed(), a * x, tol));
+    expect("spmm", close(sa * c, a * c, tol) && close(sa * c.transposed().transposed(), a * c, tol));
+    expect("dense x sparse", close(a.transposed() * sb, a.transposed() * b, tol));
+    expect("spgemm", close((sa * sc).to_dense(), a * c, tol));
+    expect("sparse + sparse", (sa + sb).to_dense() == Matrix(a + b) && (sa - sb).to_dense() == Matrix(a - b));
+    expect("sparse + dense", sa + b == Matrix(a + b) && a - sb == Matrix(a - b) && sa - b == Matrix(a - b));
+    expect("scalar", (2.0 * sa).to_dense() == Matrix(a * 2.0) && (-sa / 4.0).to_dense() == Matrix(-a / 4.0));
+
+    // exact cancellation leaves no stored zeros behind
+    expect("cancellation", (sa - sa).nnz() == 0 && (sa * 0.0).nnz() == 0 && sa - sa == SparseMatrix(70, 50));
+    const SparseMatrix tiny{Matrix{{1e-300, 0}, {0, 1.0}}};
+    expect("underflow", (tiny * 1e-300).nnz() == 1 && tiny * 1e-300 == SparseMatrix{Matrix{{0, 0}, {0, 1e-300}}} &&
+                            (tiny / std::numeric_limits<double>::infinity()).nnz() == 0);
+
+    const std::vector<SparseMatrix::Triplet> entries{{1, 2, 3.0}, {0, 0, 1.0}, {1, 2, -1.0}, {2, 1, 5.0}, {2, 1, -5.0}};
+    const auto t{SparseMatrix::from_triplets(3, 3, entries)};
+    expect("triplets", t.to_dense() == Matrix{{1, 0, 0}, {0, 0, 2}, {0, 0, 0}} && t.nnz() == 2);
+    expect("identity",
+           SparseMatrix::identity(50) * c == c && std::format("{}", SparseMatrix::identity(2)) == "[1, 0; 0, 1]");
+
+    // large enough to be split across threads
+    set_num_threads(4);
+    const Matrix big{random_sparse(600, 600, 0.01, rng)}, rhs{random_sparse(600, 64, 1.0, rng)};
+    const SparseMatrix sbig{big};
+    expect("parallel spmm",
+           close(sbig * rhs, big * rhs, tol) && close(rhs.transposed() * sbig, rhs.transposed() * big, tol));
+    const SparseMatrix denser{random_sparse(600, 600, 0.03, rng)};
+    const auto square{denser * denser};
+    set_num_threads(1);
+    const auto serial{denser * denser};
+    expect("parallel spgemm", close(square.to_dense(), denser.to_dense() * denser.to_dense(), tol) &&
+                                  square.row_ptr()[300] == serial.row_ptr()[300] &&
+                                  square.to_dense() == serial.to_dense());
+    set_num_threads(0);
+
+    expect("approx", approx(sa * 3.0 / 3.0, sa) && !approx(sa, sb));
+
+    // the interpreter reports operands whose shapes don't fit
+    Script script;
+    script.run("S := sparse([1, 0; 0, 2])");
+    expect("shape errors", script.fails_with("S + [1, 2, 3]", "cannot add matrices of shapes 2x2 and 1x3") &&
+                               script.fails_with("[1; 2] - S", "cannot subtract matrices of shapes 2x1 and 2x2") &&
+                               script.fails_with("S - sparse([1, 2])", "shapes 2x2 and 1x2") &&
+                               script.fails_with("S * [1, 2]", "cannot multiply matrices of shapes 2x2 and 1x2") &&
+                               script.fails_with("[1; 2] * S", "shapes 2x1 and 2x2") &&
+                               script.fails_with("S * sparse([1, 2, 3])", "shapes 2x2 and 1x3") &&
+                               script.matrix("S * [1; 1]") == Matrix{{1}, {2}});
+
+    // sparse matrices are matrices like any other outside their own kernels
+    expect("comparisons", script.boolean("sparse([1, 2; 3, 4]) == [1, 2; 3, 4]") == true &&
+                              script.boolean("S == [1, 0; 0, 3]") == false &&
+                              script.boolean("S == diag([1, 2])") == true &&
+                              script.boolean("S ~= [1, 0; 0, 2]") == true);
+    script.run("T := sparse([1, 2; 3, 4])");
+    script.run("T[0, 1] = 0");
+    expect("indexing", script.scalar("S[1, 1]") == 2.0 && script.scalar("S[0, 1]") == 0.0 &&
+                           script.matrix("S[:, 1]") == Matrix{{0}, {2}} &&
+                           script.matrix("T") == Matrix{{1, 0}, {3, 4}});
+    expect("builtins", script.matrix("sum(S, 2)") == Matrix{{1}, {2}} && script.scalar("norm(S, 1)") == 2.0 &&
+                           script.boolean("lstsq(S, [1; 2]) ~= [1; 1]") == true);
+    expect("fields", script.scalar("S.sum") == 3.0 && script.scalar("S.max") == 2.0 &&
+                         script.boolean("S.I ~= [1, 0; 0, 0.5]") == true);
+
+    return failures == 0 ? 0 : 1;
+}
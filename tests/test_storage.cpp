@@ -0,0 +1,72 @@
+#include "check.hpp"
+#include "matoy/foundations/lu.hpp"
+#include "matoy/foundations/matrix.hpp"
+#include "matoy/foundations/matrix_op.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <print>
+#include <random>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+// The same matrix, stored with padded rows.
+Matrix padded_copy(const Matrix& mat) {
+    auto res = Matrix::padded(mat.rows(), mat.cols());
+    res.set_block(0, 0, mat);
+    return res;
+}
+
+int main() {
+    std::mt19937_64 rng{3};
+
+    const auto big = Matrix::zeros(300, 300);
+    expect("64-byte aligned buffer", reinterpret_cast<std::uintptr_t>(big.data()) % 64 == 0);
+
+    expect("padded leading dimensions", Matrix::padded_leading_dim(1) == 8 && Matrix::padded_leading_dim(100) == 104 &&
+                                            Matrix::padded_leading_dim(512) == 520 &&
+                                            Matrix::padded_leading_dim(1000) == 1000);
+
+    const auto a = random_matrix(37, 53, rng), b = random_matrix(37, 53, rng), c = random_matrix(53, 29, rng);
+    const auto pa = padded_copy(a), pb = padded_copy(b), pc = padded_copy(c);
+    expect("padded rows", pa.leading_dim() == 56 && !pa.is_contiguous() && pa == a);
+
+    // every kernel has to step over the padding
+    auto sum = pa;
+    sum += pb;
+    auto scaled = pa;
+    scaled *= 3.0;
+    scaled -= 1.0;
+    auto neg = pa;
+    neg.negate();
+    expect("elementwise", sum == a + b && scaled == a * 3.0 - 1.0 && neg == -a && Matrix{pa * 2.0 + pb} == a * 2.0 + b);
+    expect("product", pa * pc == a * c);
+    expect("transposed", pa.transposed() * pa == a.transposed() * a);
+    auto rows = pa;
+    rows.swap_row(0, 5);
+    rows.add_row_multiple(1, 2, 0.5);
+    rows.multiply_row(3, -2.0);
+    auto ref = a;
+    ref.swap_row(0, 5);
+    ref.add_row_multiple(1, 2, 0.5);
+    ref.multiply_row(3, -2.0);
+    expect("row operations", rows == ref);
+    auto relaid = pa;
+    relaid.set_layout(Layout::ColMajor);
+    expect("relayout", relaid == a && relaid.is_contiguous());
+    expect("concatenation", concat_h(pa, pb) == concat_h(a, b) && concat_v(pa, pb) == concat_v(a, b));
+
+    // LU pads power-of-two sizes itself, and its trailing updates have to honor that
+    const auto m = random_matrix(512, 512, rng), rhs = random_matrix(512, 3, rng);
+    const LU lu{m};
+    const auto residual = Matrix{m * *lu.solve(rhs) - rhs};
+    double max_residual{0.0};
+    for (double r : residual.buffer()) {
+        max_residual = std::max(max_residual, std::abs(r));
+    }
+    expect("LU with padding", lu.factors().leading_dim() == 520 && max_residual < 1e-9);
+
+    return failures == 0 ? 0 : 1;
+}
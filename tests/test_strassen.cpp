@@ -0,0 +1,58 @@
+#include "check.hpp"
+#include "matoy/foundations/parallel.hpp"
+#include "matoy/foundations/reduce.hpp"
+#include "matoy/foundations/strassen.hpp"
+#include <format>
+#include <print>
+#include <random>
+
+using namespace matoy;
+using namespace matoy::foundations;
+using namespace matoy::tests;
+
+// The distance to the classical product, relative to the norms of the operands.
+double error(const Matrix& a, const Matrix& b, const Matrix& c) {
+    return frobenius_norm(Matrix(c - a * b)) / (frobenius_norm(a) * frobenius_norm(b));
+}
+
+int main() {
+    std::mt19937_64 rng{24};
+
+    // odd and even sizes, several levels of recursion, and operands in both layouts and with padding
+    for (auto [m, k, n] : {std::tuple<size_t, size_t, size_t>{64, 64, 64}, {65, 67, 63}, {100, 37, 81}, {1, 50, 50},
+                           {128, 256, 64}}) {
+        const auto a{random_matrix(m, k, rng)}, b{random_matrix(k, n, rng)};
+        auto a_col_major{a}, b_padded{b};
+        a_col_major.set_layout(Layout::ColMajor);
+        b_padded.set_leading_dim(Matrix::padded_leading_dim(n));
+        bool ok{true};
+        for (size_t crossover : {4, 16, 2048}) {
+            ok = ok && error(a, b, strassen(a, b, crossover)) < 1e-14 &&
+                 error(a, b, strassen(a_col_major, b_padded, crossover)) < 1e-14;
+        }
+        expect(std::format("{}x{}x{}", m, k, n).c_str(), ok && strassen(a, b, 2048) == a * b);
+    }
+
+    // the result writes through a strided view, such as the transpose of c
+    const auto a{random_matrix(70, 90, rng)}, b{random_matrix(90, 50, rng)};
+    auto c{Matrix::zeros(50, 70)};
+    auto c_t{c.transposed()};
+    strassen(a.view(), b.view(), c_t.view(), 8);
+    expect("strided output", error(a, b, c_t) < 1e-14);
+
+    // the products of a level may run on any thread, but every element is computed the same way
+    const auto big_a{random_matrix(300, 300, rng)}, big_b{random_matrix(300, 300, rng)};
+    set_num_threads(4);
+    const auto parallel{strassen(big_a, big_b, 32)};
+    set_num_threads(1);
+    const auto serial{strassen(big_a, big_b, 32)};
+    set_num_threads(0);
+    expect("threads", parallel == serial && error(big_a, big_b, serial) < 1e-14);
+
+    // single precision
+    auto fa{FloatMatrix::zeros(40, 40, 0.5f)}, fb{FloatMatrix::zeros(40, 40, 0.25f)}, fc{FloatMatrix::empty(40, 40)};
+    strassen(fa.view(), fb.view(), fc.view(), 4);
+    expect("float", fc == FloatMatrix::zeros(40, 40, 5.0f));
+
+    return failures == 0 ? 0 : 1;
+}
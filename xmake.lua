@@ -53,3 +53,275 @@ target("test_matrix")
     add_deps("matoy-foundations")
     add_includedirs("src")
     add_files("tests/test_matrix.cpp")
+
+target("bench_gemm")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_gemm.cpp")
+
+target("test_gemm")
+    set_kind("binary")
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("tests/test_gemm.cpp")
+
+target("test_lu")
+    set_kind("binary")
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("tests/test_lu.cpp")
+
+target("bench_lu")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_lu.cpp")
+
+target("bench_transpose")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_transpose.cpp")
+
+target("bench_expr")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_expr.cpp")
+
+target("test_simd")
+    set_kind("binary")
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("tests/test_simd.cpp")
+
+target("bench_simd")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_simd.cpp")
+
+target("test_cow")
+    set_kind("binary")
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("tests/test_cow.cpp")
+
+target("test_fixed_matrix")
+    set_kind("binary")
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("tests/test_fixed_matrix.cpp")
+
+target("bench_small")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_small.cpp")
+
+target("test_storage")
+    set_kind("binary")
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("tests/test_storage.cpp")
+
+target("test_sparse")
+    set_kind("binary")
+    add_deps("matoy-foundations", "matoy-syntax", "matoy-eval")
+    add_includedirs("src")
+    add_files("tests/test_sparse.cpp")
+
+target("bench_sparse")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_sparse.cpp")
+
+target("test_band")
+    set_kind("binary")
+    add_deps("matoy-foundations", "matoy-syntax", "matoy-eval")
+    add_includedirs("src")
+    add_files("tests/test_band.cpp")
+
+target("bench_band")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_band.cpp")
+
+target("test_cholesky")
+    set_kind("binary")
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("tests/test_cholesky.cpp")
+
+target("bench_cholesky")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_cholesky.cpp")
+
+target("test_qr")
+    set_kind("binary")
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("tests/test_qr.cpp")
+
+target("bench_qr")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_qr.cpp")
+
+target("test_eigen")
+    set_kind("binary")
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("tests/test_eigen.cpp")
+
+target("bench_eigen")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_eigen.cpp")
+
+target("test_power")
+    set_kind("binary")
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("tests/test_power.cpp")
+
+target("bench_power")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_power.cpp")
+
+target("test_precision")
+    set_kind("binary")
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("tests/test_precision.cpp")
+
+target("bench_precision")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_precision.cpp")
+
+target("test_batched")
+    set_kind("binary")
+    add_deps("matoy-foundations", "matoy-syntax", "matoy-eval")
+    add_includedirs("src")
+    add_files("tests/test_batched.cpp")
+
+target("bench_batched")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_batched.cpp")
+
+target("test_broadcast")
+    set_kind("binary")
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("tests/test_broadcast.cpp")
+
+target("bench_broadcast")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_broadcast.cpp")
+
+target("test_reduce")
+    set_kind("binary")
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("tests/test_reduce.cpp")
+
+target("bench_reduce")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_reduce.cpp")
+
+target("test_block")
+    set_kind("binary")
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("tests/test_block.cpp")
+
+target("bench_block")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_block.cpp")
+
+target("test_slice")
+    set_kind("binary")
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("tests/test_slice.cpp")
+
+target("bench_slice")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_slice.cpp")
+
+target("test_strassen")
+    set_kind("binary")
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("tests/test_strassen.cpp")
+
+target("bench_strassen")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_strassen.cpp")
+
+target("test_into")
+    set_kind("binary")
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("tests/test_into.cpp")
+
+target("bench_into")
+    set_kind("binary")
+    set_default(false)
+    add_deps("matoy-foundations")
+    add_includedirs("src")
+    add_files("bench/bench_into.cpp")
+
+target("test_literal")
+    set_kind("binary")
+    add_deps("matoy-foundations", "matoy-syntax", "matoy-eval")
+    add_includedirs("src")
+    add_files("tests/test_literal.cpp")
+
+target("test_index")
+    set_kind("binary")
+    add_deps("matoy-foundations", "matoy-syntax", "matoy-eval")
+    add_includedirs("src")
+    add_files("tests/test_index.cpp")